@@ -2,7 +2,9 @@
 # define RBTREE_HPP
 
 #include <memory>
+#include <new>
 #include "utils.hpp"
+#include "container_stats.hpp"
 
 namespace ft
 {
@@ -17,13 +19,14 @@ namespace ft
             Node* right;
             Node* parent;
             bool color;
+            size_t size;        // number of nodes in the subtree rooted here
 
         
-            Node(): pair(Pair()), left(NULL), right(NULL), parent(NULL), color(Black) {};
+            Node(): pair(Pair()), left(NULL), right(NULL), parent(NULL), color(Black), size(1) {};
 
-            Node(Pair const & pair): pair(pair), left(NULL), right(NULL), parent(NULL), color(Black) {};
+            Node(Pair const & pair): pair(pair), left(NULL), right(NULL), parent(NULL), color(Black), size(1) {};
             
-            Node(Node const & copy): pair(copy.pair), left(copy.left), right(copy.right), parent(copy.parent), color(copy.color) {};
+            Node(Node const & copy): pair(copy.pair), left(copy.left), right(copy.right), parent(copy.parent), color(copy.color), size(copy.size) {};
 
             Node& operator=(Node const & source)
             {
@@ -35,6 +38,7 @@ namespace ft
                 this->right = source.right;
                 this->parent = source.parent;
                 this->color = source.color;
+                this->size = source.size;
                 return *this;
             };
 
@@ -42,6 +46,86 @@ namespace ft
 
     };
 
+    /*order statistics helpers, shared by the tree and its iterators*/
+
+    template <class NodePtr>
+    size_t treeSize(NodePtr node)
+    {
+        return node ? node->size : 0;
+    };
+
+    template <class NodePtr>
+    NodePtr treeRoot(NodePtr node)
+    {
+        while (node && node->parent)
+            node = node->parent;
+        return node;
+    };
+
+    //k-th smallest node of the subtree (0-based), NULL if k is out of range
+    template <class NodePtr>
+    NodePtr treeSelect(NodePtr node, size_t k)
+    {
+        while (node)
+        {
+            size_t left = treeSize(node->left);
+            if (k < left)
+                node = node->left;
+            else if (k == left)
+                return node;
+            else
+            {
+                k -= left + 1;
+                node = node->right;
+            }
+        }
+        return node;
+    };
+
+    template <class NodePtr>
+    NodePtr treeMin(NodePtr node)
+    {
+        while (node && node->left)
+            node = node->left;
+        return node;
+    };
+
+    //in-order successor, NULL after the last node
+    template <class NodePtr>
+    NodePtr treeNext(NodePtr node)
+    {
+        if (node->right)
+            return treeMin(node->right);
+        while (node->parent && node == node->parent->right)
+            node = node->parent;
+        return node->parent;
+    };
+
+    //in-order position of the node in the whole tree
+    template <class NodePtr>
+    size_t treeIndex(NodePtr node)
+    {
+        size_t index = treeSize(node->left);
+        while (node->parent)
+        {
+            if (node == node->parent->right)
+                index += treeSize(node->parent->left) + 1;
+            node = node->parent;
+        }
+        return index;
+    };
+
+    //nodes on the longest path down from node, O(n)
+    template <class NodePtr>
+    size_t treeHeight(NodePtr node)
+    {
+        if (!node)
+            return 0;
+        size_t left = treeHeight(node->left);
+        size_t right = treeHeight(node->right);
+        return 1 + (left > right ? left : right);
+    };
+
     template <class Pair, class Node, class Compare, class Allocator = std::allocator<Node> >
     class RBtree
     {
@@ -54,16 +138,42 @@ namespace ft
             Allocator _allocator;
             Compare _comparator;
 
-            pointer createNullNode()
+            void updateSize(pointer node)
             {
-                pointer node = this->_allocator.allocate(1);
-                this->_allocator.construct(node, Node());
-                return node;
+                node->size = treeSize(node->left) + treeSize(node->right) + 1;
+            };
+#ifdef FT_CONTAINERS_STATS
+            mutable tree_counters _stats;
+
+            void countLookup(unsigned long long lookups, unsigned long long comparisons) const
+            {
+                statsAdd(this->_stats.lookups, lookups);
+                statsAdd(this->_stats.comparisons, comparisons);
+                stats_registry::looked(lookups, comparisons);
+            };
+
+            void countRotation()
+            {
+                statsAdd(this->_stats.rotations, 1);
+                stats_registry::rotated();
+            };
+#endif
+
+            //the comparator as seen by lookups: they count in a local, reported once per lookup,
+            //and without FT_CONTAINERS_STATS the count is optimised away
+            bool compare(Pair const & a, Pair const & b, size_t& comparisons) const
+            {
+                ++comparisons;
+                return this->_comparator(a, b);
             };
 
         public:
             RBtree(): _root(NULL), _allocator(Allocator()) {};
 
+            explicit RBtree(const Allocator& alloc): _root(NULL), _allocator(alloc) {};
+
+            RBtree(const Compare& comparator, const Allocator& alloc): _root(NULL), _allocator(alloc), _comparator(comparator) {};
+
             ~RBtree() {};
 
             /*methods*/
@@ -72,6 +182,7 @@ namespace ft
             {
                 pointer node = this->_allocator.allocate(1);
                 this->_allocator.construct(node, value);
+                FT_STATS(stats_registry::treeNodes(1, sizeof(*node)));
                 return node;
             };
 
@@ -79,6 +190,7 @@ namespace ft
             {
                 if (!node)
                     return ;
+                FT_STATS(stats_registry::treeNodes(-1, -static_cast<long long>(sizeof(*node))));
                 this->_allocator.destroy(node);
                 this->_allocator.deallocate(node, 1);
             };
@@ -88,6 +200,11 @@ namespace ft
                 return this->_root;
             }
 
+            allocator_type getAllocator() const
+            {
+                return this->_allocator;
+            }
+
             size_t max_size() const
             {
                 return this->_allocator.max_size();
@@ -114,18 +231,88 @@ namespace ft
             };
 
             pointer find(Pair value, pointer node) const
-            {                
-                if (node)
+            {
+                size_t comparisons = 0;
+                while (node)
                 {
-                    if (_comparator(node->pair, value))
-                        return find(value, node->right);
-                    else if (_comparator(value, node->pair)){
-                        return find(value, node->left);
-                    }
+                    if (compare(node->pair, value, comparisons))
+                        node = node->right;
+                    else if (compare(value, node->pair, comparisons))
+                        node = node->left;
+                    else
+                        break ;
                 }
+                FT_STATS(countLookup(1, comparisons));
                 return node;
             };
 
+            static const size_t batchSize = 16;
+
+            //looks up n <= batchSize values at once: the descents advance in lockstep and the
+            //next node of each one is prefetched, so their cache misses overlap
+            void findBatch(Pair const * const * values, pointer* out, size_t n) const
+            {
+                pointer nodes[batchSize];
+                size_t lanes[batchSize];
+                size_t active = n;
+                size_t comparisons = 0;
+                for (size_t i = 0; i < n; ++i)
+                {
+                    nodes[i] = this->_root;
+                    lanes[i] = i;
+                    out[i] = NULL;
+                }
+                while (active)
+                {
+                    size_t i = 0;
+                    while (i < active)
+                    {
+                        pointer node = nodes[i];
+                        size_t lane = lanes[i];
+                        if (node && compare(node->pair, *values[lane], comparisons))
+                            node = node->right;
+                        else if (node && compare(*values[lane], node->pair, comparisons))
+                            node = node->left;
+                        else
+                        {
+                            out[lane] = node;
+                            --active;
+                            nodes[i] = nodes[active];
+                            lanes[i] = lanes[active];
+                            continue ;
+                        }
+                        FT_PREFETCH(node);
+                        nodes[i++] = node;
+                    }
+                }
+                FT_STATS(countLookup(n, comparisons));
+            };
+
+            // find_batch of map and set: the keys go through findBatch batchSize at a
+            // time, each made into a Pair by makeProbe in storage on this stack frame,
+            // so a lookup never calls the container's allocator
+            template <class Iter, class InputIt, class OutputIt, class MakeProbe>
+            OutputIt findEach(InputIt first, InputIt last, OutputIt out, MakeProbe makeProbe) const
+            {
+                char storage[batchSize * sizeof(Pair)] __attribute__((aligned(__alignof__(Pair))));
+                Pair* probes = reinterpret_cast<Pair*>(storage);
+                Pair const * values[batchSize];
+                pointer nodes[batchSize];
+                while (first != last)
+                {
+                    size_t n = 0;
+                    for (; n < batchSize && first != last; ++n, ++first)
+                        values[n] = new (probes + n) Pair(makeProbe(*first));
+                    findBatch(values, nodes, n);
+                    for (size_t i = 0; i < n; ++i)
+                    {
+                        *out++ = Iter(nodes[i], this->_root);
+                        probes[i].~Pair();
+                    }
+                }
+                return out;
+            };
+
             void leftRotate(pointer node)
             {
                 pointer tmp = node->right;
@@ -141,6 +328,9 @@ namespace ft
                     node->parent->right = tmp;
                 tmp->left = node;
                 node->parent = tmp;
+                tmp->size = node->size;
+                updateSize(node);
+                FT_STATS(countRotation());
             };
 
             void rightRotate(pointer node)
@@ -158,6 +348,9 @@ namespace ft
                     node->parent->left = tmp;
                 tmp->right = node;
                 node->parent = tmp;
+                tmp->size = node->size;
+                updateSize(node);
+                FT_STATS(countRotation());
             };
             
             void insertBalance(pointer node)
@@ -235,8 +428,12 @@ namespace ft
                 this->_root->color = Black;
             };
 
-            bool insert(pointer node)
+            //links the node in, or returns the node already holding its key and leaves it untouched
+            pointer insertUnique(pointer node)
             {
+                node->left = NULL;
+                node->right = NULL;
+                node->parent = NULL;
                 if (!this->_root)
                     this->_root = node;
                 else
@@ -245,11 +442,7 @@ namespace ft
                     while (tmp)
                     {
                         if (!this->_comparator(tmp->pair, node->pair) && !this->_comparator(node->pair, tmp->pair))
-                        {
-                            if (tmp != node)
-                                destroyNode(node);
-                            return false;
-                        }
+                            return tmp;
                         else if (this->_comparator(node->pair, tmp->pair))
                         {
                             if (tmp->left)
@@ -273,10 +466,22 @@ namespace ft
                             }
                         }
                     }
+                    for (tmp = node->parent; tmp; tmp = tmp->parent)
+                        tmp->size++;
                 }
+                node->size = 1;
                 node->color = Red;
                 insertBalance(node);
-                return true;
+                return node;
+            };
+
+            bool insert(pointer node)
+            {
+                pointer res = insertUnique(node);
+                if (res == node)
+                    return true;
+                destroyNode(node);
+                return false;
             };
 
             void clear(pointer node)
@@ -294,11 +499,41 @@ namespace ft
                 destroyNode(node);
             };
 
+            //clear() from the root, skipped when the allocator gets its memory back in bulk anyway
+            void clearAll()
+            {
+                if (!(releasesInBulk(this->_allocator) && ft::is_trivially_destructible<Pair>::value))
+                    clear(this->_root);
+                else
+                    FT_STATS(stats_registry::treeNodes(-static_cast<long long>(treeSize(this->_root)), -static_cast<long long>(treeSize(this->_root) * sizeof(*this->_root))));
+                this->_root = NULL;
+            };
+
+            //the nodes are someone else's from here on (release_async)
             void makeRootNull()
             {
+                FT_STATS(stats_registry::treeNodes(-static_cast<long long>(treeSize(this->_root)), -static_cast<long long>(treeSize(this->_root) * sizeof(*this->_root))));
                 this->_root = NULL;
             }
 
+            //rotations, lookups and comparisons stay 0 unless built with FT_CONTAINERS_STATS; the shape is walked, O(n)
+            tree_stats stats() const
+            {
+                tree_stats res;
+                res.nodes = treeSize(this->_root);
+                res.bytes = res.nodes * sizeof(typename Allocator::value_type);
+                res.height = treeHeight(this->_root);
+                res.black_height = blackHeight(this->_root);
+                res.rotations = 0;
+                res.lookups = 0;
+                res.comparisons = 0;
+                FT_STATS(res.rotations = __atomic_load_n(&this->_stats.rotations, __ATOMIC_RELAXED));
+                FT_STATS(res.lookups = __atomic_load_n(&this->_stats.lookups, __ATOMIC_RELAXED));
+                FT_STATS(res.comparisons = __atomic_load_n(&this->_stats.comparisons, __ATOMIC_RELAXED));
+                res.comparisons_per_lookup = res.lookups ? static_cast<double>(res.comparisons) / res.lookups : 0;
+                return res;
+            };
+
             void transplant(pointer u, pointer v)
             {
                 if (u && !u->parent)
@@ -312,39 +547,27 @@ namespace ft
                 v->parent = u->parent;
             };
 
-            void deleteBalance(pointer node, bool *flag)
+            //x took the place of the removed node and may be NULL, so its parent is passed separately
+            void deleteBalance(pointer x, pointer parent)
             {
                 pointer tmp = NULL;
-                pointer x = node;
-                while (node != this->_root && node->color == Black)
+                while (x != this->_root && (!x || x->color == Black))
                 {
-                    if (node == node->parent->left)
+                    if (x == parent->left)
                     {
-                        tmp = node->parent->right;
-                        if (tmp && tmp->color == Red)
+                        tmp = parent->right;
+                        if (tmp->color == Red)
                         {
-                            
                             tmp->color = Black;
-                            node->parent->color = Red;
-                            leftRotate(node->parent);
-                            tmp = node->parent->right;
+                            parent->color = Red;
+                            leftRotate(parent);
+                            tmp = parent->right;
                         }
                         if ((!tmp->left || tmp->left->color == Black) && (!tmp->right || tmp->right->color == Black))
                         {
                             tmp->color = Red;
-                            
-                            x = node;
-                            node = node->parent;
-                            
-                            if (*flag)
-                            {
-                                if (x == node->right)
-                                    node->right = NULL;
-                                else if (x == node->left)
-                                    node->left = NULL;
-                                destroyNode(x);
-                                *flag = false;
-                            }
+                            x = parent;
+                            parent = x->parent;
                         }
                         else
                         {
@@ -353,51 +576,30 @@ namespace ft
                                 tmp->left->color = Black;
                                 tmp->color = Red;
                                 rightRotate(tmp);
-                                tmp = node->parent->right;
-                                x = node;
-                                if (*flag)
-                                {
-                                    if (x == node->parent->right)
-                                        node->parent->right = NULL;
-                                    else if (x == node->parent->left)
-                                        node->parent->left = NULL;
-                                    destroyNode(x);
-                                    *flag = false;
-                                }
+                                tmp = parent->right;
                             }
-                            tmp->color = node->parent->color;
-                            node->parent->color = Black;
+                            tmp->color = parent->color;
+                            parent->color = Black;
                             tmp->right->color = Black;
-                            leftRotate(node->parent);
-                            node = this->_root;
+                            leftRotate(parent);
+                            x = this->_root;
                         }
                     }
                     else
                     {
-                        tmp = node->parent->left;
-                        if (tmp && tmp->color == Red)
+                        tmp = parent->left;
+                        if (tmp->color == Red)
                         {
                             tmp->color = Black;
-                            node->parent->color = Red;
-                            rightRotate(node->parent);
-                            tmp = node->parent->left;
+                            parent->color = Red;
+                            rightRotate(parent);
+                            tmp = parent->left;
                         }
-                        if ((!tmp->right || tmp->right->color == Black)
-                            && (!tmp->left || tmp->left->color == Black))
+                        if ((!tmp->right || tmp->right->color == Black) && (!tmp->left || tmp->left->color == Black))
                         {
                             tmp->color = Red;
-                            x = node;
-                            node = node->parent;
-
-                            if (*flag)
-                            {
-                                if (x == node->right)
-                                    node->right = NULL;
-                                else if (x == node->left)
-                                    node->left = NULL;
-                                destroyNode(x);
-                                *flag = false;
-                            }
+                            x = parent;
+                            parent = x->parent;
                         }
                         else
                         {
@@ -406,77 +608,54 @@ namespace ft
                                 tmp->right->color = Black;
                                 tmp->color = Red;
                                 leftRotate(tmp);
-                                tmp = node->parent->left;
-
-                                x = node;
-                                if (*flag)
-                                {
-                                    if (x == node->parent->right)
-                                        node->parent->right = NULL;
-                                    else if (x == node->parent->left)
-                                        node->parent->left = NULL;
-                                    destroyNode(x);
-                                    *flag = false;
-                                }
+                                tmp = parent->left;
                             }
-                            tmp->color = node->parent->color;
-                            node->parent->color = Black;
+                            tmp->color = parent->color;
+                            parent->color = Black;
                             tmp->left->color = Black;
-                            rightRotate(node->parent);
-                            node = this->_root;
-                            
+                            rightRotate(parent);
+                            x = this->_root;
                         }
                     }
                 }
-                node->color = Black;
+                if (x)
+                    x->color = Black;
             };
 
-            bool deleteNode(pointer node)
+            //removes the node from the tree without freeing it
+            void unlink(pointer node)
             {
-                
-                bool flag = false;
-                if (!node)
-                    return false;
                 pointer tmp = node;
                 pointer x = NULL;
-                int tmpTrueColor = tmp->color;        
+                pointer parent = NULL;
+                bool tmpTrueColor = tmp->color;
+
+                if (node->left && node->right)
+                    tmp = min(node->right);
+                for (pointer p = tmp->parent; p; p = p->parent)
+                    p->size--;
 
                 if (!node->left)
                 {
                     x = node->right;
-                    if (!x)                             
-                    {
-                        x = createNullNode();
-                        flag = true;
-                    }
-                    transplant(node, x);                                                         
+                    parent = node->parent;
+                    transplant(node, x);
                 }
                 else if (!node->right)
                 {
                     x = node->left;
-                    if (!x)                             
-                    {
-                        x = createNullNode();
-                        flag = true;
-                    }
-                    transplant(node, x);                    
+                    parent = node->parent;
+                    transplant(node, x);
                 }
                 else
                 {
-                    tmp = min(node->right);
-
                     tmpTrueColor = tmp->color;
                     x = tmp->right;
-
-                    if (!x)
-                    {
-                        x = createNullNode();
-                        flag = true;
-                    }
-                    if (tmp->parent == node) 
-                        x->parent = tmp;
+                    if (tmp->parent == node)
+                        parent = tmp;
                     else
                     {
+                        parent = tmp->parent;
                         transplant(tmp, tmp->right);
                         tmp->right = node->right;
                         tmp->right->parent = tmp;
@@ -485,24 +664,47 @@ namespace ft
                     tmp->left = node->left;
                     tmp->left->parent = tmp;
                     tmp->color = node->color;
+                    tmp->size = node->size;
                 }
                 if (tmpTrueColor == Black)
-                    deleteBalance(x, &flag);
-                if (flag)
-                {
-                    
-                    if (x == this->_root)
-                        this->_root = NULL;
-                    else if (node->parent && x == node->parent->right)
-                        node->parent->right = NULL;
-                    else if (node->parent && x == node->parent->left)
-                        node->parent->left = NULL;
-                    destroyNode(x);
-                }
+                    deleteBalance(x, parent);
+                node->left = NULL;
+                node->right = NULL;
+                node->parent = NULL;
+                node->size = 1;
+            };
+
+            bool deleteNode(pointer node)
+            {
+                if (!node)
+                    return false;
+                unlink(node);
                 destroyNode(node);
                 return true;
             };
 
+            pointer select(pointer node, size_t k) const
+            {
+                return treeSelect(node, k);
+            };
+
+            //number of elements of the subtree less than pair
+            size_t rank(pointer node, Pair const & pair) const
+            {
+                size_t res = 0;
+                while (node)
+                {
+                    if (this->_comparator(node->pair, pair))
+                    {
+                        res += treeSize(node->left) + 1;
+                        node = node->right;
+                    }
+                    else
+                        node = node->left;
+                }
+                return res;
+            };
+
         pointer lower(pointer node, Pair const & pair) const
         {
             pointer tmp = NULL;
@@ -551,6 +753,355 @@ namespace ft
             return node;
         }
 
+            //lower bound searched from a nearby node: climbs only until the subtree
+            //around hint can hold the answer, then descends, O(log d) for a distance d
+            pointer lowerFrom(pointer hint, Pair const & pair) const
+            {
+                pointer node = hint;
+                pointer res = NULL;
+                if (!node)
+                    return lower(this->_root, pair);
+                if (this->_comparator(node->pair, pair))
+                {
+                    while (node->parent && (node == node->parent->right || this->_comparator(node->parent->pair, pair)))
+                        node = node->parent;
+                    res = lower(node, pair);
+                    return res ? res : node->parent;
+                }
+                while (node->parent && (node == node->parent->left || !this->_comparator(node->parent->pair, pair)))
+                    node = node->parent;
+                res = lower(node, pair);
+                return res ? res : hint;
+            };
+
+            /*split and join*/
+
+            //number of black nodes on the path down to a leaf
+            size_t blackHeight(pointer node) const
+            {
+                size_t height = 0;
+                for (; node; node = node->left)
+                    height += (node->color == Black);
+                return height;
+            };
+
+            //links left < mid < right into one tree and returns its root, O(log n)
+            pointer joinNodes(pointer left, pointer mid, pointer right)
+            {
+                if (left)
+                {
+                    left->parent = NULL;
+                    left->color = Black;
+                }
+                if (right)
+                {
+                    right->parent = NULL;
+                    right->color = Black;
+                }
+                size_t leftHeight = blackHeight(left);
+                size_t rightHeight = blackHeight(right);
+                mid->parent = NULL;
+                if (leftHeight == rightHeight)
+                {
+                    mid->left = left;
+                    mid->right = right;
+                    if (left)
+                        left->parent = mid;
+                    if (right)
+                        right->parent = mid;
+                    mid->color = Black;
+                    updateSize(mid);
+                    return mid;
+                }
+
+                pointer root = this->_root;
+                pointer parent = NULL;
+                pointer tmp = NULL;
+                if (leftHeight > rightHeight)
+                {
+                    //walk down the right spine of left to a black node as high as right
+                    tmp = left;
+                    while (tmp && (tmp->color == Red || leftHeight > rightHeight))
+                    {
+                        leftHeight -= (tmp->color == Black);
+                        parent = tmp;
+                        tmp = tmp->right;
+                    }
+                    mid->left = tmp;
+                    mid->right = right;
+                    parent->right = mid;
+                    this->_root = left;
+                }
+                else
+                {
+                    tmp = right;
+                    while (tmp && (tmp->color == Red || rightHeight > leftHeight))
+                    {
+                        rightHeight -= (tmp->color == Black);
+                        parent = tmp;
+                        tmp = tmp->left;
+                    }
+                    mid->left = left;
+                    mid->right = tmp;
+                    parent->left = mid;
+                    this->_root = right;
+                }
+                if (mid->left)
+                    mid->left->parent = mid;
+                if (mid->right)
+                    mid->right->parent = mid;
+                mid->parent = parent;
+                mid->color = Red;
+                updateSize(mid);
+                for (tmp = parent; tmp; tmp = tmp->parent)
+                    updateSize(tmp);
+                insertBalance(mid);
+                tmp = this->_root;
+                this->_root = root;
+                return tmp;
+            };
+
+            //links left < right into one tree and returns its root, O(log n)
+            pointer concatNodes(pointer left, pointer right)
+            {
+                if (!left)
+                    return right;
+                if (!right)
+                    return left;
+                pointer root = this->_root;
+                pointer mid = min(right);
+                right->parent = NULL;
+                this->_root = right;
+                unlink(mid);
+                right = this->_root;
+                this->_root = root;
+                return joinNodes(left, mid, right);
+            };
+
+            //cuts the subtree into the nodes less than, equal to and greater than pair
+            void splitNodes(pointer node, Pair const & pair, pointer & left, pointer & mid, pointer & right)
+            {
+                left = NULL;
+                mid = NULL;
+                right = NULL;
+                if (!node)
+                    return ;
+                pointer nodeLeft = node->left;
+                pointer nodeRight = node->right;
+                if (nodeLeft)
+                    nodeLeft->parent = NULL;
+                if (nodeRight)
+                    nodeRight->parent = NULL;
+                node->left = NULL;
+                node->right = NULL;
+                node->parent = NULL;
+                node->size = 1;
+                if (this->_comparator(pair, node->pair))
+                {
+                    splitNodes(nodeLeft, pair, left, mid, right);
+                    right = joinNodes(right, node, nodeRight);
+                }
+                else if (this->_comparator(node->pair, pair))
+                {
+                    splitNodes(nodeRight, pair, left, mid, right);
+                    left = joinNodes(nodeLeft, node, left);
+                }
+                else
+                {
+                    left = nodeLeft;
+                    mid = node;
+                    right = nodeRight;
+                }
+            };
+
+            //keeps the elements less than pair and moves the rest into greater, which must be empty
+            void splitAt(Pair const & pair, RBtree & greater)
+            {
+                pointer left = NULL;
+                pointer mid = NULL;
+                pointer right = NULL;
+                splitNodes(this->_root, pair, left, mid, right);
+                if (mid)
+                    right = joinNodes(NULL, mid, right);
+                if (left)
+                {
+                    left->parent = NULL;
+                    left->color = Black;
+                }
+                if (right)
+                {
+                    right->parent = NULL;
+                    right->color = Black;
+                }
+                this->_root = left;
+                greater._root = right;
+            };
+
+            //takes over every element of greater, all of which must be greater than ours
+            void append(RBtree & greater)
+            {
+                this->_root = concatNodes(this->_root, greater._root);
+                greater._root = NULL;
+            };
+
+            //takes over every element of less, all of which must be less than ours
+            void prepend(RBtree & less)
+            {
+                this->_root = concatNodes(less._root, this->_root);
+                less._root = NULL;
+            };
+
+            //relinks the nodes of the subtree one by one, those with a key we already hold are freed
+            void absorb(pointer node)
+            {
+                if (!node)
+                    return ;
+                pointer left = node->left;
+                pointer right = node->right;
+                absorb(left);
+                absorb(right);
+                node->left = NULL;
+                node->right = NULL;
+                node->parent = NULL;
+                insert(node);
+            };
+
+            void absorb(RBtree & other)
+            {
+                pointer node = other._root;
+                other._root = NULL;
+                absorb(node);
+            };
+
+            /*linear time rebuilding*/
+
+            //in-order successor, NULL after the last node
+            pointer next(pointer node) const
+            {
+                if (node->right)
+                    return min(node->right);
+                while (node->parent && node == node->parent->right)
+                    node = node->parent;
+                return node->parent;
+            };
+
+            //prepends the subtree in order to a list chained through right
+            void toList(pointer node, pointer & head)
+            {
+                if (!node)
+                    return ;
+                pointer left = node->left;
+                toList(node->right, head);
+                node->left = NULL;
+                node->parent = NULL;
+                node->right = head;
+                head = node;
+                toList(left, head);
+            };
+
+            pointer fromList(pointer & head, size_t n, size_t depth, size_t redDepth)
+            {
+                if (!n)
+                    return NULL;
+                pointer left = fromList(head, n / 2, depth + 1, redDepth);
+                pointer node = head;
+                head = head->right;
+                node->left = left;
+                if (left)
+                    left->parent = node;
+                node->right = fromList(head, n - n / 2 - 1, depth + 1, redDepth);
+                if (node->right)
+                    node->right->parent = node;
+                node->color = (depth == redDepth) ? Red : Black;
+                node->size = n;
+                return node;
+            };
+
+            //depth of the incomplete bottom level of a balanced tree of n nodes
+            static size_t redDepthFor(size_t n)
+            {
+                size_t redDepth = 0;
+                while ((static_cast<size_t>(2) << redDepth) <= n + 1)
+                    redDepth++;
+                return redDepth;
+            };
+
+            //builds a balanced tree from n sorted nodes chained through right, O(n);
+            //only the incomplete bottom level is red so every path has the same black height
+            pointer buildFromList(pointer head, size_t n)
+            {
+                pointer root = fromList(head, n, 0, redDepthFor(n));
+                if (root)
+                    root->parent = NULL;
+                return root;
+            };
+
+            //same shape and colours as fromList, from an array of sorted nodes
+            static pointer fromArray(pointer const * nodes, size_t n, size_t depth, size_t redDepth)
+            {
+                if (!n)
+                    return NULL;
+                pointer node = nodes[n / 2];
+                node->left = fromArray(nodes, n / 2, depth + 1, redDepth);
+                if (node->left)
+                    node->left->parent = node;
+                node->right = fromArray(nodes + n / 2 + 1, n - n / 2 - 1, depth + 1, redDepth);
+                if (node->right)
+                    node->right->parent = node;
+                node->color = (depth == redDepth) ? Red : Black;
+                node->size = n;
+                return node;
+            };
+
+            //moves the nodes of other whose key we do not hold yet, O(n + m) and without allocation;
+            //the others stay in other
+            void merge(RBtree & other)
+            {
+                pointer left = NULL;
+                pointer right = NULL;
+                pointer head = NULL;
+                pointer rest = NULL;
+                pointer* tail = &head;
+                pointer* restTail = &rest;
+                size_t count = 0;
+                size_t restCount = 0;
+
+                toList(this->_root, left);
+                toList(other._root, right);
+                while (left || right)
+                {
+                    if (right && (!left || this->_comparator(right->pair, left->pair)))
+                    {
+                        *tail = right;
+                        tail = &right->right;
+                        right = right->right;
+                    }
+                    else
+                    {
+                        if (right && !this->_comparator(left->pair, right->pair))
+                        {
+                            *restTail = right;
+                            restTail = &right->right;
+                            right = right->right;
+                            restCount++;
+                        }
+                        *tail = left;
+                        tail = &left->right;
+                        left = left->right;
+                    }
+                    count++;
+                }
+                *tail = NULL;
+                *restTail = NULL;
+                this->_root = buildFromList(head, count);
+                other._root = buildFromList(rest, restCount);
+            };
+
+            void setRoot(pointer root)
+            {
+                this->_root = root;
+            };
+
     };
 }
 
@@ -0,0 +1,44 @@
+#include <iostream>
+#include <vector>
+#include "map.hpp"
+#include "parallel.hpp"
+#include "bench_utils.hpp"
+
+// building an ft::map from unsorted pairs: the range constructor (one insert per
+// pair) against parallel::build with pools of 1 to max_threads threads
+// usage: ./bench_build_parallel [max_threads] [size]
+
+int main(int argc, char** argv)
+{
+    size_t maxThreads = bench::argSize(argc, argv, 1, 64);
+    size_t size = bench::argSize(argc, argv, 2, 1 << 22);
+
+    std::vector<ft::pair<const int, int> > input;
+    bench::random rng(size);
+    for (size_t i = 0; i < size; ++i)
+        input.push_back(ft::make_pair(static_cast<int>(rng() >> 33), static_cast<int>(i)));
+
+    uint64_t start = bench::now();
+    size_t unique;
+    {
+        ft::map<int, int> map(input.begin(), input.end());
+        unique = map.size();
+    }
+    double rangeMs = (bench::now() - start) / 1e6;
+
+    std::cout << "method,threads,size,unique,build_ms,speedup\n";
+    std::cout << "range_ctor,1," << size << ',' << unique << ',' << rangeMs << ",1" << std::endl;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        start = bench::now();
+        {
+            ft::thread_pool pool(threads);
+            ft::map<int, int> map;
+            ft::parallel::build(map, input.begin(), input.end(), pool);
+            unique = map.size();
+        }
+        double ms = (bench::now() - start) / 1e6;
+        std::cout << "parallel_build," << threads << ',' << size << ',' << unique << ',' << ms << ',' << rangeMs / ms << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <vector>
+#include "map.hpp"
+#include "concurrent_map.hpp"
+#include "concurrency.hpp"
+#include "bench_utils.hpp"
+
+// ops/sec of ft::concurrent_map (hash and range sharded) against one ft::map
+// behind a global mutex, for several thread counts and read percentages
+// usage: ./bench_concurrent_map [max_threads] [ops_per_thread] [keys]
+
+struct locked_map
+{
+    ft::mutex lock;
+    ft::map<int, int> map;
+
+    bool find(int key, int& value)
+    {
+        ft::lock_guard<ft::mutex> guard(lock);
+        ft::map<int, int>::iterator it = map.find(key);
+        if (it == map.end())
+            return false;
+        value = it->second;
+        return true;
+    };
+
+    bool insert_or_assign(int key, int value)
+    {
+        ft::lock_guard<ft::mutex> guard(lock);
+        map[key] = value;
+        return true;
+    };
+
+    size_t erase(int key)
+    {
+        ft::lock_guard<ft::mutex> guard(lock);
+        return map.erase(key);
+    };
+};
+
+template <class Map>
+struct job
+{
+    Map* map;
+    size_t ops;
+    size_t keys;
+    unsigned readPercent;
+    unsigned seed;
+    volatile int* start;
+};
+
+template <class Map>
+void* worker(void* arg)
+{
+    job<Map>* j = static_cast<job<Map>*>(arg);
+    bench::random rng(j->seed);
+    int value = 0;
+    long hits = 0;
+    while (!*j->start)
+        ft::cpu_relax();
+    for (size_t i = 0; i < j->ops; ++i)
+    {
+        uint64_t r = rng();
+        int key = static_cast<int>((r >> 8) % j->keys);
+        unsigned dice = static_cast<unsigned>(r % 100);
+        if (dice < j->readPercent)
+            hits += j->map->find(key, value);
+        else if (dice & 1)
+            j->map->insert_or_assign(key, static_cast<int>(i));
+        else
+            j->map->erase(key);
+    }
+    bench::keep(hits);
+    return NULL;
+};
+
+template <class Map>
+double run(Map& map, size_t threads, size_t ops, size_t keys, unsigned readPercent)
+{
+    for (size_t k = 0; k < keys; k += 2)
+        map.insert_or_assign(static_cast<int>(k), 0);
+    std::vector<pthread_t> ids(threads);
+    std::vector<job<Map> > jobs(threads);
+    volatile int start = 0;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        job<Map> j = { &map, ops, keys, readPercent, static_cast<unsigned>(i + 1), &start };
+        jobs[i] = j;
+        pthread_create(&ids[i], NULL, worker<Map>, &jobs[i]);
+    }
+    uint64_t begin = bench::now();
+    start = 1;
+    for (size_t i = 0; i < threads; ++i)
+        pthread_join(ids[i], NULL);
+    return threads * ops * 1e9 / (bench::now() - begin);
+};
+
+int main(int argc, char** argv)
+{
+    size_t maxThreads = bench::argSize(argc, argv, 1, 32);
+    size_t ops = bench::argSize(argc, argv, 2, 1 << 18);
+    size_t keys = bench::argSize(argc, argv, 3, 1 << 20);
+    unsigned mixes[] = { 50, 90, 99 };
+
+    std::vector<int> bounds;
+    for (size_t i = 1; i < 64; ++i)
+        bounds.push_back(static_cast<int>(keys * i / 64));
+
+    std::cout << "read_percent,threads,global_mutex_ops,hash_sharded_ops,range_sharded_ops\n";
+    for (size_t m = 0; m < sizeof(mixes) / sizeof(*mixes); ++m)
+    {
+        for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            locked_map global;
+            ft::concurrent_map<int, int> hashed(ft::hash_partition<int>(64));
+            ft::concurrent_map<int, int, ft::range_partition<int> > ranged(ft::range_partition<int>(bounds.begin(), bounds.end()));
+            std::cout << mixes[m] << ',' << threads << ','
+                << run(global, threads, ops, keys, mixes[m]) << ','
+                << run(hashed, threads, ops, keys, mixes[m]) << ','
+                << run(ranged, threads, ops, keys, mixes[m]) << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <iostream>
+#include <vector>
+#include "stack.hpp"
+#include "concurrent_stack.hpp"
+#include "concurrency.hpp"
+#include "bench_utils.hpp"
+
+// push/pop throughput of ft::concurrent_stack against a mutex-wrapped ft::stack
+// usage: ./bench_concurrent_stack [max_threads] [ops_per_thread]
+
+struct locked_stack
+{
+    ft::mutex lock;
+    ft::stack<int> stack;
+
+    void push(int value)
+    {
+        ft::lock_guard<ft::mutex> guard(lock);
+        stack.push(value);
+    };
+
+    bool pop(int& value)
+    {
+        ft::lock_guard<ft::mutex> guard(lock);
+        if (stack.empty())
+            return false;
+        value = stack.top();
+        stack.pop();
+        return true;
+    };
+};
+
+template <class Stack>
+struct job
+{
+    Stack* stack;
+    size_t ops;
+    volatile int* start;
+    long sum;
+};
+
+//every thread alternates bursts of pushes and pops, keeping the stack shallow
+template <class Stack>
+void* worker(void* arg)
+{
+    job<Stack>* j = static_cast<job<Stack>*>(arg);
+    int value = 0;
+    long sum = 0;
+    while (!*j->start)
+        ft::cpu_relax();
+    for (size_t i = 0; i < j->ops; i += 8)
+    {
+        for (int k = 0; k < 4; ++k)
+            j->stack->push(static_cast<int>(i) + k);
+        for (int k = 0; k < 4; ++k)
+            if (j->stack->pop(value))
+                sum += value;
+    }
+    j->sum = sum;
+    return NULL;
+};
+
+template <class Stack>
+double run(Stack& stack, size_t threads, size_t ops)
+{
+    std::vector<pthread_t> ids(threads);
+    std::vector<job<Stack> > jobs(threads);
+    volatile int start = 0;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        jobs[i].stack = &stack;
+        jobs[i].ops = ops;
+        jobs[i].start = &start;
+        pthread_create(&ids[i], NULL, worker<Stack>, &jobs[i]);
+    }
+    uint64_t begin = bench::now();
+    start = 1;
+    for (size_t i = 0; i < threads; ++i)
+        pthread_join(ids[i], NULL);
+    uint64_t elapsed = bench::now() - begin;
+    return threads * ops * 1000.0 / elapsed;
+};
+
+int main(int argc, char** argv)
+{
+    size_t maxThreads = bench::argSize(argc, argv, 1, 32);
+    size_t ops = bench::argSize(argc, argv, 2, 1 << 20);
+
+    std::cout << "threads,mutex_stack_mops,concurrent_stack_mops,elimination_mops\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        locked_stack locked;
+        ft::concurrent_stack<int> lockFree;
+        ft::concurrent_stack<int> eliminating(16);
+        std::cout << threads << ',' << run(locked, threads, ops) << ','
+            << run(lockFree, threads, ops) << ',' << run(eliminating, threads, ops) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <iostream>
+#include <vector>
+#include "vector.hpp"
+#include "concurrent_vector.hpp"
+#include "concurrency.hpp"
+#include "bench_utils.hpp"
+
+// appends/sec with many threads: ft::vector behind a mutex against
+// ft::concurrent_vector push_back and grow_by in batches of 64
+// usage: ./bench_concurrent_vector [max_threads] [appends_per_thread]
+
+struct locked_vector
+{
+    ft::mutex lock;
+    ft::vector<long> vector;
+
+    void append(long value)
+    {
+        ft::lock_guard<ft::mutex> guard(lock);
+        vector.push_back(value);
+    };
+};
+
+struct segmented_vector
+{
+    ft::concurrent_vector<long> vector;
+
+    void append(long value)
+    {
+        vector.push_back(value);
+    };
+};
+
+//claims 64 slots at a time and fills them in place
+struct batched_vector
+{
+    ft::concurrent_vector<long> vector;
+};
+
+template <class Vector>
+struct job
+{
+    Vector* vector;
+    size_t appends;
+    volatile int* start;
+};
+
+template <class Vector>
+void append(job<Vector>* j)
+{
+    for (size_t i = 0; i < j->appends; ++i)
+        j->vector->append(static_cast<long>(i));
+};
+
+void append(job<batched_vector>* j)
+{
+    for (size_t i = 0; i < j->appends; i += 64)
+    {
+        size_t first = j->vector->vector.grow_by(64);
+        for (size_t k = 0; k < 64; ++k)
+            j->vector->vector[first + k] = static_cast<long>(i + k);
+    }
+};
+
+template <class Vector>
+void* worker(void* arg)
+{
+    job<Vector>* j = static_cast<job<Vector>*>(arg);
+    while (!*j->start)
+        ft::cpu_relax();
+    append(j);
+    return NULL;
+};
+
+template <class Vector>
+double run(size_t threads, size_t appends)
+{
+    Vector vector;
+    std::vector<pthread_t> ids(threads);
+    std::vector<job<Vector> > jobs(threads);
+    volatile int start = 0;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        job<Vector> j = { &vector, appends, &start };
+        jobs[i] = j;
+        pthread_create(&ids[i], NULL, worker<Vector>, &jobs[i]);
+    }
+    uint64_t begin = bench::now();
+    start = 1;
+    for (size_t i = 0; i < threads; ++i)
+        pthread_join(ids[i], NULL);
+    return threads * appends * 1e9 / (bench::now() - begin);
+};
+
+int main(int argc, char** argv)
+{
+    size_t maxThreads = bench::argSize(argc, argv, 1, 32);
+    size_t appends = bench::argSize(argc, argv, 2, 1 << 20) & ~static_cast<size_t>(63);
+
+    std::cout << "threads,mutex_vector_ops,push_back_ops,grow_by_64_ops\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        std::cout << threads << ','
+            << run<locked_vector>(threads, appends) << ','
+            << run<segmented_vector>(threads, appends) << ','
+            << run<batched_vector>(threads, appends) << std::endl;
+    }
+    return 0;
+}
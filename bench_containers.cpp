@@ -0,0 +1,694 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stack>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cstring>
+#include "vector.hpp"
+#include "stack.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "bench_utils.hpp"
+#include "perf_counters.hpp"
+#include "latency_histogram.hpp"
+
+// ft:: against std:: for vector, stack, map and set: every operation is run
+// over each size and key distribution, repeats times per library, and the
+// median time per element is reported with the ft/std ratio, along with the
+// median hardware counts per element (cycles, instructions, L1d/LLC misses,
+// branch misses) where perf_event_open is allowed; the others are left empty.
+// --histogram times every single push_back, insert and erase instead and
+// reports p50/p99/p99.9/max per operation, for each vector growth strategy
+// (doubling, reserved up front, ft::vector's incremental growth);
+// each sample includes one clock read.
+// usage: ./bench_containers [--json] [--histogram] [--no-counters] [--repeats n] [--sizes n,n,...] [--only container]
+
+typedef std::vector<int> keys_type;
+
+//one timed region; the op sets ops to the number of elements it handled
+struct region
+{
+    bench::perf_counters* counters;
+    uint64_t begin;
+    uint64_t ns;
+    size_t ops;
+    uint64_t events[bench::perfEvents];
+
+    explicit region(bench::perf_counters* counters): counters(counters), begin(0), ns(0), ops(0)
+    {
+        for (int i = 0; i < bench::perfEvents; ++i)
+            events[i] = 0;
+    };
+
+    //the counters go around the clock reads so their syscalls stay out of ns
+    void start()
+    {
+        if (counters)
+            counters->start();
+        begin = bench::now();
+    };
+
+    void stop()
+    {
+        ns = bench::now() - begin;
+        if (!counters)
+            return ;
+        counters->stop();
+        for (int i = 0; i < bench::perfEvents; ++i)
+            events[i] = counters->value(i);
+    };
+};
+
+typedef void (*op_function)(region&, const keys_type&);
+typedef void (*latency_function)(bench::latency_histogram&, const keys_type&);
+
+#define FT_TIME_EACH(histogram, op) \
+    do { uint64_t opStart = bench::now(); op; histogram.record(bench::now() - opStart); } while (0)
+
+/*vector*/
+template <class Vector>
+struct vector_ops
+{
+    static void fill(Vector& v, const keys_type& keys)
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            v.push_back(keys[i]);
+    };
+
+    static void push_back(region& r, const keys_type& keys)
+    {
+        Vector v;
+        r.start();
+        fill(v, keys);
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(v.size());
+    };
+
+    //a few inserts in the middle, each shifting half of the elements
+    static void insert(region& r, const keys_type& keys)
+    {
+        Vector v;
+        fill(v, keys);
+        size_t n = keys.size() < 1024 ? keys.size() : 1024;
+        r.start();
+        for (size_t i = 0; i < n; ++i)
+            v.insert(v.begin() + v.size() / 2, keys[i]);
+        r.stop();
+        r.ops = n;
+        bench::keep(v.size());
+    };
+
+    static void erase(region& r, const keys_type& keys)
+    {
+        Vector v;
+        fill(v, keys);
+        size_t n = keys.size() < 1024 ? keys.size() : 1024;
+        r.start();
+        for (size_t i = 0; i < n; ++i)
+            v.erase(v.begin() + v.size() / 2);
+        r.stop();
+        r.ops = n;
+        bench::keep(v.size());
+    };
+
+    //reads at the key positions, the vector analogue of a lookup
+    static void find(region& r, const keys_type& keys)
+    {
+        Vector v;
+        fill(v, keys);
+        size_t n = v.size();
+        long sum = 0;
+        r.start();
+        for (size_t i = 0; i < keys.size(); ++i)
+            sum += v[static_cast<size_t>(keys[i]) % n];
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(sum);
+    };
+
+    static void iterate(region& r, const keys_type& keys)
+    {
+        Vector v;
+        fill(v, keys);
+        long sum = 0;
+        r.start();
+        for (typename Vector::iterator it = v.begin(); it != v.end(); ++it)
+            sum += *it;
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(sum);
+    };
+
+    static void copy(region& r, const keys_type& keys)
+    {
+        Vector v;
+        fill(v, keys);
+        r.start();
+        Vector c(v);
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(c.size());
+    };
+
+    static void clear(region& r, const keys_type& keys)
+    {
+        Vector v;
+        fill(v, keys);
+        r.start();
+        v.clear();
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(v.size());
+    };
+
+    /*one sample per operation*/
+    static void push_back_latency(bench::latency_histogram& h, const keys_type& keys)
+    {
+        Vector v;
+        for (size_t i = 0; i < keys.size(); ++i)
+            FT_TIME_EACH(h, v.push_back(keys[i]));
+        bench::keep(v.size());
+    };
+
+    //capacity reserved up front, so no push_back reallocates
+    static void push_back_reserved_latency(bench::latency_histogram& h, const keys_type& keys)
+    {
+        Vector v;
+        v.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i)
+            FT_TIME_EACH(h, v.push_back(keys[i]));
+        bench::keep(v.size());
+    };
+
+    //ft::vector only: the old buffer is migrated a few elements per push_back
+    static void push_back_incremental_latency(bench::latency_histogram& h, const keys_type& keys)
+    {
+        Vector v;
+        v.set_incremental_growth(true);
+        for (size_t i = 0; i < keys.size(); ++i)
+            FT_TIME_EACH(h, v.push_back(keys[i]));
+        bench::keep(v.size());
+    };
+
+    static void insert_latency(bench::latency_histogram& h, const keys_type& keys)
+    {
+        Vector v;
+        fill(v, keys);
+        size_t n = keys.size() < 1024 ? keys.size() : 1024;
+        for (size_t i = 0; i < n; ++i)
+            FT_TIME_EACH(h, v.insert(v.begin() + v.size() / 2, keys[i]));
+        bench::keep(v.size());
+    };
+
+    static void erase_latency(bench::latency_histogram& h, const keys_type& keys)
+    {
+        Vector v;
+        fill(v, keys);
+        size_t n = keys.size() < 1024 ? keys.size() : 1024;
+        for (size_t i = 0; i < n; ++i)
+            FT_TIME_EACH(h, v.erase(v.begin() + v.size() / 2));
+        bench::keep(v.size());
+    };
+};
+
+/*stack*/
+template <class Stack>
+struct stack_ops
+{
+    static void push(region& r, const keys_type& keys)
+    {
+        Stack s;
+        r.start();
+        for (size_t i = 0; i < keys.size(); ++i)
+            s.push(keys[i]);
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(s.size());
+    };
+
+    static void pop(region& r, const keys_type& keys)
+    {
+        Stack s;
+        for (size_t i = 0; i < keys.size(); ++i)
+            s.push(keys[i]);
+        long sum = 0;
+        r.start();
+        while (!s.empty())
+        {
+            sum += s.top();
+            s.pop();
+        }
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(sum);
+    };
+
+    static void copy(region& r, const keys_type& keys)
+    {
+        Stack s;
+        for (size_t i = 0; i < keys.size(); ++i)
+            s.push(keys[i]);
+        r.start();
+        Stack c(s);
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(c.size());
+    };
+};
+
+/*map and set*/
+template <class Tree>
+struct tree_value
+{
+    static typename Tree::value_type make(int key)
+    {
+        return typename Tree::value_type(key, key);
+    };
+};
+
+template <class Key>
+struct tree_value<ft::set<Key> >
+{
+    static Key make(int key)
+    {
+        return key;
+    };
+};
+
+template <class Key>
+struct tree_value<std::set<Key> >
+{
+    static Key make(int key)
+    {
+        return key;
+    };
+};
+
+template <class Tree>
+struct tree_ops
+{
+    static void fill(Tree& t, const keys_type& keys)
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+            t.insert(tree_value<Tree>::make(keys[i]));
+    };
+
+    static void insert(region& r, const keys_type& keys)
+    {
+        Tree t;
+        r.start();
+        fill(t, keys);
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(t.size());
+    };
+
+    static void erase(region& r, const keys_type& keys)
+    {
+        Tree t;
+        fill(t, keys);
+        size_t erased = 0;
+        r.start();
+        for (size_t i = 0; i < keys.size(); ++i)
+            erased += t.erase(keys[i]);
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(erased);
+    };
+
+    static void find(region& r, const keys_type& keys)
+    {
+        Tree t;
+        fill(t, keys);
+        size_t found = 0;
+        r.start();
+        for (size_t i = 0; i < keys.size(); ++i)
+            found += t.find(keys[i]) != t.end();
+        r.stop();
+        r.ops = keys.size();
+        bench::keep(found);
+    };
+
+    static void iterate(region& r, const keys_type& keys)
+    {
+        Tree t;
+        fill(t, keys);
+        size_t n = 0;
+        r.start();
+        for (typename Tree::iterator it = t.begin(); it != t.end(); ++it)
+            ++n;
+        r.stop();
+        r.ops = t.size();
+        bench::keep(n);
+    };
+
+    static void copy(region& r, const keys_type& keys)
+    {
+        Tree t;
+        fill(t, keys);
+        r.start();
+        Tree c(t);
+        r.stop();
+        r.ops = t.size();
+        bench::keep(c.size());
+    };
+
+    static void clear(region& r, const keys_type& keys)
+    {
+        Tree t;
+        fill(t, keys);
+        r.ops = t.size();
+        r.start();
+        t.clear();
+        r.stop();
+        bench::keep(t.size());
+    };
+
+    /*one sample per operation*/
+    static void insert_latency(bench::latency_histogram& h, const keys_type& keys)
+    {
+        Tree t;
+        for (size_t i = 0; i < keys.size(); ++i)
+            FT_TIME_EACH(h, t.insert(tree_value<Tree>::make(keys[i])));
+        bench::keep(t.size());
+    };
+
+    static void erase_latency(bench::latency_histogram& h, const keys_type& keys)
+    {
+        Tree t;
+        fill(t, keys);
+        for (size_t i = 0; i < keys.size(); ++i)
+            FT_TIME_EACH(h, t.erase(keys[i]));
+        bench::keep(t.size());
+    };
+};
+
+struct bench_case
+{
+    const char* container;
+    const char* op;
+    op_function ft;
+    op_function std;
+};
+
+typedef vector_ops<ft::vector<int> > ft_vector;
+typedef vector_ops<std::vector<int> > std_vector;
+typedef stack_ops<ft::stack<int> > ft_stack;
+typedef stack_ops<std::stack<int> > std_stack;
+typedef tree_ops<ft::map<int, int> > ft_map;
+typedef tree_ops<std::map<int, int> > std_map;
+typedef tree_ops<ft::set<int> > ft_set;
+typedef tree_ops<std::set<int> > std_set;
+
+const bench_case cases[] = {
+    { "vector", "push_back", ft_vector::push_back, std_vector::push_back },
+    { "vector", "insert", ft_vector::insert, std_vector::insert },
+    { "vector", "erase", ft_vector::erase, std_vector::erase },
+    { "vector", "find", ft_vector::find, std_vector::find },
+    { "vector", "iterate", ft_vector::iterate, std_vector::iterate },
+    { "vector", "copy", ft_vector::copy, std_vector::copy },
+    { "vector", "clear", ft_vector::clear, std_vector::clear },
+    { "stack", "push", ft_stack::push, std_stack::push },
+    { "stack", "pop", ft_stack::pop, std_stack::pop },
+    { "stack", "copy", ft_stack::copy, std_stack::copy },
+    { "map", "insert", ft_map::insert, std_map::insert },
+    { "map", "erase", ft_map::erase, std_map::erase },
+    { "map", "find", ft_map::find, std_map::find },
+    { "map", "iterate", ft_map::iterate, std_map::iterate },
+    { "map", "copy", ft_map::copy, std_map::copy },
+    { "map", "clear", ft_map::clear, std_map::clear },
+    { "set", "insert", ft_set::insert, std_set::insert },
+    { "set", "erase", ft_set::erase, std_set::erase },
+    { "set", "find", ft_set::find, std_set::find },
+    { "set", "iterate", ft_set::iterate, std_set::iterate },
+    { "set", "copy", ft_set::copy, std_set::copy },
+    { "set", "clear", ft_set::clear, std_set::clear }
+};
+
+//library and growth strategy are reported as they are, so vector push_back can be compared across them
+struct latency_case
+{
+    const char* container;
+    const char* op;
+    const char* library;
+    const char* strategy;
+    latency_function run;
+};
+
+const latency_case latencyCases[] = {
+    { "vector", "push_back", "ft", "doubling", ft_vector::push_back_latency },
+    { "vector", "push_back", "ft", "reserved", ft_vector::push_back_reserved_latency },
+    { "vector", "push_back", "ft", "incremental", ft_vector::push_back_incremental_latency },
+    { "vector", "push_back", "std", "doubling", std_vector::push_back_latency },
+    { "vector", "push_back", "std", "reserved", std_vector::push_back_reserved_latency },
+    { "vector", "insert", "ft", "-", ft_vector::insert_latency },
+    { "vector", "insert", "std", "-", std_vector::insert_latency },
+    { "vector", "erase", "ft", "-", ft_vector::erase_latency },
+    { "vector", "erase", "std", "-", std_vector::erase_latency },
+    { "map", "insert", "ft", "-", ft_map::insert_latency },
+    { "map", "insert", "std", "-", std_map::insert_latency },
+    { "map", "erase", "ft", "-", ft_map::erase_latency },
+    { "map", "erase", "std", "-", std_map::erase_latency }
+};
+
+const char* const distributions[] = { "sequential", "reverse", "random" };
+
+keys_type makeKeys(const char* distribution, size_t size)
+{
+    keys_type keys(size);
+    bench::random rng(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (!strcmp(distribution, "sequential"))
+            keys[i] = static_cast<int>(i);
+        else if (!strcmp(distribution, "reverse"))
+            keys[i] = static_cast<int>(size - i);
+        else
+            keys[i] = static_cast<int>(rng() >> 33);
+    }
+    return keys;
+}
+
+double median(std::vector<double>& values)
+{
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+//repeated runs of one library, medians per element
+class samples
+{
+    std::vector<double> _ns;
+    std::vector<double> _events[bench::perfEvents];
+
+    public:
+        void add(const region& r)
+        {
+            double ops = r.ops ? static_cast<double>(r.ops) : 1;
+            this->_ns.push_back(r.ns / ops);
+            for (int i = 0; i < bench::perfEvents; ++i)
+                this->_events[i].push_back(r.events[i] / ops);
+        };
+
+        double ns()
+        {
+            return median(this->_ns);
+        };
+
+        double event(int i)
+        {
+            return median(this->_events[i]);
+        };
+};
+
+struct result
+{
+    const bench_case* c;
+    const char* distribution;
+    size_t size;
+    size_t ops;
+    samples* ft;
+    samples* std;
+};
+
+void printCsvHeader()
+{
+    std::cout << "container,op,distribution,size,ops,ft_ns_per_op,std_ns_per_op,ft_std_ratio";
+    for (int i = 0; i < bench::perfEvents; ++i)
+        std::cout << ",ft_" << bench::perfEventNames[i] << "_per_op,std_" << bench::perfEventNames[i] << "_per_op";
+    std::cout << '\n';
+}
+
+void printCsv(const result& r, const bench::perf_counters* counters)
+{
+    double ft = r.ft->ns();
+    double std = r.std->ns();
+    std::cout << r.c->container << ',' << r.c->op << ',' << r.distribution << ',' << r.size << ',' << r.ops
+        << ',' << ft << ',' << std << ',' << ft / std;
+    for (int i = 0; i < bench::perfEvents; ++i)
+    {
+        if (counters && counters->available(i))
+            std::cout << ',' << r.ft->event(i) << ',' << r.std->event(i);
+        else
+            std::cout << ",,";
+    }
+    std::cout << std::endl;
+}
+
+void printJson(const result& r, const bench::perf_counters* counters, bool first)
+{
+    double ft = r.ft->ns();
+    double std = r.std->ns();
+    std::cout << (first ? "[\n" : ",\n") << "  {\"container\": \"" << r.c->container << "\", \"op\": \"" << r.c->op
+        << "\", \"distribution\": \"" << r.distribution << "\", \"size\": " << r.size << ", \"ops\": " << r.ops
+        << ", \"ft_ns_per_op\": " << ft << ", \"std_ns_per_op\": " << std << ", \"ft_std_ratio\": " << ft / std;
+    for (int i = 0; i < bench::perfEvents; ++i)
+    {
+        std::cout << ", \"ft_" << bench::perfEventNames[i] << "_per_op\": ";
+        if (counters && counters->available(i))
+            std::cout << r.ft->event(i);
+        else
+            std::cout << "null";
+        std::cout << ", \"std_" << bench::perfEventNames[i] << "_per_op\": ";
+        if (counters && counters->available(i))
+            std::cout << r.std->event(i);
+        else
+            std::cout << "null";
+    }
+    std::cout << "}";
+}
+
+void printHistogram(const latency_case& c, const char* distribution, size_t size, const bench::latency_histogram& h, bool json, bool first)
+{
+    if (json)
+        std::cout << (first ? "[\n" : ",\n") << "  {\"container\": \"" << c.container << "\", \"op\": \"" << c.op
+            << "\", \"library\": \"" << c.library << "\", \"strategy\": \"" << c.strategy << "\", \"distribution\": \"" << distribution
+            << "\", \"size\": " << size << ", \"count\": " << h.count() << ", \"p50_ns\": " << h.percentile(0.5)
+            << ", \"p99_ns\": " << h.percentile(0.99) << ", \"p999_ns\": " << h.percentile(0.999) << ", \"max_ns\": " << h.max() << "}";
+    else
+        std::cout << c.container << ',' << c.op << ',' << c.library << ',' << c.strategy << ',' << distribution << ',' << size
+            << ',' << h.count() << ',' << h.percentile(0.5) << ',' << h.percentile(0.99) << ',' << h.percentile(0.999) << ',' << h.max() << std::endl;
+}
+
+//every repeat goes into the same histogram
+void runHistograms(const std::vector<size_t>& sizes, size_t repeats, const char* only, bool json)
+{
+    bool first = true;
+    if (!json)
+        std::cout << "container,op,library,strategy,distribution,size,count,p50_ns,p99_ns,p999_ns,max_ns\n";
+    for (size_t c = 0; c < sizeof(latencyCases) / sizeof(*latencyCases); ++c)
+    {
+        if (only && strcmp(only, latencyCases[c].container))
+            continue ;
+        for (size_t d = 0; d < sizeof(distributions) / sizeof(*distributions); ++d)
+            for (size_t s = 0; s < sizes.size(); ++s)
+            {
+                keys_type keys = makeKeys(distributions[d], sizes[s]);
+                bench::latency_histogram h;
+                for (size_t i = 0; i < repeats; ++i)
+                    latencyCases[c].run(h, keys);
+                printHistogram(latencyCases[c], distributions[d], sizes[s], h, json, first);
+                first = false;
+            }
+    }
+    if (json)
+        std::cout << (first ? "[]\n" : "\n]\n");
+}
+
+std::vector<size_t> parseSizes(const char* list)
+{
+    std::vector<size_t> sizes;
+    while (*list)
+    {
+        char* end;
+        sizes.push_back(static_cast<size_t>(strtoul(list, &end, 10)));
+        list = *end ? end + 1 : end;
+    }
+    return sizes;
+}
+
+int main(int argc, char** argv)
+{
+    bool json = false;
+    bool useCounters = true;
+    bool histogram = false;
+    size_t repeats = 5;
+    const char* only = NULL;
+    std::vector<size_t> sizes = parseSizes("1000,10000,100000");
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "--json"))
+            json = true;
+        else if (!strcmp(argv[i], "--no-counters"))
+            useCounters = false;
+        else if (!strcmp(argv[i], "--histogram"))
+            histogram = true;
+        else if (!strcmp(argv[i], "--repeats") && i + 1 < argc)
+            repeats = static_cast<size_t>(strtoul(argv[++i], NULL, 10));
+        else if (!strcmp(argv[i], "--sizes") && i + 1 < argc)
+            sizes = parseSizes(argv[++i]);
+        else if (!strcmp(argv[i], "--only") && i + 1 < argc)
+            only = argv[++i];
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--json] [--histogram] [--no-counters] [--repeats n] [--sizes n,n,...] [--only container]" << std::endl;
+            return 1;
+        }
+    }
+    if (!repeats)
+        repeats = 1;
+    if (histogram)
+    {
+        runHistograms(sizes, repeats, only, json);
+        return 0;
+    }
+
+    bench::perf_counters perf;
+    bench::perf_counters* counters = useCounters ? &perf : NULL;
+    if (counters && !counters->any())
+    {
+        std::cerr << "perf_event_open not permitted here, hardware counter columns are left empty" << std::endl;
+        counters = NULL;
+    }
+
+    bool first = true;
+    if (!json)
+        printCsvHeader();
+    for (size_t c = 0; c < sizeof(cases) / sizeof(*cases); ++c)
+    {
+        if (only && strcmp(only, cases[c].container))
+            continue ;
+        for (size_t d = 0; d < sizeof(distributions) / sizeof(*distributions); ++d)
+            for (size_t s = 0; s < sizes.size(); ++s)
+            {
+                keys_type keys = makeKeys(distributions[d], sizes[s]);
+                samples ft;
+                samples std;
+                size_t ops = 0;
+                for (size_t i = 0; i < repeats; ++i)
+                {
+                    region r(counters);
+                    cases[c].ft(r, keys);
+                    ft.add(r);
+                    region q(counters);
+                    cases[c].std(q, keys);
+                    std.add(q);
+                    ops = r.ops;
+                }
+                result res = { &cases[c], distributions[d], sizes[s], ops, &ft, &std };
+                if (json)
+                    printJson(res, counters, first);
+                else
+                    printCsv(res, counters);
+                first = false;
+            }
+    }
+    if (json)
+        std::cout << (first ? "[]\n" : "\n]\n");
+    return 0;
+}
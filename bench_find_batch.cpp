@@ -0,0 +1,50 @@
+#include <iostream>
+#include <vector>
+#include "map.hpp"
+#include "set.hpp"
+#include "vector.hpp"
+#include "bench_utils.hpp"
+
+// throughput of map::find_batch against a loop of map::find
+// usage: ./bench_find_batch [max_size] [lookups]
+
+int main(int argc, char** argv)
+{
+    size_t maxSize = bench::argSize(argc, argv, 1, 1 << 22);
+    size_t lookups = bench::argSize(argc, argv, 2, 1 << 21);
+
+    std::cout << "size,lookups,find_mops,find_batch_mops,speedup\n";
+    for (size_t size = 1 << 10; size <= maxSize; size <<= 2)
+    {
+        bench::random rng(size);
+        ft::map<int, int> map;
+        for (size_t i = 0; i < size; ++i)
+            map.insert(ft::make_pair(static_cast<int>(rng() % (size * 4)), static_cast<int>(i)));
+
+        std::vector<int> keys(lookups);
+        for (size_t i = 0; i < lookups; ++i)
+            keys[i] = static_cast<int>(rng() % (size * 4));
+        std::vector<ft::map<int, int>::iterator> found(lookups);
+
+        size_t hits = 0;
+        uint64_t start = bench::now();
+        for (size_t i = 0; i < lookups; ++i)
+            found[i] = map.find(keys[i]);
+        uint64_t loop = bench::now() - start;
+        for (size_t i = 0; i < lookups; ++i)
+            hits += (found[i] != map.end());
+
+        start = bench::now();
+        map.find_batch(keys.begin(), keys.end(), found.begin());
+        uint64_t batch = bench::now() - start;
+        for (size_t i = 0; i < lookups; ++i)
+            hits -= (found[i] != map.end());
+        if (hits)
+            std::cerr << "find_batch disagrees with find\n";
+
+        std::cout << size << ',' << lookups << ','
+            << lookups * 1000.0 / loop << ',' << lookups * 1000.0 / batch << ','
+            << static_cast<double>(loop) / batch << '\n';
+    }
+    return 0;
+}
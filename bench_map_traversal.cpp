@@ -0,0 +1,79 @@
+#include <iostream>
+#include "map.hpp"
+#include "parallel.hpp"
+#include "bench_utils.hpp"
+
+// ft::parallel::for_each and reduce over one ft::map<int, long> with pools of 1
+// to max_threads threads, against a plain iterator loop on the calling thread
+// usage: ./bench_map_traversal [max_threads] [size]
+
+typedef ft::map<int, long> map_type;
+
+struct bump
+{
+    void operator()(map_type::value_type& value) const
+    {
+        value.second = value.second * 3 + 1;
+    };
+};
+
+struct add_value
+{
+    long operator()(long acc, const map_type::value_type& value) const
+    {
+        return acc + value.second;
+    };
+};
+
+struct sum
+{
+    long operator()(long lhs, long rhs) const
+    {
+        return lhs + rhs;
+    };
+};
+
+int main(int argc, char** argv)
+{
+    size_t maxThreads = bench::argSize(argc, argv, 1, 64);
+    size_t size = bench::argSize(argc, argv, 2, 1 << 22);
+
+    ft::vector<map_type::value_type> pairs;
+    pairs.reserve(size);
+    bench::random rng(size);
+    for (size_t i = 0; i < size; ++i)
+        pairs.push_back(ft::make_pair(static_cast<int>(rng() >> 33), static_cast<long>(i)));
+    map_type map;
+    ft::parallel::build(map, pairs.begin(), pairs.end());
+
+    uint64_t start = bench::now();
+    for (map_type::iterator it = map.begin(); it != map.end(); ++it)
+        bump()(*it);
+    double loopForEach = (bench::now() - start) / 1e6;
+
+    start = bench::now();
+    long total = 0;
+    for (map_type::iterator it = map.begin(); it != map.end(); ++it)
+        total = add_value()(total, *it);
+    double loopReduce = (bench::now() - start) / 1e6;
+    bench::keep(total);
+
+    std::cout << "threads,size,for_each_ms,reduce_ms,loop_for_each_ms,loop_reduce_ms,for_each_speedup,reduce_speedup\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        ft::thread_pool pool(threads);
+
+        start = bench::now();
+        ft::parallel::for_each(map, bump(), pool);
+        double forEach = (bench::now() - start) / 1e6;
+
+        start = bench::now();
+        long result = ft::parallel::reduce(map, 0L, add_value(), sum(), pool);
+        double reduce = (bench::now() - start) / 1e6;
+        bench::keep(result);
+
+        std::cout << threads << ',' << map.size() << ',' << forEach << ',' << reduce << ',' << loopForEach << ',' << loopReduce
+            << ',' << loopForEach / forEach << ',' << loopReduce / reduce << std::endl;
+    }
+    return 0;
+}
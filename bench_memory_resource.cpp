@@ -0,0 +1,104 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "vector.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "memory_resource.hpp"
+#include "bench_utils.hpp"
+
+// One simulated request builds a vector, a map and a set of request_size
+// elements, looks a few things up and throws them away. Per-request latency
+// with std::allocator, with a monotonic arena released after every request
+// (its first buffer is reused, so steady state never reaches the heap) and
+// with an unsynchronized pool shared by all requests.
+// usage: ./bench_memory_resource [requests] [request_size]
+
+template <class T>
+struct with_std
+{
+    typedef std::allocator<T> type;
+};
+
+template <class T>
+struct with_resource
+{
+    typedef ft::polymorphic_allocator<T> type;
+};
+
+template <template <class> class Alloc>
+long serve(size_t size, bench::random& rng, const typename Alloc<int>::type& alloc)
+{
+    typedef ft::pair<const int, long> entry;
+    ft::vector<int, typename Alloc<int>::type> values(alloc);
+    ft::map<int, long, ft::less<int>, typename Alloc<entry>::type> index((ft::less<int>()), typename Alloc<entry>::type(alloc));
+    ft::set<int, ft::less<int>, typename Alloc<int>::type> seen((ft::less<int>()), alloc);
+    for (size_t i = 0; i < size; ++i)
+    {
+        int key = static_cast<int>(rng() >> 40);
+        values.push_back(key);
+        index.insert(ft::make_pair(key, static_cast<long>(i)));
+        seen.insert(key & 1023);
+    }
+    long hits = 0;
+    for (size_t i = 0; i < size; ++i)
+        hits += index.count(values[i] ^ 1) + seen.count(values[i] & 511);
+    return hits;
+}
+
+void report(const char* name, std::vector<uint64_t>& ns)
+{
+    std::sort(ns.begin(), ns.end());
+    double total = 0;
+    for (size_t i = 0; i < ns.size(); ++i)
+        total += ns[i];
+    std::cout << name << ',' << ns.size() << ',' << total / ns.size() / 1e3 << ',' << ns[ns.size() / 2] / 1e3
+        << ',' << ns[ns.size() * 99 / 100] / 1e3 << ',' << ns.back() / 1e3 << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    size_t requests = bench::argSize(argc, argv, 1, 20000);
+    size_t size = bench::argSize(argc, argv, 2, 256);
+    std::vector<uint64_t> ns(requests);
+    long hits = 0;
+
+    std::cout << "allocator,requests,mean_us,p50_us,p99_us,max_us\n";
+    {
+        bench::random rng(size);
+        for (size_t r = 0; r < requests; ++r)
+        {
+            uint64_t start = bench::now();
+            hits += serve<with_std>(size, rng, std::allocator<int>());
+            ns[r] = bench::now() - start;
+        }
+        report("std::allocator", ns);
+    }
+    {
+        bench::random rng(size);
+        std::vector<char> buffer(size * 256);
+        for (size_t r = 0; r < requests; ++r)
+        {
+            uint64_t start = bench::now();
+            {
+                ft::monotonic_buffer_resource arena(&buffer[0], buffer.size());
+                hits += serve<with_resource>(size, rng, &arena);
+            }
+            ns[r] = bench::now() - start;
+        }
+        report("monotonic_buffer_resource", ns);
+    }
+    {
+        bench::random rng(size);
+        ft::unsynchronized_pool_resource pool;
+        for (size_t r = 0; r < requests; ++r)
+        {
+            uint64_t start = bench::now();
+            hits += serve<with_resource>(size, rng, &pool);
+            ns[r] = bench::now() - start;
+        }
+        report("unsynchronized_pool_resource", ns);
+    }
+    bench::keep(hits);
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <iostream>
+#include <vector>
+#include "queue.hpp"
+#include "mpmc_ring.hpp"
+#include "concurrency.hpp"
+#include "bench_utils.hpp"
+
+// throughput and enqueue-to-dequeue latency of ft::mpmc_ring against a
+// mutex-wrapped ft::queue, with as many producers as consumers
+// usage: ./bench_mpmc_ring [max_threads] [items_per_producer] [batch]
+
+struct locked_queue
+{
+    ft::mutex lock;
+    ft::queue<uint64_t> queue;
+
+    size_t try_push_n(const uint64_t* values, size_t n)
+    {
+        ft::lock_guard<ft::mutex> guard(lock);
+        for (size_t i = 0; i < n; ++i)
+            queue.push(values[i]);
+        return n;
+    };
+
+    size_t try_pop_n(uint64_t* values, size_t n)
+    {
+        ft::lock_guard<ft::mutex> guard(lock);
+        size_t i = 0;
+        for (; i < n && !queue.empty(); ++i)
+        {
+            values[i] = queue.front();
+            queue.pop();
+        }
+        return i;
+    };
+};
+
+template <class Queue>
+struct job
+{
+    Queue* queue;
+    size_t items;
+    size_t batch;
+    volatile int* start;
+    uint64_t latency;
+    size_t received;
+};
+
+//items are their own push timestamps
+template <class Queue>
+void* producer(void* arg)
+{
+    job<Queue>* j = static_cast<job<Queue>*>(arg);
+    uint64_t values[64];
+    while (!*j->start)
+        ft::cpu_relax();
+    for (size_t sent = 0; sent < j->items; )
+    {
+        size_t n = j->items - sent < j->batch ? j->items - sent : j->batch;
+        uint64_t stamp = bench::now();
+        for (size_t i = 0; i < n; ++i)
+            values[i] = stamp;
+        size_t pushed = 0;
+        while (pushed < n)
+        {
+            size_t res = j->queue->try_push_n(values + pushed, n - pushed);
+            if (!res)
+                sched_yield();
+            pushed += res;
+        }
+        sent += n;
+    }
+    return NULL;
+};
+
+template <class Queue>
+void* consumer(void* arg)
+{
+    job<Queue>* j = static_cast<job<Queue>*>(arg);
+    uint64_t values[64];
+    while (!*j->start)
+        ft::cpu_relax();
+    while (j->received < j->items)
+    {
+        size_t n = j->queue->try_pop_n(values, j->batch);
+        if (!n)
+        {
+            sched_yield();
+            continue ;
+        }
+        uint64_t stamp = bench::now();
+        for (size_t i = 0; i < n; ++i)
+            j->latency += stamp - values[i];
+        j->received += n;
+    }
+    return NULL;
+};
+
+template <class Queue>
+void run(const char* name, Queue& queue, size_t threads, size_t items, size_t batch)
+{
+    std::vector<pthread_t> ids(2 * threads);
+    std::vector<job<Queue> > jobs(2 * threads);
+    volatile int start = 0;
+    for (size_t i = 0; i < 2 * threads; ++i)
+    {
+        jobs[i].queue = &queue;
+        jobs[i].items = items;
+        jobs[i].batch = batch;
+        jobs[i].start = &start;
+        jobs[i].latency = 0;
+        jobs[i].received = 0;
+        pthread_create(&ids[i], NULL, i < threads ? producer<Queue> : consumer<Queue>, &jobs[i]);
+    }
+    uint64_t begin = bench::now();
+    start = 1;
+    for (size_t i = 0; i < 2 * threads; ++i)
+        pthread_join(ids[i], NULL);
+    uint64_t elapsed = bench::now() - begin;
+    uint64_t latency = 0;
+    for (size_t i = threads; i < 2 * threads; ++i)
+        latency += jobs[i].latency;
+    std::cout << name << ',' << threads << ',' << batch << ','
+        << threads * items * 1000.0 / elapsed << ','
+        << latency / 1000.0 / (threads * items) << std::endl;
+};
+
+int main(int argc, char** argv)
+{
+    size_t maxThreads = bench::argSize(argc, argv, 1, 16);
+    size_t items = bench::argSize(argc, argv, 2, 1 << 20);
+    size_t batch = bench::argSize(argc, argv, 3, 16);
+    if (batch < 1 || batch > 64)
+        batch = 16;
+
+    std::cout << "queue,producers,batch,mops,mean_latency_us\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        locked_queue locked;
+        run("mutex_queue", locked, threads, items, batch);
+        ft::mpmc_ring<uint64_t> ring(4096);
+        run("mpmc_ring", ring, threads, items, batch);
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include "vector.hpp"
+#include "parallel.hpp"
+#include "bench_utils.hpp"
+
+// ft::parallel algorithms on one ft::vector<int> with pools of 1 to max_threads
+// threads; a pool of 1 runs the sequential code, so speedups are against it
+// usage: ./bench_parallel [max_threads] [size]
+
+struct scale
+{
+    void operator()(int& x) const
+    {
+        x = x * 3 + 1;
+    };
+};
+
+struct mix
+{
+    int operator()(int x) const
+    {
+        return (x ^ (x >> 7)) * 31;
+    };
+};
+
+struct sum
+{
+    long operator()(long lhs, long rhs) const
+    {
+        return lhs + rhs;
+    };
+};
+
+int main(int argc, char** argv)
+{
+    size_t maxThreads = bench::argSize(argc, argv, 1, 64);
+    size_t size = bench::argSize(argc, argv, 2, 1 << 24);
+
+    ft::vector<int> keys(size);
+    bench::random rng(size);
+    for (size_t i = 0; i < size; ++i)
+        keys[i] = static_cast<int>(rng() >> 33);
+    ft::vector<int> data(keys);
+    ft::vector<int> out(size);
+    double base[5] = { 0, 0, 0, 0, 0 };
+
+    std::cout << "threads,size,sort_ms,for_each_ms,transform_ms,reduce_ms,fill_ms,sort_speedup,for_each_speedup,transform_speedup,reduce_speedup,fill_speedup\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        ft::thread_pool pool(threads);
+        double ms[5];
+        data = keys;
+
+        uint64_t start = bench::now();
+        ft::parallel::sort(data.begin(), data.end(), ft::less<int>(), pool);
+        ms[0] = (bench::now() - start) / 1e6;
+
+        start = bench::now();
+        ft::parallel::for_each(data.begin(), data.end(), scale(), pool);
+        ms[1] = (bench::now() - start) / 1e6;
+
+        start = bench::now();
+        ft::parallel::transform(data.begin(), data.end(), out.begin(), mix(), pool);
+        ms[2] = (bench::now() - start) / 1e6;
+
+        start = bench::now();
+        long total = ft::parallel::reduce(out.begin(), out.end(), 0L, sum(), pool);
+        ms[3] = (bench::now() - start) / 1e6;
+        bench::keep(total);
+
+        start = bench::now();
+        ft::parallel::fill(out.begin(), out.end(), 7, pool);
+        ms[4] = (bench::now() - start) / 1e6;
+
+        if (threads == 1)
+            for (int i = 0; i < 5; ++i)
+                base[i] = ms[i];
+        std::cout << threads << ',' << size;
+        for (int i = 0; i < 5; ++i)
+            std::cout << ',' << ms[i];
+        for (int i = 0; i < 5; ++i)
+            std::cout << ',' << base[i] / ms[i];
+        std::cout << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <vector>
+#include "map.hpp"
+#include "persistent_map.hpp"
+#include "bench_utils.hpp"
+
+// taking a consistent read view of a map that keeps changing: the ft::map copy
+// constructor against ft::persistent_map::snapshot(), and what the path copying
+// costs each update and lookup in exchange
+// usage: ./bench_persistent_map [max_size]
+
+template <class Map>
+struct ops
+{
+    static void assign(Map& map, int key, int value)
+    {
+        map.insert_or_assign(key, value);
+    };
+
+    static Map view(const Map& map)
+    {
+        return map.snapshot();
+    };
+};
+
+template <>
+struct ops<ft::map<int, int> >
+{
+    static void assign(ft::map<int, int>& map, int key, int value)
+    {
+        map[key] = value;
+    };
+
+    static ft::map<int, int> view(const ft::map<int, int>& map)
+    {
+        return map;
+    };
+};
+
+template <class Map>
+void run(const char* name, std::vector<int> const & keys)
+{
+    Map map;
+    for (size_t i = 0; i < keys.size(); ++i)
+        ops<Map>::assign(map, keys[i], static_cast<int>(i));
+    const size_t views = 16;
+    const size_t updates = 1 << 16;
+    size_t total = 0;
+
+    uint64_t start = bench::now();
+    for (size_t i = 0; i < views; ++i)
+    {
+        Map view = ops<Map>::view(map);
+        total += view.size();
+    }
+    uint64_t viewTime = bench::now() - start;
+
+    //updates while a reader holds a view, so shared nodes have to be copied
+    Map held = ops<Map>::view(map);
+    start = bench::now();
+    for (size_t i = 0; i < updates; ++i)
+    {
+        int key = keys[(i * 7919) % keys.size()];
+        if (i & 1)
+            map.erase(key);
+        else
+            ops<Map>::assign(map, key, static_cast<int>(i));
+    }
+    uint64_t updateTime = bench::now() - start;
+
+    start = bench::now();
+    for (size_t i = 0; i < updates; ++i)
+        total += held.count(keys[(i * 104729) % keys.size()]);
+    uint64_t findTime = bench::now() - start;
+    bench::keep(total);
+
+    std::cout << name << ',' << keys.size() << ',' << viewTime / views << ',' << updateTime / updates << ',' << findTime / updates << std::endl;
+};
+
+int main(int argc, char** argv)
+{
+    size_t maxSize = bench::argSize(argc, argv, 1, 1 << 20);
+
+    std::cout << "map,size,view_ns,update_ns,count_ns\n";
+    for (size_t size = 1 << 12; size <= maxSize; size <<= 2)
+    {
+        bench::random rng(size);
+        std::vector<int> keys(size);
+        for (size_t i = 0; i < size; ++i)
+            keys[i] = static_cast<int>(rng() >> 33);
+        run<ft::map<int, int> >("ft::map", keys);
+        run<ft::persistent_map<int, int> >("ft::persistent_map", keys);
+    }
+    return 0;
+}
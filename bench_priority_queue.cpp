@@ -0,0 +1,88 @@
+#include <iostream>
+#include <queue>
+#include <vector>
+#include "priority_queue.hpp"
+#include "vector.hpp"
+#include "bench_utils.hpp"
+
+// ft::priority_queue (4-ary and binary layouts) against std::priority_queue:
+// push all then pop all, O(n) heapify from a range, and a top-K scan with pop_push
+// usage: ./bench_priority_queue [max_size]
+
+template <class Queue>
+struct ops
+{
+    static void replaceTop(Queue& queue, int value)
+    {
+        queue.pop_push(value);
+    };
+};
+
+template <class T, class C, class Cmp>
+struct ops<std::priority_queue<T, C, Cmp> >
+{
+    static void replaceTop(std::priority_queue<T, C, Cmp>& queue, int value)
+    {
+        queue.pop();
+        queue.push(value);
+    };
+};
+
+template <class Queue>
+void run(const char* name, std::vector<int> const & keys)
+{
+    long sum = 0;
+    uint64_t start = bench::now();
+    {
+        Queue queue;
+        for (size_t i = 0; i < keys.size(); ++i)
+            queue.push(keys[i]);
+        while (!queue.empty())
+        {
+            sum += queue.top();
+            queue.pop();
+        }
+    }
+    uint64_t pushPop = bench::now() - start;
+
+    start = bench::now();
+    {
+        Queue queue(keys.begin(), keys.end());
+        sum += queue.top();
+    }
+    uint64_t heapify = bench::now() - start;
+
+    //smallest 1024 keys: a max-heap of the best candidates so far
+    start = bench::now();
+    {
+        Queue queue(keys.begin(), keys.begin() + 1024);
+        for (size_t i = 1024; i < keys.size(); ++i)
+        {
+            if (keys[i] < queue.top())
+                ops<Queue>::replaceTop(queue, keys[i]);
+        }
+        sum += queue.top();
+    }
+    uint64_t topK = bench::now() - start;
+    bench::keep(sum);
+
+    std::cout << name << ',' << keys.size() << ',' << pushPop / 1e6 << ',' << heapify / 1e6 << ',' << topK / 1e6 << std::endl;
+};
+
+int main(int argc, char** argv)
+{
+    size_t maxSize = bench::argSize(argc, argv, 1, 1 << 24);
+
+    std::cout << "queue,size,push_pop_ms,heapify_ms,top1024_ms\n";
+    for (size_t size = 1 << 12; size <= maxSize; size <<= 2)
+    {
+        bench::random rng(size);
+        std::vector<int> keys(size);
+        for (size_t i = 0; i < size; ++i)
+            keys[i] = static_cast<int>(rng() >> 1);
+        run<ft::priority_queue<int> >("ft_4ary", keys);
+        run<ft::priority_queue<int, ft::vector<int>, ft::less<int>, 2> >("ft_binary", keys);
+        run<std::priority_queue<int> >("std", keys);
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include "map.hpp"
+#include "vector.hpp"
+#include "deferred_reclaimer.hpp"
+#include "bench_utils.hpp"
+
+// hot swap of a served container: a fresh one is built off the clock, swapped
+// in, and the old one is disposed of with clear() or with release_async(),
+// either to the shared background reclaimer or to an incremental one that is
+// collected off the clock. Latency of swap plus disposal, in milliseconds.
+// usage: ./bench_release_async [swaps] [size]
+
+void report(const char* name, std::vector<uint64_t>& ns)
+{
+    std::sort(ns.begin(), ns.end());
+    std::cout << name << ',' << ns.size() << ',' << ns[ns.size() / 2] / 1e6 << ',' << ns[ns.size() * 99 / 100] / 1e6 << ',' << ns.back() / 1e6 << std::endl;
+}
+
+template <class Container>
+struct fill;
+
+template <>
+struct fill<ft::map<int, int> >
+{
+    static void run(ft::map<int, int>& map, size_t size, bench::random& rng)
+    {
+        while (map.size() < size)
+            map.insert(ft::make_pair(static_cast<int>(rng() >> 33), 0));
+    };
+};
+
+template <>
+struct fill<ft::vector<std::vector<int> > >
+{
+    static void run(ft::vector<std::vector<int> >& vector, size_t size, bench::random&)
+    {
+        vector.resize(size, std::vector<int>(4));
+    };
+};
+
+template <class Container>
+void run(const char* name, size_t swaps, size_t size, ft::deferred_reclaimer* reclaimer)
+{
+    bench::random rng(size);
+    Container live;
+    fill<Container>::run(live, size, rng);
+    std::vector<uint64_t> ns(swaps);
+    for (size_t i = 0; i < swaps; ++i)
+    {
+        Container next;
+        fill<Container>::run(next, size, rng);
+        uint64_t start = bench::now();
+        live.swap(next);
+        if (reclaimer)
+            ft::release_async(next, *reclaimer);
+        else
+            next.clear();
+        ns[i] = bench::now() - start;
+        if (reclaimer)
+            reclaimer->collect(size);
+    }
+    if (reclaimer)
+        reclaimer->drain();
+    report(name, ns);
+}
+
+int main(int argc, char** argv)
+{
+    size_t swaps = bench::argSize(argc, argv, 1, 50);
+    size_t size = bench::argSize(argc, argv, 2, 1 << 18);
+
+    ft::deferred_reclaimer& background = ft::deferred_reclaimer::shared();
+    ft::deferred_reclaimer incremental(false);
+
+    std::cout << "disposal,swaps,p50_ms,p99_ms,max_ms\n";
+    run<ft::map<int, int> >("map_clear", swaps, size, NULL);
+    run<ft::map<int, int> >("map_release_async_background", swaps, size, &background);
+    run<ft::map<int, int> >("map_release_async_incremental", swaps, size, &incremental);
+    run<ft::vector<std::vector<int> > >("vector_clear", swaps, size, NULL);
+    run<ft::vector<std::vector<int> > >("vector_release_async_background", swaps, size, &background);
+    run<ft::vector<std::vector<int> > >("vector_release_async_incremental", swaps, size, &incremental);
+    return 0;
+}
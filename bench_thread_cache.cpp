@@ -0,0 +1,79 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include "map.hpp"
+#include "thread_cache_allocator.hpp"
+#include "concurrency.hpp"
+#include "bench_utils.hpp"
+
+// map churn: every thread fills its own ft::map<int, int> with random keys and
+// erases them again, round after round, so nearly all the time goes to
+// RBtree::createNode/destroyNode. ops/sec with std::allocator against
+// ft::thread_cache_allocator for 1 to max_threads threads.
+// usage: ./bench_thread_cache [max_threads] [ops_per_thread] [map_size]
+
+struct job
+{
+    size_t ops;
+    size_t size;
+    unsigned seed;
+    volatile int* start;
+};
+
+template <class Alloc>
+void* worker(void* arg)
+{
+    job* j = static_cast<job*>(arg);
+    bench::random rng(j->seed);
+    ft::map<int, int, ft::less<int>, Alloc> map;
+    std::vector<int> keys(j->size);
+    while (!*j->start)
+        ft::cpu_relax();
+    for (size_t done = 0; done < j->ops; done += 2 * j->size)
+    {
+        for (size_t i = 0; i < j->size; ++i)
+        {
+            keys[i] = static_cast<int>(rng() >> 33);
+            map.insert(ft::make_pair(keys[i], static_cast<int>(i)));
+        }
+        for (size_t i = 0; i < j->size; ++i)
+            map.erase(keys[i]);
+    }
+    bench::keep(map.size());
+    return NULL;
+};
+
+template <class Alloc>
+double run(size_t threads, size_t ops, size_t size)
+{
+    std::vector<pthread_t> ids(threads);
+    std::vector<job> jobs(threads);
+    volatile int start = 0;
+    for (size_t t = 0; t < threads; ++t)
+    {
+        job j = { ops, size, static_cast<unsigned>(t + 1), &start };
+        jobs[t] = j;
+        pthread_create(&ids[t], NULL, worker<Alloc>, &jobs[t]);
+    }
+    uint64_t begin = bench::now();
+    start = 1;
+    for (size_t t = 0; t < threads; ++t)
+        pthread_join(ids[t], NULL);
+    return threads * ops / ((bench::now() - begin) / 1e9);
+};
+
+int main(int argc, char** argv)
+{
+    size_t maxThreads = bench::argSize(argc, argv, 1, 8);
+    size_t ops = bench::argSize(argc, argv, 2, 1 << 21);
+    size_t size = bench::argSize(argc, argv, 3, 1 << 12);
+
+    std::cout << "threads,std_allocator_ops_s,thread_cache_ops_s,speedup\n";
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        double plain = run<std::allocator<ft::pair<const int, int> > >(threads, ops, size);
+        double cached = run<ft::thread_cache_allocator<ft::pair<const int, int> > >(threads, ops, size);
+        std::cout << threads << ',' << plain << ',' << cached << ',' << cached / plain << std::endl;
+    }
+    return 0;
+}
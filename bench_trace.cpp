@@ -0,0 +1,196 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <stack>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cstring>
+#include <stdlib.h>
+#include "vector.hpp"
+#include "stack.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "workload_trace.hpp"
+#include "bench_utils.hpp"
+
+// Records the seeded workload of main.cpp (scaled down to count elements and
+// on int payloads) as a trace, and replays a trace against the ft:: or std::
+// containers, timing every operation: throughput and latency percentiles per
+// container and operation, CSV on stdout. Each timed op includes one clock read.
+// usage: ./bench_trace record <seed> <count> <file>
+//        ./bench_trace replay <file> [ft|std]
+
+/*record*/
+//runs the operations on ft containers and writes each one with the size it left
+class recorder
+{
+    bench::trace_writer _writer;
+    ft::vector<int> _vector;
+    ft::stack<int> _stack;
+    ft::map<int, int> _map;
+    ft::set<int> _set;
+
+    public:
+        explicit recorder(std::ostream& out): _writer(out) {};
+
+        void vector(bench::trace_op op, int key)
+        {
+            if (op == bench::opPush)
+                this->_vector.push_back(key);
+            else if (op == bench::opAt)
+                bench::keep(this->_vector[static_cast<unsigned>(key) % this->_vector.size()]);
+            else if (op == bench::opClear)
+                this->_vector.clear();
+            this->_writer.record(bench::traceVector, op, key, this->_vector.size());
+        };
+
+        void stack(bench::trace_op op, int key)
+        {
+            if (op == bench::opPush)
+                this->_stack.push(key);
+            else if (op == bench::opPop)
+                this->_stack.pop();
+            this->_writer.record(bench::traceStack, op, key, this->_stack.size());
+        };
+
+        void map(bench::trace_op op, int key)
+        {
+            if (op == bench::opInsert)
+                this->_map.insert(ft::make_pair(key, key));
+            else if (op == bench::opAt)
+                bench::keep(this->_map[key]);
+            else if (op == bench::opFind)
+                bench::keep(this->_map.find(key) != this->_map.end());
+            else if (op == bench::opCopy)
+                bench::keep(ft::map<int, int>(this->_map).size());
+            this->_writer.record(bench::traceMap, op, key, this->_map.size());
+        };
+
+        void set(bench::trace_op op, int key)
+        {
+            if (op == bench::opInsert)
+                this->_set.insert(key);
+            else if (op == bench::opFind)
+                bench::keep(this->_set.find(key) != this->_set.end());
+            else if (op == bench::opErase)
+                this->_set.erase(key);
+            this->_writer.record(bench::traceSet, op, key, this->_set.size());
+        };
+};
+
+int record(int seed, int count, const char* file)
+{
+    if (count <= 0)
+    {
+        std::cerr << "count must be positive" << std::endl;
+        return 1;
+    }
+    std::ofstream out(file);
+    if (!out)
+    {
+        std::cerr << "cannot write " << file << std::endl;
+        return 1;
+    }
+    srand(seed);
+    recorder r(out);
+    for (int i = 0; i < count; ++i)
+        r.vector(bench::opPush, i);
+    for (int i = 0; i < count; ++i)
+        r.vector(bench::opAt, rand() % count);
+    r.vector(bench::opClear, 0);
+    for (int i = 0; i < count; ++i)
+        r.map(bench::opInsert, rand());
+    for (int i = 0; i < 10000; ++i)
+        r.map(bench::opAt, rand());
+    for (int i = 0; i < count; ++i)
+        r.map(bench::opFind, rand());
+    r.map(bench::opCopy, 0);
+    for (char letter = 'a'; letter <= 'z'; ++letter)
+        r.stack(bench::opPush, letter);
+    for (char letter = 'a'; letter <= 'z'; ++letter)
+        r.stack(bench::opPop, 0);
+    for (int i = 0; i < count; ++i)
+        r.set(bench::opInsert, rand() % count);
+    for (int i = 0; i < count; ++i)
+        r.set(bench::opFind, rand() % count);
+    for (int i = 0; i < count; ++i)
+        r.set(bench::opErase, rand() % count);
+    return 0;
+}
+
+/*replay*/
+template <class Replayer>
+int replay(const std::vector<bench::trace_entry>& entries, const char* library)
+{
+    Replayer replayer;
+    std::vector<uint64_t> ns[bench::traceTypes][bench::traceOps];
+    for (size_t i = 0; i < entries.size(); ++i)
+        ns[entries[i].type][entries[i].op].push_back(0);
+    //reserved up front so growing the sample arrays does not land in the timings
+    for (int t = 0; t < bench::traceTypes; ++t)
+        for (int o = 0; o < bench::traceOps; ++o)
+        {
+            ns[t][o].reserve(ns[t][o].size());
+            ns[t][o].clear();
+        }
+    size_t mismatches = 0;
+    uint64_t start = bench::now();
+    uint64_t last = start;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const bench::trace_entry& e = entries[i];
+        size_t size = replayer.apply(e);
+        uint64_t now = bench::now();
+        ns[e.type][e.op].push_back(now - last);
+        last = now;
+        mismatches += size != e.size;
+    }
+    double total = (last - start) / 1e6;
+    bench::keep(replayer.sink());
+
+    std::cout << "library,type,op,count,total_ms,mops_s,p50_ns,p99_ns,p999_ns,max_ns\n";
+    for (int t = 0; t < bench::traceTypes; ++t)
+        for (int o = 0; o < bench::traceOps; ++o)
+        {
+            std::vector<uint64_t>& v = ns[t][o];
+            if (v.empty())
+                continue ;
+            double sum = 0;
+            for (size_t i = 0; i < v.size(); ++i)
+                sum += v[i];
+            std::sort(v.begin(), v.end());
+            std::cout << library << ',' << bench::traceTypeNames[t] << ',' << bench::traceOpNames[o] << ',' << v.size() << ',' << sum / 1e6
+                << ',' << v.size() / (sum / 1e3) << ',' << v[v.size() / 2] << ',' << v[v.size() * 99 / 100] << ',' << v[v.size() * 999 / 1000]
+                << ',' << v.back() << std::endl;
+        }
+    std::cerr << library << ": " << entries.size() << " ops in " << total << " ms, " << mismatches << " size mismatches" << std::endl;
+    return mismatches ? 2 : 0;
+}
+
+typedef bench::trace_replayer<ft::vector<int>, ft::stack<int>, ft::map<int, int>, ft::set<int> > ft_replayer;
+typedef bench::trace_replayer<std::vector<int>, std::stack<int>, std::map<int, int>, std::set<int> > std_replayer;
+
+int main(int argc, char** argv)
+{
+    if (argc == 5 && !strcmp(argv[1], "record"))
+        return record(atoi(argv[2]), atoi(argv[3]), argv[4]);
+    if ((argc == 3 || argc == 4) && !strcmp(argv[1], "replay"))
+    {
+        std::ifstream in(argv[2]);
+        std::vector<bench::trace_entry> entries;
+        std::string error;
+        if (!in)
+            error = "cannot read file";
+        if (!in || !bench::readTrace(in, entries, error))
+        {
+            std::cerr << argv[2] << ": " << error << std::endl;
+            return 1;
+        }
+        if (argc == 4 && !strcmp(argv[3], "std"))
+            return replay<std_replayer>(entries, "std");
+        return replay<ft_replayer>(entries, "ft");
+    }
+    std::cerr << "usage: " << argv[0] << " record <seed> <count> <file>\n       " << argv[0] << " replay <file> [ft|std]" << std::endl;
+    return 1;
+}
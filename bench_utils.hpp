@@ -0,0 +1,50 @@
+#ifndef BENCH_UTILS_HPP
+# define BENCH_UTILS_HPP
+
+#include <time.h>
+#include <stdint.h>
+#include <cstdlib>
+
+namespace bench
+{
+    //monotonic wall clock in nanoseconds
+    inline uint64_t now()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+    };
+
+    //keeps the compiler from dropping a computed value
+    template <class T>
+    inline void keep(T const & value)
+    {
+        __asm__ __volatile__("" : : "g"(&value) : "memory");
+    };
+
+    //xorshift, so the key streams do not depend on the libc rand()
+    class random
+    {
+        uint64_t _state;
+
+        public:
+            explicit random(uint64_t seed = 42): _state(seed * 2654435761ULL + 1) {};
+
+            uint64_t operator()()
+            {
+                _state ^= _state << 13;
+                _state ^= _state >> 7;
+                _state ^= _state << 17;
+                return _state;
+            };
+    };
+
+    inline size_t argSize(int argc, char** argv, int index, size_t value)
+    {
+        if (argc > index)
+            return static_cast<size_t>(strtoul(argv[index], NULL, 10));
+        return value;
+    };
+}
+
+#endif
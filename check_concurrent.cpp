@@ -0,0 +1,998 @@
+#include <iostream>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <numeric>
+#include <sched.h>
+#include "concurrent_stack.hpp"
+#include "mpmc_ring.hpp"
+#include "concurrent_map.hpp"
+#include "concurrent_skiplist_map.hpp"
+#include "concurrent_vector.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "deferred_reclaimer.hpp"
+#include "memory_resource.hpp"
+#include "thread_cache_allocator.hpp"
+#include "parallel.hpp"
+#include "concurrency.hpp"
+#include "bench_utils.hpp"
+
+// make check for the concurrent containers: a few threads hammer each one and
+// an invariant that a lost, duplicated or torn element would break is checked
+// afterwards. Prints one line per check and exits with 1 if any failed.
+// usage: ./check_concurrent [threads] [ops_per_thread]
+
+struct check_config
+{
+    size_t threads;
+    size_t ops;
+};
+
+bool report(const char* name, bool ok)
+{
+    std::cout << name << (ok ? ": ok" : ": FAILED") << std::endl;
+    return ok;
+}
+
+//starts every job on its own thread and waits for all of them
+template <class Job>
+void runAll(void* (*work)(void*), std::vector<Job>& jobs)
+{
+    std::vector<pthread_t> ids(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i)
+        pthread_create(&ids[i], NULL, work, &jobs[i]);
+    for (size_t i = 0; i < jobs.size(); ++i)
+        pthread_join(ids[i], NULL);
+}
+
+/*concurrent_stack*/
+struct stack_job
+{
+    ft::concurrent_stack<long>* stack;
+    long first;
+    size_t ops;
+    long pushed;
+    long popped;
+};
+
+//pushes distinct values and pops after every other push
+void* stackWorker(void* arg)
+{
+    stack_job* j = static_cast<stack_job*>(arg);
+    long value;
+    for (size_t i = 0; i < j->ops; ++i)
+    {
+        j->stack->push(j->first + static_cast<long>(i));
+        j->pushed += j->first + static_cast<long>(i);
+        if (i % 2 && j->stack->pop(value))
+            j->popped += value;
+    }
+    return NULL;
+}
+
+//what was popped plus what is left adds up to what was pushed, with and without elimination
+bool checkStack(const check_config& config, size_t eliminationSlots)
+{
+    ft::concurrent_stack<long> stack(eliminationSlots);
+    std::vector<stack_job> jobs(config.threads);
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        stack_job job = { &stack, static_cast<long>(i * config.ops) + 1, config.ops, 0, 0 };
+        jobs[i] = job;
+    }
+    runAll(stackWorker, jobs);
+    long pushed = 0;
+    long popped = 0;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        pushed += jobs[i].pushed;
+        popped += jobs[i].popped;
+    }
+    long value;
+    while (stack.pop(value))
+        popped += value;
+    return pushed == popped && stack.empty();
+}
+
+/*mpmc_ring*/
+struct ring_job
+{
+    ft::mpmc_ring<long>* ring;
+    long first;
+    size_t ops;
+    size_t* consumed;
+    size_t total;
+    size_t count;
+    long sum;
+};
+
+//pushes its values alternately one at a time and in batches of four, waiting while the ring is full
+void* ringProducer(void* arg)
+{
+    ring_job* j = static_cast<ring_job*>(arg);
+    long batch[4];
+    for (size_t i = 0; i < j->ops;)
+    {
+        size_t n = (i / 4 % 2 && i + 4 <= j->ops) ? 4 : 1;
+        for (size_t k = 0; k < n; ++k)
+            batch[k] = j->first + static_cast<long>(i + k);
+        size_t pushed = n == 1 ? j->ring->try_push(batch[0]) : j->ring->try_push_n(batch, n);
+        for (size_t k = 0; k < pushed; ++k)
+        {
+            j->sum += batch[k];
+            ++j->count;
+        }
+        i += pushed;
+        if (pushed < n)
+            sched_yield();
+    }
+    return NULL;
+}
+
+//pops until all producers' values have been taken by some consumer
+void* ringConsumer(void* arg)
+{
+    ring_job* j = static_cast<ring_job*>(arg);
+    long batch[3];
+    while (__atomic_load_n(j->consumed, __ATOMIC_RELAXED) < j->total)
+    {
+        size_t popped = j->ring->try_pop_n(batch, 3);
+        for (size_t k = 0; k < popped; ++k)
+            j->sum += batch[k];
+        j->count += popped;
+        __atomic_add_fetch(j->consumed, popped, __ATOMIC_RELAXED);
+        if (!popped)
+            sched_yield();
+    }
+    return NULL;
+}
+
+//half the threads produce, half consume through a small ring that keeps filling up and running dry
+bool checkRing(const check_config& config)
+{
+    ft::mpmc_ring<long> ring(64);
+    size_t producers = config.threads / 2 ? config.threads / 2 : 1;
+    size_t consumers = config.threads - producers ? config.threads - producers : 1;
+    size_t consumed = 0;
+    std::vector<ring_job> jobs(producers + consumers);
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        ring_job job = { &ring, static_cast<long>(i * config.ops) + 1, config.ops, &consumed, producers * config.ops, 0, 0 };
+        jobs[i] = job;
+    }
+    std::vector<pthread_t> ids(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i)
+        pthread_create(&ids[i], NULL, i < producers ? ringProducer : ringConsumer, &jobs[i]);
+    for (size_t i = 0; i < jobs.size(); ++i)
+        pthread_join(ids[i], NULL);
+    size_t pushedCount = 0;
+    size_t poppedCount = 0;
+    long pushedSum = 0;
+    long poppedSum = 0;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        (i < producers ? pushedCount : poppedCount) += jobs[i].count;
+        (i < producers ? pushedSum : poppedSum) += jobs[i].sum;
+    }
+    long value;
+    return pushedCount == producers * config.ops && poppedCount == pushedCount && poppedSum == pushedSum
+        && !ring.try_pop(value) && ring.size() == 0;
+}
+
+/*concurrent_map*/
+template <class Map>
+struct map_job
+{
+    Map* map;
+    long thread;
+    long threads;
+    size_t ops;
+};
+
+struct add_one
+{
+    void operator()(long& value) const
+    {
+        ++value;
+    };
+};
+
+//thread t owns the keys t, t + threads, ...: inserts them, erases every other one and
+//doubles the rest, bumping a counter under key -1 shared by all threads on each step
+template <class Map>
+void* mapWorker(void* arg)
+{
+    map_job<Map>* j = static_cast<map_job<Map>*>(arg);
+    for (size_t i = 0; i < j->ops; ++i)
+    {
+        long key = j->thread + static_cast<long>(i) * j->threads;
+        j->map->insert(ft::make_pair(key, key));
+        j->map->update(-1, add_one());
+    }
+    for (size_t i = 0; i < j->ops; ++i)
+    {
+        long key = j->thread + static_cast<long>(i) * j->threads;
+        if (i % 2)
+            j->map->erase(key);
+        else
+            j->map->insert_or_assign(key, key * 2);
+    }
+    return NULL;
+}
+
+//for_each_range visitor: counts the elements, checks their values and, if the map is ordered, their order
+struct map_visit
+{
+    size_t* count;
+    long* last;
+    bool* ok;
+    bool ordered;
+
+    void operator()(const ft::pair<const long, long>& value) const
+    {
+        if (value.second != value.first * 2)
+            *this->ok = false;
+        if (this->ordered && value.first <= *this->last)
+            *this->ok = false;
+        *this->last = value.first;
+        ++*this->count;
+    };
+};
+
+//every surviving key holds its doubled value, the erased ones are gone and the shared counter lost no update
+template <class Map>
+bool checkMap(const check_config& config, const typename Map::partition_type& partition)
+{
+    Map map(partition);
+    map.insert(ft::make_pair(-1L, 0L));
+    std::vector<map_job<Map> > jobs(config.threads);
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        map_job<Map> job = { &map, static_cast<long>(i), static_cast<long>(config.threads), config.ops };
+        jobs[i] = job;
+    }
+    runAll(mapWorker<Map>, jobs);
+    bool ok = true;
+    long counter = 0;
+    size_t count = 0;
+    long last = -1;
+    map_visit visit = { &count, &last, &ok, partition.ordered() };
+    map.for_each_range(0, static_cast<long>(config.threads * config.ops), visit);
+    for (long key = 0; key < static_cast<long>(config.threads * config.ops) && ok; ++key)
+        ok = map.count(key) == static_cast<size_t>(key / static_cast<long>(config.threads) % 2 == 0);
+    return ok && map.find(-1, counter) && counter == static_cast<long>(config.threads * config.ops)
+        && count == config.threads * ((config.ops + 1) / 2) && map.size() == count + 1;
+}
+
+//a comparator with state, so a default-constructed one orders differently
+struct key_order
+{
+    bool reverse;
+
+    key_order(bool reverse = false): reverse(reverse) {};
+
+    bool operator()(long x, long y) const
+    {
+        return this->reverse ? y < x : x < y;
+    };
+};
+
+//for_each_range visitor: keys must come strictly descending
+struct descending_visit
+{
+    size_t* count;
+    long* last;
+    bool* ok;
+
+    void operator()(const ft::pair<const long, long>& value) const
+    {
+        if (value.first >= *this->last || value.second != value.first * 2)
+            *this->ok = false;
+        *this->last = value.first;
+        ++*this->count;
+    };
+};
+
+//a descending map: the shards and for_each_range have to use the comparator the map was given
+bool checkMapComparator(const check_config& config)
+{
+    typedef ft::range_partition<long, key_order> partition;
+    long n = static_cast<long>(config.ops);
+    long bounds[] = { 2 * n / 3, n / 3 };
+    ft::concurrent_map<long, long, partition, key_order> map(partition(bounds, bounds + 2, key_order(true)), key_order(true));
+    for (long key = 0; key < n; ++key)
+        map.insert(ft::make_pair(key, key * 2));
+    bool ok = true;
+    size_t count = 0;
+    long last = n;
+    descending_visit visit = { &count, &last, &ok };
+    map.for_each_range(n - 10, 10, visit);
+    size_t none = 0;
+    descending_visit nothing = { &none, &last, &ok };
+    map.for_each_range(10, n - 10, nothing);
+    return ok && count == static_cast<size_t>(n - 20) && none == 0 && map.key_comp().reverse && map.size() == static_cast<size_t>(n);
+}
+
+/*concurrent_skiplist_map*/
+typedef ft::concurrent_skiplist_map<long, long> skiplist_type;
+
+struct skiplist_job
+{
+    skiplist_type* map;
+    bench::random rng;
+    size_t ops;
+    long range;
+    long net;
+    bool ordered;
+    bool found;
+};
+
+//a lookup through both find overloads and the bounds, all while other threads erase around it
+bool skiplistLookup(const skiplist_type& map, long key)
+{
+    long value;
+    bool ok = !map.find(key, value) || value == key * 3;
+    skiplist_type::guard g(map);
+    skiplist_type::const_iterator it = map.find(key, g);
+    skiplist_type::const_iterator lower = map.lower_bound(key, g);
+    skiplist_type::const_iterator upper = map.upper_bound(key, g);
+    ok &= it == map.end() || (it->first == key && it->second == key * 3);
+    ok &= lower == map.end() || (lower->first >= key && lower->second == lower->first * 3);
+    ok &= upper == map.end() || (upper->first > key && upper->second == upper->first * 3);
+    return ok;
+}
+
+//walks the map under a guard; false if two keys are out of order or a value was torn
+bool skiplistOrdered(const skiplist_type& map, size_t* count)
+{
+    skiplist_type::guard g(map);
+    long last = -1;
+    *count = 0;
+    for (skiplist_type::const_iterator it = map.begin(g); it != map.end(); ++it, ++*count)
+    {
+        if (it->first <= last || it->second != it->first * 3)
+            return false;
+        last = it->first;
+    }
+    return true;
+}
+
+//inserts and erases random keys of a range all threads share, keeping count of the
+//ones that succeeded, and checks the ordering every so often while the others write
+void* skiplistWorker(void* arg)
+{
+    skiplist_job* j = static_cast<skiplist_job*>(arg);
+    size_t count;
+    for (size_t i = 0; i < j->ops; ++i)
+    {
+        uint64_t r = j->rng();
+        long key = static_cast<long>((r >> 1) % static_cast<uint64_t>(j->range));
+        if (r & 1)
+            j->net += j->map->insert(ft::make_pair(key, key * 3)).second;
+        else
+            j->net -= static_cast<long>(j->map->erase(key));
+        if (i % 8 == 0 && !skiplistLookup(*j->map, key ^ 1))
+            j->found = false;
+        if (i % 4096 == 0 && !skiplistOrdered(*j->map, &count))
+            j->ordered = false;
+    }
+    return NULL;
+}
+
+//keys come out strictly ascending, during the churn and after it, lookups only see whole elements,
+//and size() is the net number of inserts
+bool checkSkiplist(const check_config& config)
+{
+    skiplist_type map;
+    std::vector<skiplist_job> jobs(config.threads);
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        skiplist_job job = { &map, bench::random(i + 1), config.ops, static_cast<long>(config.ops / 2 + 1), 0, true, true };
+        jobs[i] = job;
+    }
+    runAll(skiplistWorker, jobs);
+    bool ok = true;
+    long net = 0;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        ok &= jobs[i].ordered && jobs[i].found;
+        net += jobs[i].net;
+    }
+    size_t count;
+    ok &= skiplistOrdered(map, &count);
+    return ok && static_cast<long>(count) == net && map.size() == count;
+}
+
+/*concurrent_vector*/
+struct vector_claim
+{
+    size_t first;
+    size_t n;
+    long* address;
+};
+
+struct vector_job
+{
+    ft::concurrent_vector<long>* vector;
+    long thread;
+    size_t ops;
+    std::vector<vector_claim> claims;
+};
+
+//appends runs of 1 to 9 elements, every run tagged with its thread and number, and
+//remembers where each one landed and the address of its first element
+void* vectorWorker(void* arg)
+{
+    vector_job* j = static_cast<vector_job*>(arg);
+    for (size_t i = 0; i < j->ops; ++i)
+    {
+        long tag = j->thread * static_cast<long>(j->ops) + static_cast<long>(i);
+        vector_claim claim = { 0, i % 9 + 1, NULL };
+        claim.first = claim.n == 1 ? j->vector->push_back(tag) : j->vector->grow_by(claim.n, tag);
+        claim.address = &(*j->vector)[claim.first];
+        j->claims.push_back(claim);
+    }
+    return NULL;
+}
+
+//the runs tile [0, size()) with no index claimed twice, each holds its own tag, and no element moved
+bool checkVector(const check_config& config)
+{
+    ft::concurrent_vector<long> vector;
+    std::vector<vector_job> jobs(config.threads);
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        jobs[i].vector = &vector;
+        jobs[i].thread = static_cast<long>(i);
+        jobs[i].ops = config.ops;
+    }
+    runAll(vectorWorker, jobs);
+    std::vector<bool> covered(vector.size(), false);
+    size_t claimed = 0;
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        for (size_t c = 0; c < jobs[i].claims.size(); ++c)
+        {
+            const vector_claim& claim = jobs[i].claims[c];
+            long tag = static_cast<long>(i * config.ops + c);
+            if (claim.first + claim.n > covered.size() || &vector[claim.first] != claim.address)
+                return false;
+            for (size_t k = claim.first; k < claim.first + claim.n; ++k)
+            {
+                if (covered[k] || vector[k] != tag)
+                    return false;
+                covered[k] = true;
+            }
+            claimed += claim.n;
+        }
+    }
+    return claimed == vector.size();
+}
+
+/*deferred_reclaimer*/
+long trackedBytes = 0;
+
+//std::allocator that keeps trackedBytes up to date from any thread, so storage left behind shows up
+template <class T>
+struct tracked_allocator: public std::allocator<T>
+{
+    template <class U>
+    struct rebind
+    {
+        typedef tracked_allocator<U> other;
+    };
+
+    tracked_allocator() {};
+    tracked_allocator(const tracked_allocator&): std::allocator<T>() {};
+    template <class U>
+    tracked_allocator(const tracked_allocator<U>&) {};
+
+    T* allocate(size_t n, const void* = 0)
+    {
+        __atomic_add_fetch(&trackedBytes, static_cast<long>(n * sizeof(T)), __ATOMIC_RELAXED);
+        return std::allocator<T>::allocate(n);
+    };
+
+    void deallocate(T* p, size_t n)
+    {
+        __atomic_sub_fetch(&trackedBytes, static_cast<long>(n * sizeof(T)), __ATOMIC_RELAXED);
+        std::allocator<T>::deallocate(p, n);
+    };
+};
+
+typedef ft::map<long, long, ft::less<long>, tracked_allocator<ft::pair<const long, long> > > tracked_map;
+typedef ft::set<long, ft::less<long>, tracked_allocator<long> > tracked_set;
+typedef ft::vector<long, tracked_allocator<long> > tracked_vector;
+
+template <class Container>
+bool holds(const Container& container, long first, long last)
+{
+    long expected = first;
+    for (typename Container::const_iterator it = container.begin(); it != container.end(); ++it, ++expected)
+        if (*it != expected)
+            return false;
+    return expected == last && container.size() == static_cast<size_t>(last - first);
+}
+
+template <class Map>
+bool holdsMap(const Map& map, long first, long last)
+{
+    long expected = first;
+    for (typename Map::const_iterator it = map.begin(); it != map.end(); ++it, ++expected)
+        if (it->first != expected || it->second != -expected)
+            return false;
+    return expected == last && map.size() == static_cast<size_t>(last - first);
+}
+
+void fill(tracked_map& map, tracked_set& set, tracked_vector& vector, long first, long last)
+{
+    for (long i = first; i < last; ++i)
+    {
+        map.insert(ft::make_pair(i, -i));
+        set.insert(i);
+        vector.push_back(i);
+    }
+}
+
+// Retires a map, a set and a vector, twice: once drained, once left to the
+// reclaimer's destructor. After release_async the containers are empty and take
+// new elements; once the reclaimer is done every retired byte is given back.
+bool checkReclaimer(const check_config& config, bool background)
+{
+    bool ok = true;
+    long n = static_cast<long>(config.ops);
+    long baseline = __atomic_load_n(&trackedBytes, __ATOMIC_RELAXED);
+    {
+        tracked_map map;
+        tracked_set set;
+        tracked_vector vector;
+        long empty = __atomic_load_n(&trackedBytes, __ATOMIC_RELAXED);
+        {
+            ft::deferred_reclaimer reclaimer(background);
+            fill(map, set, vector, 0, n);
+            ft::release_async(map, reclaimer);
+            ft::release_async(set, reclaimer);
+            ft::release_async(vector, reclaimer);
+            ok &= map.empty() && set.empty() && vector.empty() && map.begin() == map.end() && set.begin() == set.end();
+            if (!background)
+                ok &= n < 2 || !reclaimer.collect(1);
+            reclaimer.drain();
+            ok &= reclaimer.pending() == 0 && __atomic_load_n(&trackedBytes, __ATOMIC_RELAXED) == empty;
+            fill(map, set, vector, n, 2 * n);
+            ok &= holdsMap(map, n, 2 * n) && holds(set, n, 2 * n) && holds(vector, n, 2 * n);
+            ft::release_async(map, reclaimer);
+            ft::release_async(set, reclaimer);
+            ft::release_async(vector, reclaimer);
+        }
+        ok &= __atomic_load_n(&trackedBytes, __ATOMIC_RELAXED) == empty;
+        fill(map, set, vector, 0, 3);
+        ok &= holdsMap(map, 0, 3) && holds(set, 0, 3) && holds(vector, 0, 3);
+    }
+    return ok && __atomic_load_n(&trackedBytes, __ATOMIC_RELAXED) == baseline;
+}
+
+/*thread_cache_allocator*/
+typedef ft::map<long, long, ft::less<long>, ft::thread_cache_allocator<ft::pair<const long, long> > > cached_map;
+
+struct cache_job
+{
+    cached_map* map;
+    long count;
+    std::vector<const void*>* nodes;
+    bool ok;
+};
+
+//fills the map and records, if asked, where its elements live
+void* cacheFill(void* arg)
+{
+    cache_job* j = static_cast<cache_job*>(arg);
+    for (long i = 0; i < j->count; ++i)
+        j->map->insert(ft::make_pair(i, -i));
+    j->ok = holdsMap(*j->map, 0, j->count);
+    if (j->nodes)
+        for (cached_map::const_iterator it = j->map->begin(); it != j->map->end(); ++it)
+            j->nodes->push_back(&*it);
+    return NULL;
+}
+
+//frees every node on a thread other than the one that allocated it
+void* cacheErase(void* arg)
+{
+    cache_job* j = static_cast<cache_job*>(arg);
+    j->ok = holdsMap(*j->map, 0, j->count);
+    for (long i = 0; i < j->count; ++i)
+        j->ok &= j->map->erase(i) == 1;
+    j->ok &= j->map->empty();
+    return NULL;
+}
+
+// One thread fills a map and exits, another erases it and exits: the eraser's
+// list overflows and goes back to the pool a batch at a time, and what both
+// threads still hold is handed back when they exit. A third thread filling the
+// same number of keys must then be served entirely from the freed nodes.
+bool checkThreadCache(const check_config& config)
+{
+    cached_map map;
+    std::vector<const void*> nodes;
+    long count = static_cast<long>(config.ops);
+    std::vector<cache_job> jobs(1);
+    cache_job fill = { &map, count, &nodes, false };
+    jobs[0] = fill;
+    runAll(cacheFill, jobs);
+    bool ok = jobs[0].ok;
+    jobs[0].ok = false;
+    runAll(cacheErase, jobs);
+    ok &= jobs[0].ok;
+    jobs[0].nodes = NULL;
+    runAll(cacheFill, jobs);
+    ok &= jobs[0].ok;
+    std::sort(nodes.begin(), nodes.end());
+    for (cached_map::const_iterator it = map.begin(); it != map.end(); ++it)
+        ok &= std::binary_search(nodes.begin(), nodes.end(), static_cast<const void*>(&*it));
+    return ok;
+}
+
+/*memory resources*/
+//over-aligned, so the vector's buffers need alignments above maxAlign
+struct wide
+{
+    long value;
+} __attribute__((aligned(32)));
+
+typedef ft::map<long, long, ft::less<long>, ft::polymorphic_allocator<ft::pair<const long, long> > > resource_map;
+typedef ft::set<long, ft::less<long>, ft::polymorphic_allocator<long> > resource_set;
+typedef ft::vector<wide, ft::polymorphic_allocator<wide> > resource_vector;
+
+bool aligned(const void* p)
+{
+    return reinterpret_cast<uintptr_t>(p) % __alignof__(wide) == 0;
+}
+
+bool sameMap(const resource_map& map, const std::map<long, long>& expected)
+{
+    if (map.size() != expected.size())
+        return false;
+    std::map<long, long>::const_iterator it = expected.begin();
+    for (resource_map::const_iterator node = map.begin(); node != map.end(); ++node, ++it)
+        if (node->first != it->first || node->second != it->second)
+            return false;
+    return true;
+}
+
+bool sameSet(const resource_set& set, const std::set<long>& expected)
+{
+    return set.size() == expected.size() && std::equal(expected.begin(), expected.end(), set.begin());
+}
+
+bool sameVector(const resource_vector& vector, const std::vector<long>& expected)
+{
+    if (vector.size() != expected.size())
+        return false;
+    for (size_t i = 0; i < vector.size(); ++i)
+        if (vector[i].value != expected[i] || !aligned(&vector[i]))
+            return false;
+    return true;
+}
+
+// Random inserts and erases on a map, a set and a vector drawing from resource,
+// mirrored on the std containers. The vector outgrows max_block, so its buffers
+// go through the oversized path once they are big enough.
+bool fillResource(ft::memory_resource& resource, size_t n, uint64_t seed)
+{
+    bench::random rng(seed);
+    resource_map map(ft::less<long>(), &resource);
+    resource_set set(ft::less<long>(), &resource);
+    resource_vector vector(&resource);
+    std::map<long, long> expectedMap;
+    std::set<long> expectedSet;
+    std::vector<long> expectedVector;
+    for (size_t i = 0; i < n; ++i)
+    {
+        long key = static_cast<long>(rng() % (n / 2 + 1));
+        wide w = { key * 3 };
+        if (rng() % 4)
+        {
+            map.insert(ft::make_pair(key, key * 3));
+            expectedMap.insert(std::make_pair(key, key * 3));
+            set.insert(key);
+            expectedSet.insert(key);
+        }
+        else
+        {
+            map.erase(key);
+            expectedMap.erase(key);
+            set.erase(key);
+            expectedSet.erase(key);
+        }
+        vector.push_back(w);
+        expectedVector.push_back(key * 3);
+    }
+    vector.erase(vector.begin() + n / 3, vector.end());
+    expectedVector.erase(expectedVector.begin() + n / 3, expectedVector.end());
+    return sameMap(map, expectedMap) && sameSet(set, expectedSet) && sameVector(vector, expectedVector);
+}
+
+// merge and append between containers on different resources copy the elements,
+// so they must still be there once the source resource has released everything
+bool checkUnequalResources(ft::memory_resource& resource, size_t n)
+{
+    resource_map map(ft::less<long>(), &resource);
+    resource_set set(ft::less<long>(), &resource);
+    std::map<long, long> expectedMap;
+    std::set<long> expectedSet;
+    for (long i = 0; i < static_cast<long>(n); i += 2)
+    {
+        map.insert(ft::make_pair(i, i));
+        set.insert(i);
+        expectedMap.insert(std::make_pair(i, i));
+        expectedSet.insert(i);
+    }
+    bool ok = true;
+    {
+        ft::monotonic_buffer_resource other;
+        resource_map mergedMap(ft::less<long>(), &other);
+        resource_set mergedSet(ft::less<long>(), &other);
+        resource_map appendedMap(ft::less<long>(), &other);
+        resource_set appendedSet(ft::less<long>(), &other);
+        for (long i = 0; i < static_cast<long>(n); i += 3)
+        {
+            mergedMap.insert(ft::make_pair(i, i));
+            mergedSet.insert(i);
+            expectedMap.insert(std::make_pair(i, i));
+            expectedSet.insert(i);
+        }
+        for (long i = static_cast<long>(n); i < static_cast<long>(2 * n); ++i)
+        {
+            appendedMap.insert(ft::make_pair(i, i));
+            appendedSet.insert(i);
+            expectedMap.insert(std::make_pair(i, i));
+            expectedSet.insert(i);
+        }
+        map.merge(mergedMap);
+        set.merge(mergedSet);
+        map.append(appendedMap);
+        set.append(appendedSet);
+        ok &= appendedMap.empty() && appendedSet.empty();
+        ok &= mergedMap.size() == (n + 5) / 6 && mergedSet.size() == (n + 5) / 6;
+        mergedMap.clear();
+        mergedSet.clear();
+        other.release();
+    }
+    return ok && sameMap(map, expectedMap) && sameSet(set, expectedSet);
+}
+
+// Containers on a monotonic buffer that starts in a caller's buffer and on a pool,
+// against std. release() rewinds the monotonic resource to the start of its buffer
+// and leaves both resources ready for another round.
+bool checkResources(const check_config& config)
+{
+    size_t n = config.ops / 4 + 17;
+    static char buffer[1 << 12] __attribute__((aligned(32)));
+    ft::monotonic_buffer_resource monotonic(buffer, sizeof(buffer));
+    ft::unsynchronized_pool_resource pool;
+    bool ok = true;
+    for (uint64_t round = 1; round <= 2; ++round)
+    {
+        ok &= fillResource(monotonic, n, round) && fillResource(pool, n, round + 2);
+        ok &= fillResource(*ft::new_delete_resource(), n, round + 4);
+        ok &= checkUnequalResources(monotonic, n) && checkUnequalResources(pool, n);
+        monotonic.release();
+        pool.release();
+        ok &= monotonic.allocate(1, 1) == buffer;
+        void* wideBlock = monotonic.allocate(sizeof(wide), __alignof__(wide));
+        void* oversized = pool.allocate(2 * ft::unsynchronized_pool_resource::max_block(), 4 * sizeof(wide));
+        ok &= wideBlock == buffer + __alignof__(wide) && aligned(oversized);
+        pool.deallocate(oversized, 2 * ft::unsynchronized_pool_resource::max_block(), 4 * sizeof(wide));
+        monotonic.release();
+    }
+    return ok;
+}
+
+/*parallel algorithms*/
+//a sort key with the input position as payload, so an unstable sort shows
+struct keyed
+{
+    int key;
+    int order;
+};
+
+struct by_key
+{
+    bool operator()(const keyed& x, const keyed& y) const
+    {
+        return x.key < y.key;
+    };
+};
+
+//x -> a * x + b; composition is associative but does not commute, so reduce must keep the order
+struct affine
+{
+    uint64_t a;
+    uint64_t b;
+};
+
+struct compose
+{
+    affine operator()(const affine& f, const affine& g) const
+    {
+        affine res = { f.a * g.a, f.a * g.b + f.b };
+        return res;
+    };
+};
+
+struct triple_plus_one
+{
+    long operator()(long x) const
+    {
+        return 3 * x + 1;
+    };
+};
+
+struct increment
+{
+    void operator()(long& x) const
+    {
+        ++x;
+    };
+};
+
+//parallel::sort against std::stable_sort, with few distinct keys so most of them tie
+bool checkSort(ft::thread_pool& pool, size_t n)
+{
+    bench::random rng(n + 1);
+    ft::vector<keyed> values;
+    for (size_t i = 0; i < n; ++i)
+    {
+        keyed k = { static_cast<int>(rng() % (n / 8 + 2)), static_cast<int>(i) };
+        values.push_back(k);
+    }
+    std::vector<keyed> expected(values.begin(), values.end());
+    std::stable_sort(expected.begin(), expected.end(), by_key());
+    ft::parallel::sort(values.begin(), values.end(), by_key(), pool);
+    for (size_t i = 0; i < n; ++i)
+        if (values[i].key != expected[i].key || values[i].order != expected[i].order)
+            return false;
+    ft::vector<long> plain;
+    for (size_t i = 0; i < n; ++i)
+        plain.push_back(static_cast<long>(rng() % 1000) - 500);
+    std::vector<long> sorted(plain.begin(), plain.end());
+    std::sort(sorted.begin(), sorted.end());
+    ft::parallel::sort(plain.begin(), plain.end(), ft::less<long>(), pool);
+    return values.size() == n && std::equal(sorted.begin(), sorted.end(), plain.begin());
+}
+
+//reduce, transform, for_each and fill against the serial loops
+bool checkAlgorithms(ft::thread_pool& pool, size_t n)
+{
+    bench::random rng(n + 2);
+    ft::vector<long> values;
+    ft::vector<affine> maps;
+    for (size_t i = 0; i < n; ++i)
+    {
+        values.push_back(static_cast<long>(rng() % 1000));
+        affine f = { rng() | 1, rng() };
+        maps.push_back(f);
+    }
+    bool ok = ft::parallel::reduce(values.begin(), values.end(), 7L, ft::parallel::plus<long>(), pool) == std::accumulate(values.begin(), values.end(), 7L);
+    affine identity = { 1, 0 };
+    affine serial = identity;
+    for (size_t i = 0; i < n; ++i)
+        serial = compose()(serial, maps[i]);
+    affine reduced = ft::parallel::reduce(maps.begin(), maps.end(), identity, compose(), pool);
+    ok &= reduced.a == serial.a && reduced.b == serial.b;
+    ft::vector<long> out(n);
+    ft::parallel::transform(values.begin(), values.end(), out.begin(), triple_plus_one(), pool);
+    for (size_t i = 0; i < n; ++i)
+        ok &= out[i] == 3 * values[i] + 1;
+    ft::parallel::for_each(out.begin(), out.end(), increment(), pool);
+    for (size_t i = 0; i < n; ++i)
+        ok &= out[i] == 3 * values[i] + 2;
+    ft::parallel::fill(out.begin(), out.end(), -1L, pool);
+    return ok && std::count(out.begin(), out.end(), -1L) == static_cast<std::ptrdiff_t>(n);
+}
+
+//folds an element into the running affine map: x -> (2 * key + 1) * x + value
+struct fold_pair
+{
+    affine operator()(const affine& acc, const ft::pair<const long, long>& value) const
+    {
+        affine f = { static_cast<uint64_t>(2 * value.first + 1), static_cast<uint64_t>(value.second) };
+        return compose()(acc, f);
+    };
+};
+
+struct fold_key
+{
+    affine operator()(const affine& acc, long key) const
+    {
+        affine f = { static_cast<uint64_t>(2 * key + 1), static_cast<uint64_t>(key) };
+        return compose()(acc, f);
+    };
+};
+
+struct bump_mapped
+{
+    void operator()(ft::pair<const long, long>& value) const
+    {
+        ++value.second;
+    };
+};
+
+//counts the visits of each key
+struct count_visit
+{
+    long* visits;
+
+    void operator()(long key) const
+    {
+        __atomic_add_fetch(&this->visits[key], 1, __ATOMIC_RELAXED);
+    };
+};
+
+//reduce and for_each over a map and a set against std::accumulate and a serial walk
+bool checkTreeAlgorithms(ft::thread_pool& pool, size_t n)
+{
+    bench::random rng(n + 3);
+    ft::map<long, long> map;
+    ft::set<long> set;
+    for (size_t i = 0; i < n; ++i)
+    {
+        map.insert(ft::make_pair(static_cast<long>(i), static_cast<long>(rng() % 1000)));
+        set.insert(static_cast<long>(i));
+    }
+    affine identity = { 1, 0 };
+    affine serial = std::accumulate(map.begin(), map.end(), identity, fold_pair());
+    affine reduced = ft::parallel::reduce(map, identity, fold_pair(), compose(), pool);
+    bool ok = reduced.a == serial.a && reduced.b == serial.b;
+    serial = std::accumulate(set.begin(), set.end(), identity, fold_key());
+    reduced = ft::parallel::reduce(set, identity, fold_key(), compose(), pool);
+    ok &= reduced.a == serial.a && reduced.b == serial.b;
+    ok &= ft::parallel::reduce(set, 0L, ft::parallel::plus<long>(), pool) == std::accumulate(set.begin(), set.end(), 0L);
+    ft::map<long, long> before(map);
+    ft::parallel::for_each(map, bump_mapped(), pool);
+    for (ft::map<long, long>::iterator it = map.begin(), old = before.begin(); it != map.end(); ++it, ++old)
+        ok &= it->second == old->second + 1;
+    std::vector<long> visits(n + 1, 0);
+    count_visit counter = { &visits[0] };
+    ft::parallel::for_each(set, counter, pool);
+    return ok && std::count(visits.begin(), visits.end(), 1L) == static_cast<std::ptrdiff_t>(n);
+}
+
+//sizes on both sides of the split grain, on one thread and on several
+bool checkParallel(const check_config& config, bool (*check)(ft::thread_pool&, size_t))
+{
+    size_t grain = static_cast<size_t>(ft::parallel::grainSize);
+    size_t sizes[] = { 0, 1, grain - 1, grain, grain + 1, 5 * grain + 17 };
+    ft::thread_pool single(1);
+    ft::thread_pool several(config.threads);
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+        ok &= check(single, sizes[i]) && check(several, sizes[i]);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    check_config config = { bench::argSize(argc, argv, 1, 4), bench::argSize(argc, argv, 2, 1 << 16) };
+    bool ok = true;
+
+    ok &= report("concurrent_stack sum", checkStack(config, 0));
+    ok &= report("concurrent_stack sum with elimination", checkStack(config, 4));
+    ok &= report("mpmc_ring count and sum", checkRing(config));
+    long bounds[] = { static_cast<long>(config.threads * config.ops / 4), static_cast<long>(config.threads * config.ops / 2) };
+    ok &= report("concurrent_map contents, hash partition", checkMap<ft::concurrent_map<long, long> >(config, ft::hash_partition<long>()));
+    ok &= report("concurrent_map contents, range partition", checkMap<ft::concurrent_map<long, long, ft::range_partition<long> > >(config, ft::range_partition<long>(bounds, bounds + 2)));
+    ok &= report("concurrent_map with a stateful comparator", checkMapComparator(config));
+    ok &= report("concurrent_skiplist_map ordering and size", checkSkiplist(config));
+    ok &= report("concurrent_vector grow_by indices", checkVector(config));
+    ok &= report("deferred_reclaimer, background", checkReclaimer(config, true));
+    ok &= report("deferred_reclaimer, incremental", checkReclaimer(config, false));
+    ok &= report("thread_cache_allocator cross-thread free and reuse", checkThreadCache(config));
+    ok &= report("memory resources against std", checkResources(config));
+    ok &= report("parallel::sort against std::stable_sort", checkParallel(config, checkSort));
+    ok &= report("parallel reduce, transform, for_each and fill", checkParallel(config, checkAlgorithms));
+    ok &= report("parallel reduce and for_each over map and set", checkParallel(config, checkTreeAlgorithms));
+    return ok ? 0 : 1;
+}
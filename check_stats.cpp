@@ -0,0 +1,140 @@
+#include <iostream>
+#include "vector.hpp"
+#include "map.hpp"
+#include "set.hpp"
+#include "deferred_reclaimer.hpp"
+
+#ifndef FT_CONTAINERS_STATS
+# error "check_stats reads the telemetry counters, build it with -DFT_CONTAINERS_STATS"
+#endif
+
+// make check for the telemetry: counters that a known sequence of operations
+// pins down exactly, and the registry totals going back to where they started
+// once the containers are gone. Prints one line per check and exits with 1 if
+// any failed.
+// usage: ./check_stats
+
+bool report(const char* name, bool ok)
+{
+    std::cout << name << (ok ? ": ok" : ": FAILED") << std::endl;
+    return ok;
+}
+
+template <class Set>
+unsigned long long rotationsAfter(const int* keys, size_t n)
+{
+    Set set;
+    for (size_t i = 0; i < n; ++i)
+        set.insert(keys[i]);
+    return set.stats().rotations;
+}
+
+//one rotation for a straight line, two for a zig-zag; ascending keys rotate at 3, 5 and 7
+bool checkRotations()
+{
+    int line[] = { 1, 2, 3 };
+    int zigzag[] = { 3, 1, 2 };
+    int ascending[] = { 1, 2, 3, 4, 5, 6, 7 };
+    int balanced[] = { 4, 2, 6, 1, 3, 5, 7 };
+    unsigned long long before = ft::stats_registry::snapshot().tree_rotations;
+    bool ok = rotationsAfter<ft::set<int> >(line, 3) == 1;
+    ok &= rotationsAfter<ft::set<int> >(zigzag, 3) == 2;
+    ok &= rotationsAfter<ft::set<int> >(ascending, 7) == 3;
+    ok &= rotationsAfter<ft::set<int> >(balanced, 7) == 0;
+    return ok && ft::stats_registry::snapshot().tree_rotations - before == 6;
+}
+
+//a find is one lookup, and a hit in a perfect tree of 7 takes at most 3 levels of comparisons
+bool checkLookups()
+{
+    ft::map<int, int> map;
+    int keys[] = { 4, 2, 6, 1, 3, 5, 7 };
+    for (size_t i = 0; i < 7; ++i)
+        map.insert(ft::make_pair(keys[i], -keys[i]));
+    ft::tree_stats before = map.stats();
+    for (int k = 1; k <= 7; ++k)
+        map.find(k);
+    ft::tree_stats after = map.stats();
+    return after.lookups - before.lookups == 7 && after.comparisons > before.comparisons
+        && after.comparisons - before.comparisons <= 7 * 2 * 3 && after.height == 3;
+}
+
+// push_back from empty doubles the capacity 1, 2, ..., 128 and copies 1 + 2 + ...
+// + 64 elements on the way; reserving first leaves nothing to reallocate
+bool checkReallocations()
+{
+    ft::stats_totals before = ft::stats_registry::snapshot();
+    ft::vector<int> grown;
+    ft::vector<int> reserved;
+    ft::vector<int> incremental;
+    reserved.reserve(100);
+    incremental.set_incremental_growth(true);
+    for (int i = 0; i < 100; ++i)
+    {
+        grown.push_back(i);
+        reserved.push_back(i);
+        incremental.push_back(i);
+    }
+    incremental.settle();
+    ft::vector_stats g = grown.stats();
+    ft::vector_stats r = reserved.stats();
+    ft::vector_stats inc = incremental.stats();
+    bool ok = g.reallocations == 7 && g.bytes_copied == 127 * sizeof(int) && g.capacity == 128;
+    ok &= r.reallocations == 0 && r.bytes_copied == 0 && r.capacity == 100;
+    ok &= inc.reallocations == 7 && inc.bytes_copied == 127 * sizeof(int) && inc.bytes == 128 * sizeof(int);
+    ft::stats_totals after = ft::stats_registry::snapshot();
+    ok &= after.vector_reallocations - before.vector_reallocations == 14;
+    ok &= after.vector_bytes - before.vector_bytes == static_cast<long long>((128 + 100 + 128) * sizeof(int));
+    return ok;
+}
+
+//the registry counts what is allocated now, so clear(), release_async() and destruction bring it back
+bool checkRegistry()
+{
+    ft::stats_totals base = ft::stats_registry::snapshot();
+    bool ok = true;
+    {
+        ft::deferred_reclaimer reclaimer(false);
+        ft::map<int, int> map;
+        ft::set<int> set;
+        ft::vector<int> vector;
+        for (int i = 0; i < 1000; ++i)
+        {
+            map.insert(ft::make_pair(i, i));
+            set.insert(i);
+            vector.push_back(i);
+        }
+        ft::stats_totals full = ft::stats_registry::snapshot();
+        ok &= full.tree_nodes - base.tree_nodes == 2000 && full.vector_bytes > base.vector_bytes;
+        ok &= full.tree_bytes - base.tree_bytes == static_cast<long long>(map.stats().bytes + set.stats().bytes);
+        map.clear();
+        set.clear();
+        ok &= ft::stats_registry::snapshot().tree_nodes == base.tree_nodes;
+        for (int i = 0; i < 1000; ++i)
+        {
+            map.insert(ft::make_pair(i, i));
+            set.insert(i);
+        }
+        ft::release_async(map, reclaimer);
+        ft::release_async(set, reclaimer);
+        ft::release_async(vector, reclaimer);
+        ft::stats_totals released = ft::stats_registry::snapshot();
+        ok &= released.tree_nodes == base.tree_nodes && released.tree_bytes == base.tree_bytes && released.vector_bytes == base.vector_bytes;
+        reclaimer.drain();
+        vector.push_back(1);
+        map.insert(ft::make_pair(1, 1));
+    }
+    ft::stats_totals end = ft::stats_registry::snapshot();
+    return ok && end.tree_nodes == base.tree_nodes && end.tree_bytes == base.tree_bytes && end.vector_bytes == base.vector_bytes;
+}
+
+int main()
+{
+    bool ok = true;
+
+    ok &= report("tree rotations after known inserts", checkRotations());
+    ok &= report("tree lookups and comparisons", checkLookups());
+    ok &= report("vector reallocations, reserve against push_back", checkReallocations());
+    ok &= report("registry back to 0 after clear and release_async", checkRegistry());
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+#ifndef CONCURRENCY_HPP
+# define CONCURRENCY_HPP
+
+#include <pthread.h>
+#include <stdint.h>
+#include <cstring>
+#include <cstddef>
+
+// Building blocks shared by the concurrent containers. The project stays on
+// C++98, so atomics are the GCC/Clang __atomic and __sync builtins and threads
+// are pthreads. Tagged pointers need a double-width CAS: on x86-64 compile
+// with -mcx16.
+
+# define FT_CACHE_LINE 64
+
+namespace ft
+{
+    inline void cpu_relax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        __asm__ __volatile__("yield");
+#endif
+    };
+
+    //per-thread xorshift, seeded from the address of the thread's own state
+    inline unsigned threadRandom()
+    {
+        static __thread unsigned state = 0;
+        if (!state)
+            state = static_cast<unsigned>(reinterpret_cast<uintptr_t>(&state) >> 4) | 1;
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    };
+
+    //pointer plus a counter bumped on every update, so a CAS fails if the
+    //pointer was popped and pushed back in between (ABA)
+    template <class T>
+    struct __attribute__((aligned(16))) tagged_ptr
+    {
+        T* ptr;
+        uintptr_t tag;
+
+        tagged_ptr(): ptr(NULL), tag(0) {};
+
+        tagged_ptr(T* ptr, uintptr_t tag): ptr(ptr), tag(tag) {};
+    };
+
+    //the two halves are read separately; a torn value only makes the next CAS fail
+    template <class T>
+    inline tagged_ptr<T> atomicLoad(tagged_ptr<T> const * src)
+    {
+        tagged_ptr<T> res;
+        res.tag = __atomic_load_n(&src->tag, __ATOMIC_ACQUIRE);
+        res.ptr = __atomic_load_n(&src->ptr, __ATOMIC_ACQUIRE);
+        return res;
+    };
+
+    template <class T>
+    inline bool compareAndSwap(tagged_ptr<T>* dst, tagged_ptr<T> const & expected, tagged_ptr<T> const & desired)
+    {
+        __int128 oldValue;
+        __int128 newValue;
+        std::memcpy(&oldValue, &expected, sizeof(oldValue));
+        std::memcpy(&newValue, &desired, sizeof(newValue));
+        return __sync_bool_compare_and_swap(reinterpret_cast<__int128*>(dst), oldValue, newValue);
+    };
+
+    class mutex
+    {
+        pthread_mutex_t _mutex;
+
+        mutex(mutex const &);
+        mutex& operator=(mutex const &);
+
+        friend class condition_variable;
+
+        public:
+            mutex()
+            {
+                pthread_mutex_init(&this->_mutex, NULL);
+            };
+
+            ~mutex()
+            {
+                pthread_mutex_destroy(&this->_mutex);
+            };
+
+            void lock()
+            {
+                pthread_mutex_lock(&this->_mutex);
+            };
+
+            void unlock()
+            {
+                pthread_mutex_unlock(&this->_mutex);
+            };
+    };
+
+    class condition_variable
+    {
+        pthread_cond_t _cond;
+
+        condition_variable(condition_variable const &);
+        condition_variable& operator=(condition_variable const &);
+
+        public:
+            condition_variable()
+            {
+                pthread_cond_init(&this->_cond, NULL);
+            };
+
+            ~condition_variable()
+            {
+                pthread_cond_destroy(&this->_cond);
+            };
+
+            //lock must be held; it is released while waiting
+            void wait(mutex& lock)
+            {
+                pthread_cond_wait(&this->_cond, &lock._mutex);
+            };
+
+            void notify_one()
+            {
+                pthread_cond_signal(&this->_cond);
+            };
+
+            void notify_all()
+            {
+                pthread_cond_broadcast(&this->_cond);
+            };
+    };
+
+    //many readers or one writer
+    class rw_lock
+    {
+        pthread_rwlock_t _lock;
+
+        rw_lock(rw_lock const &);
+        rw_lock& operator=(rw_lock const &);
+
+        public:
+            rw_lock()
+            {
+                pthread_rwlock_init(&this->_lock, NULL);
+            };
+
+            ~rw_lock()
+            {
+                pthread_rwlock_destroy(&this->_lock);
+            };
+
+            void lock()
+            {
+                pthread_rwlock_wrlock(&this->_lock);
+            };
+
+            void unlock()
+            {
+                pthread_rwlock_unlock(&this->_lock);
+            };
+
+            void lock_shared()
+            {
+                pthread_rwlock_rdlock(&this->_lock);
+            };
+
+            void unlock_shared()
+            {
+                pthread_rwlock_unlock(&this->_lock);
+            };
+    };
+
+    template <class Lock>
+    class lock_guard
+    {
+        Lock& _lock;
+
+        lock_guard(lock_guard const &);
+        lock_guard& operator=(lock_guard const &);
+
+        public:
+            explicit lock_guard(Lock& lock): _lock(lock)
+            {
+                this->_lock.lock();
+            };
+
+            ~lock_guard()
+            {
+                this->_lock.unlock();
+            };
+    };
+
+    template <class Lock>
+    class shared_lock_guard
+    {
+        Lock& _lock;
+
+        shared_lock_guard(shared_lock_guard const &);
+        shared_lock_guard& operator=(shared_lock_guard const &);
+
+        public:
+            explicit shared_lock_guard(Lock& lock): _lock(lock)
+            {
+                this->_lock.lock_shared();
+            };
+
+            ~shared_lock_guard()
+            {
+                this->_lock.unlock_shared();
+            };
+    };
+}
+
+#endif
@@ -0,0 +1,280 @@
+#ifndef CONCURRENT_MAP_HPP
+# define CONCURRENT_MAP_HPP
+
+#include <memory>
+#include <string>
+#include "map.hpp"
+#include "vector.hpp"
+#include "concurrency.hpp"
+
+namespace ft
+{
+    //left undefined for keys that are neither integral nor std::string: specialise ft::hash<Key> for those
+    template <class Key, class Enable = void>
+    struct hash;
+
+    template <class Key>
+    struct hash<Key, typename ft::enable_if<ft::is_integral<Key>::value>::type>
+    {
+        std::size_t operator()(const Key& key) const
+        {
+            //splitmix64 finaliser, so neighbouring keys land on different shards
+            uint64_t x = static_cast<uint64_t>(key);
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return static_cast<std::size_t>(x ^ (x >> 31));
+        };
+    };
+
+    template <>
+    struct hash<std::string>
+    {
+        std::size_t operator()(const std::string& key) const
+        {
+            uint64_t x = 14695981039346656037ULL;
+            for (std::size_t i = 0; i < key.size(); ++i)
+                x = (x ^ static_cast<unsigned char>(key[i])) * 1099511628211ULL;
+            return static_cast<std::size_t>(x);
+        };
+    };
+
+    //spreads keys over the shards by hash; range queries have to visit every shard
+    template <class Key, class Hash = ft::hash<Key> >
+    class hash_partition
+    {
+        std::size_t _shards;
+        Hash _hash;
+
+        public:
+            explicit hash_partition(std::size_t shards = 16, const Hash& hash = Hash()): _shards(shards ? shards : 1), _hash(hash) {};
+
+            std::size_t shards() const
+            {
+                return this->_shards;
+            };
+
+            std::size_t operator()(const Key& key) const
+            {
+                return this->_hash(key) % this->_shards;
+            };
+
+            bool ordered() const
+            {
+                return false;
+            };
+    };
+
+    //shard i holds the keys in [bounds[i - 1], bounds[i]), so shards follow key order
+    template <class Key, class Compare = ft::less<Key> >
+    class range_partition
+    {
+        ft::vector<Key> _bounds;
+        Compare _comp;
+
+        public:
+            range_partition() {};
+
+            //bounds must be sorted
+            template <class InputIt>
+            range_partition(InputIt first, InputIt last, const Compare& comp = Compare()): _bounds(first, last), _comp(comp) {};
+
+            std::size_t shards() const
+            {
+                return this->_bounds.size() + 1;
+            };
+
+            std::size_t operator()(const Key& key) const
+            {
+                std::size_t lo = 0;
+                std::size_t hi = this->_bounds.size();
+                while (lo < hi)
+                {
+                    std::size_t mid = (lo + hi) / 2;
+                    if (this->_comp(key, this->_bounds[mid]))
+                        hi = mid;
+                    else
+                        lo = mid + 1;
+                }
+                return lo;
+            };
+
+            bool ordered() const
+            {
+                return true;
+            };
+    };
+
+    // Ordered map split into independently locked ft::map shards. Lookups take
+    // their shard's lock shared, so readers of one shard run in parallel and
+    // writers only block their own shard. Elements are handed out by copy:
+    // an iterator would outlive the lock protecting it.
+    template <class Key, class T, class Partition = ft::hash_partition<Key>, class Compare = ft::less<Key>, class Alloc = std::allocator<ft::pair<const Key, T> > >
+    class concurrent_map
+    {
+        public:
+            typedef Key key_type;
+            typedef T mapped_type;
+            typedef ft::pair<const Key, T> value_type;
+            typedef Compare key_compare;
+            typedef Partition partition_type;
+            typedef ft::map<Key, T, Compare, Alloc> map_type;
+            typedef std::size_t size_type;
+
+        private:
+            //new[] ignores over-alignment before C++17, so shards are kept off each other's cache lines by padding
+            struct shard
+            {
+                mutable ft::rw_lock lock;
+                map_type map;
+                char pad[FT_CACHE_LINE];
+            };
+
+            shard* _shards;
+            partition_type _partition;
+            key_compare _comp;
+
+            concurrent_map(concurrent_map const &);
+            concurrent_map& operator=(concurrent_map const &);
+
+            shard& shardOf(const key_type& key) const
+            {
+                return this->_shards[this->_partition(key)];
+            };
+
+        public:
+            //every shard orders its keys with comp
+            explicit concurrent_map(const partition_type& partition = partition_type(), const key_compare& comp = key_compare()):
+            _shards(NULL), _partition(partition), _comp(comp)
+            {
+                this->_shards = new shard[this->_partition.shards()];
+                for (size_type i = 0; i < this->_partition.shards(); ++i)
+                    this->_shards[i].map = map_type(comp);
+            };
+
+            ~concurrent_map()
+            {
+                delete[] this->_shards;
+            };
+
+            //false if the key was already present
+            bool insert(const value_type& value)
+            {
+                shard& s = shardOf(value.first);
+                ft::lock_guard<ft::rw_lock> guard(s.lock);
+                return s.map.insert(value).second;
+            };
+
+            //true if the key was new
+            bool insert_or_assign(const key_type& key, const mapped_type& value)
+            {
+                shard& s = shardOf(key);
+                ft::lock_guard<ft::rw_lock> guard(s.lock);
+                ft::pair<typename map_type::iterator, bool> res = s.map.insert(ft::make_pair(key, value));
+                if (!res.second)
+                    res.first->second = value;
+                return res.second;
+            };
+
+            //applies f to the mapped value under the shard's write lock, false if the key is absent
+            template <class F>
+            bool update(const key_type& key, F f)
+            {
+                shard& s = shardOf(key);
+                ft::lock_guard<ft::rw_lock> guard(s.lock);
+                typename map_type::iterator it = s.map.find(key);
+                if (it == s.map.end())
+                    return false;
+                f(it->second);
+                return true;
+            };
+
+            size_type erase(const key_type& key)
+            {
+                shard& s = shardOf(key);
+                ft::lock_guard<ft::rw_lock> guard(s.lock);
+                return s.map.erase(key);
+            };
+
+            //copies the mapped value into value, false if the key is absent
+            bool find(const key_type& key, mapped_type& value) const
+            {
+                shard& s = shardOf(key);
+                ft::shared_lock_guard<ft::rw_lock> guard(s.lock);
+                typename map_type::const_iterator it = s.map.find(key);
+                if (it == s.map.end())
+                    return false;
+                value = it->second;
+                return true;
+            };
+
+            size_type count(const key_type& key) const
+            {
+                shard& s = shardOf(key);
+                ft::shared_lock_guard<ft::rw_lock> guard(s.lock);
+                return s.map.count(key);
+            };
+
+            //calls f on every element in [lo, hi), each shard under its read lock; the
+            //calls follow key order with a range_partition, shard by shard with a hash_partition
+            template <class F>
+            void for_each_range(const key_type& lo, const key_type& hi, F f) const
+            {
+                //an empty range would put lower_bound(lo) past lower_bound(hi)
+                if (!this->_comp(lo, hi))
+                    return ;
+                size_type first = 0;
+                size_type last = this->_partition.shards() - 1;
+                if (this->_partition.ordered())
+                {
+                    first = this->_partition(lo);
+                    last = this->_partition(hi);
+                }
+                for (size_type i = first; i <= last; ++i)
+                {
+                    shard& s = this->_shards[i];
+                    ft::shared_lock_guard<ft::rw_lock> guard(s.lock);
+                    typename map_type::const_iterator end = s.map.lower_bound(hi);
+                    for (typename map_type::const_iterator it = s.map.lower_bound(lo); it != end; ++it)
+                        f(*it);
+                }
+            };
+
+            //not a snapshot while writers are active
+            size_type size() const
+            {
+                size_type res = 0;
+                for (size_type i = 0; i < this->_partition.shards(); ++i)
+                {
+                    ft::shared_lock_guard<ft::rw_lock> guard(this->_shards[i].lock);
+                    res += this->_shards[i].map.size();
+                }
+                return res;
+            };
+
+            bool empty() const
+            {
+                return size() == 0;
+            };
+
+            void clear()
+            {
+                for (size_type i = 0; i < this->_partition.shards(); ++i)
+                {
+                    ft::lock_guard<ft::rw_lock> guard(this->_shards[i].lock);
+                    this->_shards[i].map.clear();
+                }
+            };
+
+            size_type shard_count() const
+            {
+                return this->_partition.shards();
+            };
+
+            key_compare key_comp() const
+            {
+                return this->_comp;
+            };
+    };
+}
+
+#endif
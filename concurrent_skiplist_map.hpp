@@ -0,0 +1,556 @@
+#ifndef CONCURRENT_SKIPLIST_MAP_HPP
+# define CONCURRENT_SKIPLIST_MAP_HPP
+
+#include <memory>
+#include <iterator>
+#include "utils.hpp"
+#include "concurrency.hpp"
+
+namespace ft
+{
+    // Lock-free ordered map on a skip list (Herlihy & Shavit's lock-free list
+    // lifted to several levels). Links carry a mark in their low bit: erase marks
+    // a node's links top-down and the mark on level 0 is the linearisation point,
+    // after which any traversal that passes the node unlinks it.
+    // Erased nodes are freed by epoch-based reclamation: every operation pins the
+    // current epoch while it runs, the epoch only advances once no operation of
+    // the one before is left, and a node retired in epoch e is freed from e + 2
+    // on. Memory therefore follows the live size. Iterators and element
+    // references outlive the operation that returned them, so they are only
+    // protected while the calling thread holds a guard on the map: find,
+    // lower_bound, upper_bound and begin take that guard as an argument, and
+    // find also has an overload that copies the value out instead.
+    // Iteration is weakly consistent: it runs in key order, visits every element
+    // present for the whole walk and may or may not see concurrent changes.
+    // Elements are read-only once inserted.
+    template <class Key, class T, class Compare = ft::less<Key>, class Alloc = std::allocator<ft::pair<const Key, T> > >
+    class concurrent_skiplist_map
+    {
+        public:
+            typedef Key key_type;
+            typedef T mapped_type;
+            typedef ft::pair<const Key, T> value_type;
+            typedef Compare key_compare;
+            typedef Alloc allocator_type;
+            typedef std::size_t size_type;
+
+        private:
+            static const int maxLevel = 16;
+            static const int stripes = 16;
+            static const size_type reclaimPeriod = 64;
+
+            //who retires an erased node: its eraser, or its inserter if that one was still linking it
+            enum node_state { nodeLinking, nodeLinked, nodeErasedWhileLinking };
+
+            struct node
+            {
+                value_type value;
+                int height;
+                int state;
+                size_type retiredAt;
+                node* chain;
+                uintptr_t* next;
+
+                node(const value_type& value, int height): value(value), height(height), state(nodeLinking), retiredAt(0), chain(NULL), next(NULL) {};
+            };
+
+            //operations in progress per epoch parity, spread over cache lines by thread
+            struct epoch_stripe
+            {
+                size_type active[2];
+                char pad[FT_CACHE_LINE - 2 * sizeof(size_type)];
+            };
+
+            typedef typename Alloc::template rebind<node>::other node_alloc;
+            typedef typename Alloc::template rebind<uintptr_t>::other link_alloc;
+
+            uintptr_t _head[maxLevel];
+            int _level;
+            size_type _size __attribute__((aligned(FT_CACHE_LINE)));
+            size_type _epoch __attribute__((aligned(FT_CACHE_LINE)));
+            mutable epoch_stripe _stripes[stripes];
+            node* _retired __attribute__((aligned(FT_CACHE_LINE)));
+            size_type _retiredCount;
+            key_compare _comp;
+            allocator_type _allocator;
+            node_alloc _nodeAllocator;
+            link_alloc _linkAllocator;
+
+            concurrent_skiplist_map(concurrent_skiplist_map const &);
+            concurrent_skiplist_map& operator=(concurrent_skiplist_map const &);
+
+            static bool marked(uintptr_t link)
+            {
+                return link & 1;
+            };
+
+            static node* target(uintptr_t link)
+            {
+                return reinterpret_cast<node*>(link & ~static_cast<uintptr_t>(1));
+            };
+
+            static uintptr_t load(uintptr_t const * link)
+            {
+                return __atomic_load_n(link, __ATOMIC_ACQUIRE);
+            };
+
+            static bool cas(uintptr_t* link, uintptr_t expected, uintptr_t desired)
+            {
+                return __atomic_compare_exchange_n(link, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+            };
+
+            //first node on level 0 from link on that is not being erased
+            static node* live(uintptr_t link)
+            {
+                node* n = target(link);
+                while (n && marked(load(n->next)))
+                    n = target(load(n->next));
+                return n;
+            };
+
+            //geometric with p = 1/4
+            static int randomLevel()
+            {
+                unsigned bits = threadRandom();
+                int level = 1;
+                while (level < maxLevel && !(bits & 3))
+                {
+                    ++level;
+                    bits >>= 2;
+                }
+                return level;
+            };
+
+            int topLevel() const
+            {
+                return __atomic_load_n(&this->_level, __ATOMIC_RELAXED);
+            };
+
+            void raiseLevel(int level)
+            {
+                int current = topLevel();
+                while (current < level && !__atomic_compare_exchange_n(&this->_level, &current, level, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    ;
+            };
+
+            // Fills preds with the links out of the last nodes before key and succs
+            // with the nodes they point to, unlinking marked nodes on the way; true if
+            // succs[0] holds key. Levels above topLevel() keep the head as pred.
+            bool search(const key_type& key, uintptr_t** preds, node** succs)
+            {
+                retry:
+                uintptr_t* pred = this->_head;
+                for (int level = maxLevel - 1; level >= 0; --level)
+                {
+                    node* curr = NULL;
+                    if (level < topLevel())
+                    {
+                        curr = target(load(pred + level));
+                        while (curr)
+                        {
+                            uintptr_t succ = load(curr->next + level);
+                            while (marked(succ))
+                            {
+                                if (!cas(pred + level, reinterpret_cast<uintptr_t>(curr), succ & ~static_cast<uintptr_t>(1)))
+                                    goto retry;
+                                curr = target(succ);
+                                if (!curr)
+                                    break ;
+                                succ = load(curr->next + level);
+                            }
+                            if (!curr || !this->_comp(curr->value.first, key))
+                                break ;
+                            pred = curr->next;
+                            curr = target(succ);
+                        }
+                    }
+                    preds[level] = pred + level;
+                    succs[level] = curr;
+                }
+                return succs[0] && !this->_comp(key, succs[0]->value.first);
+            };
+
+            //read-only descent that steps over marked nodes instead of unlinking them
+            node* lowerNode(const key_type& key) const
+            {
+                uintptr_t const * pred = this->_head;
+                node* curr = NULL;
+                for (int level = topLevel() - 1; level >= 0; --level)
+                {
+                    curr = target(load(pred + level));
+                    while (curr)
+                    {
+                        uintptr_t succ = load(curr->next + level);
+                        while (marked(succ) && (curr = target(succ)))
+                            succ = load(curr->next + level);
+                        if (!curr || !this->_comp(curr->value.first, key))
+                            break ;
+                        pred = curr->next;
+                        curr = target(succ);
+                    }
+                }
+                return curr;
+            };
+
+            node* createNode(const value_type& value, int height)
+            {
+                node* n = this->_nodeAllocator.allocate(1);
+                this->_nodeAllocator.construct(n, node(value, height));
+                n->next = this->_linkAllocator.allocate(height);
+                return n;
+            };
+
+            void destroyNode(node* n)
+            {
+                this->_linkAllocator.deallocate(n->next, n->height);
+                this->_nodeAllocator.destroy(n);
+                this->_nodeAllocator.deallocate(n, 1);
+            };
+
+            /*epochs*/
+            //fixed per thread, from the address of a thread-local
+            static int stripeIndex()
+            {
+                static __thread char mark;
+                return static_cast<int>((reinterpret_cast<uintptr_t>(&mark) * static_cast<uintptr_t>(0x9E3779B97F4A7C15ULL)) >> (sizeof(uintptr_t) * 8 - 4));
+            };
+
+            //an operation counted in an epoch's parity only if the epoch did not move meanwhile
+            size_type pin(int stripe) const
+            {
+                while (true)
+                {
+                    size_type epoch = __atomic_load_n(&this->_epoch, __ATOMIC_SEQ_CST);
+                    __atomic_add_fetch(&this->_stripes[stripe].active[epoch & 1], 1, __ATOMIC_SEQ_CST);
+                    if (__atomic_load_n(&this->_epoch, __ATOMIC_SEQ_CST) == epoch)
+                        return epoch;
+                    __atomic_sub_fetch(&this->_stripes[stripe].active[epoch & 1], 1, __ATOMIC_SEQ_CST);
+                }
+            };
+
+            void unpin(int stripe, size_type epoch) const
+            {
+                __atomic_sub_fetch(&this->_stripes[stripe].active[epoch & 1], 1, __ATOMIC_SEQ_CST);
+            };
+
+            //moves to the next epoch once no operation pinned in the previous one is left
+            void tryAdvance()
+            {
+                size_type epoch = __atomic_load_n(&this->_epoch, __ATOMIC_SEQ_CST);
+                for (int i = 0; i < stripes; ++i)
+                    if (__atomic_load_n(&this->_stripes[i].active[(epoch - 1) & 1], __ATOMIC_SEQ_CST))
+                        return ;
+                __atomic_compare_exchange_n(&this->_epoch, &epoch, epoch + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+            };
+
+            //n must be unlinked on every level and nobody may link it again
+            void retire(node* n)
+            {
+                n->retiredAt = __atomic_load_n(&this->_epoch, __ATOMIC_SEQ_CST);
+                node* head = __atomic_load_n(&this->_retired, __ATOMIC_RELAXED);
+                do
+                    n->chain = head;
+                while (!__atomic_compare_exchange_n(&this->_retired, &head, n, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+                if (__atomic_add_fetch(&this->_retiredCount, 1, __ATOMIC_RELAXED) % reclaimPeriod == 0)
+                    reclaim();
+            };
+
+            //frees the retired nodes no running operation can still hold
+            void reclaim()
+            {
+                tryAdvance();
+                node* list = __atomic_exchange_n(&this->_retired, static_cast<node*>(NULL), __ATOMIC_ACQUIRE);
+                size_type epoch = __atomic_load_n(&this->_epoch, __ATOMIC_SEQ_CST);
+                node* kept = NULL;
+                node* keptTail = NULL;
+                while (list)
+                {
+                    node* n = list;
+                    list = n->chain;
+                    if (n->retiredAt + 2 <= epoch)
+                        destroyNode(n);
+                    else
+                    {
+                        n->chain = kept;
+                        kept = n;
+                        if (!keptTail)
+                            keptTail = n;
+                    }
+                }
+                if (!kept)
+                    return ;
+                node* head = __atomic_load_n(&this->_retired, __ATOMIC_RELAXED);
+                do
+                    keptTail->chain = head;
+                while (!__atomic_compare_exchange_n(&this->_retired, &head, kept, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+            };
+
+            //upper levels are only shortcuts; stop if an erase got to the node first
+            void linkUpper(node* n, uintptr_t** preds, node** succs)
+            {
+                for (int level = 1; level < n->height; ++level)
+                {
+                    while (true)
+                    {
+                        uintptr_t link = load(n->next + level);
+                        if (marked(link))
+                            return ;
+                        if (target(link) != succs[level] && !cas(n->next + level, link, reinterpret_cast<uintptr_t>(succs[level])))
+                            continue ;
+                        if (cas(preds[level], reinterpret_cast<uintptr_t>(succs[level]), reinterpret_cast<uintptr_t>(n)))
+                            break ;
+                        search(n->value.first, preds, succs);
+                        if (succs[0] != n)
+                            return ;
+                    }
+                }
+            };
+
+            //called by the inserter once it stopped linking n; retires n if it was erased meanwhile
+            void finishLinking(node* n)
+            {
+                int state = nodeLinking;
+                if (__atomic_compare_exchange_n(&n->state, &state, nodeLinked, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                    return ;
+                uintptr_t* preds[maxLevel];
+                node* succs[maxLevel];
+                search(n->value.first, preds, succs);
+                retire(n);
+            };
+
+        public:
+            //pins the map's current epoch for the calling thread: nothing reachable from
+            //the map while it is held is freed before it is released
+            class guard
+            {
+                const concurrent_skiplist_map& _map;
+                int _stripe;
+                size_type _epoch;
+
+                guard(const guard&);
+                guard& operator=(const guard&);
+
+                public:
+                    explicit guard(const concurrent_skiplist_map& map): _map(map), _stripe(stripeIndex()), _epoch(map.pin(this->_stripe)) {};
+
+                    ~guard()
+                    {
+                        this->_map.unpin(this->_stripe, this->_epoch);
+                    };
+            };
+            friend class guard;
+
+            class const_iterator
+            {
+                node* _node;
+
+                public:
+                    typedef std::forward_iterator_tag iterator_category;
+                    typedef typename concurrent_skiplist_map::value_type value_type;
+                    typedef std::ptrdiff_t difference_type;
+                    typedef const value_type* pointer;
+                    typedef const value_type& reference;
+
+                    const_iterator(): _node(NULL) {};
+
+                    explicit const_iterator(node* n): _node(n) {};
+
+                    reference operator*() const
+                    {
+                        return this->_node->value;
+                    };
+
+                    pointer operator->() const
+                    {
+                        return &this->_node->value;
+                    };
+
+                    const_iterator& operator++()
+                    {
+                        this->_node = live(load(this->_node->next));
+                        return *this;
+                    };
+
+                    const_iterator operator++(int)
+                    {
+                        const_iterator tmp(*this);
+                        ++(*this);
+                        return tmp;
+                    };
+
+                    bool operator==(const const_iterator& other) const
+                    {
+                        return this->_node == other._node;
+                    };
+
+                    bool operator!=(const const_iterator& other) const
+                    {
+                        return this->_node != other._node;
+                    };
+            };
+            typedef const_iterator iterator;
+
+            explicit concurrent_skiplist_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()):
+            _level(1), _size(0), _epoch(0), _retired(NULL), _retiredCount(0), _comp(comp), _allocator(alloc), _nodeAllocator(alloc), _linkAllocator(alloc)
+            {
+                for (int i = 0; i < maxLevel; ++i)
+                    this->_head[i] = 0;
+                for (int i = 0; i < stripes; ++i)
+                    this->_stripes[i].active[0] = this->_stripes[i].active[1] = 0;
+            };
+
+            //erased nodes still on level 0 are already on the retired list
+            ~concurrent_skiplist_map()
+            {
+                node* n = target(this->_head[0]);
+                while (n)
+                {
+                    uintptr_t link = n->next[0];
+                    if (!marked(link))
+                        destroyNode(n);
+                    n = target(link);
+                }
+                while (this->_retired)
+                {
+                    n = this->_retired;
+                    this->_retired = n->chain;
+                    destroyNode(n);
+                }
+            };
+
+            //the existing element and false if key is already present; the iterator may
+            //only be used if the caller held a guard across the call
+            ft::pair<iterator, bool> insert(const value_type& value)
+            {
+                guard g(*this);
+                uintptr_t* preds[maxLevel];
+                node* succs[maxLevel];
+                node* n = NULL;
+                int height = randomLevel();
+                while (true)
+                {
+                    if (search(value.first, preds, succs))
+                    {
+                        if (n)
+                            destroyNode(n);
+                        return ft::make_pair(iterator(succs[0]), false);
+                    }
+                    if (!n)
+                        n = createNode(value, height);
+                    for (int i = 0; i < height; ++i)
+                        __atomic_store_n(n->next + i, reinterpret_cast<uintptr_t>(succs[i]), __ATOMIC_RELAXED);
+                    if (cas(preds[0], reinterpret_cast<uintptr_t>(succs[0]), reinterpret_cast<uintptr_t>(n)))
+                        break ;
+                }
+                __atomic_add_fetch(&this->_size, 1, __ATOMIC_RELAXED);
+                raiseLevel(height);
+                linkUpper(n, preds, succs);
+                finishLinking(n);
+                return ft::make_pair(iterator(n), true);
+            };
+
+            size_type erase(const key_type& key)
+            {
+                guard g(*this);
+                uintptr_t* preds[maxLevel];
+                node* succs[maxLevel];
+                if (!search(key, preds, succs))
+                    return 0;
+                node* n = succs[0];
+                for (int level = n->height - 1; level > 0; --level)
+                {
+                    uintptr_t link = load(n->next + level);
+                    while (!marked(link) && !cas(n->next + level, link, link | 1))
+                        link = load(n->next + level);
+                }
+                uintptr_t link = load(n->next);
+                while (true)
+                {
+                    if (marked(link))
+                        return 0;
+                    if (cas(n->next, link, link | 1))
+                        break ;
+                    link = load(n->next);
+                }
+                __atomic_sub_fetch(&this->_size, 1, __ATOMIC_RELAXED);
+                search(key, preds, succs);
+                int state = nodeLinking;
+                if (!__atomic_compare_exchange_n(&n->state, &state, nodeErasedWhileLinking, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                    retire(n);
+                return 1;
+            };
+
+            //the iterators below stay valid for as long as the guard passed in is held
+            const_iterator find(const key_type& key, const guard&) const
+            {
+                node* n = lowerNode(key);
+                if (n && !this->_comp(key, n->value.first))
+                    return const_iterator(n);
+                return end();
+            };
+
+            //copies the mapped value into value, false if the key is absent
+            bool find(const key_type& key, mapped_type& value) const
+            {
+                guard g(*this);
+                const_iterator it = find(key, g);
+                if (it == end())
+                    return false;
+                value = it->second;
+                return true;
+            };
+
+            size_type count(const key_type& key) const
+            {
+                guard g(*this);
+                return find(key, g) != end();
+            };
+
+            const_iterator lower_bound(const key_type& key, const guard&) const
+            {
+                return const_iterator(lowerNode(key));
+            };
+
+            const_iterator upper_bound(const key_type& key, const guard& g) const
+            {
+                const_iterator it = lower_bound(key, g);
+                if (it != end() && !this->_comp(key, it->first))
+                    ++it;
+                return it;
+            };
+
+            const_iterator begin(const guard&) const
+            {
+                return const_iterator(live(load(this->_head)));
+            };
+
+            const_iterator end() const
+            {
+                return const_iterator();
+            };
+
+            //exact only while no other thread is modifying the map
+            size_type size() const
+            {
+                return __atomic_load_n(&this->_size, __ATOMIC_RELAXED);
+            };
+
+            bool empty() const
+            {
+                guard g(*this);
+                return begin(g) == end();
+            };
+
+            key_compare key_comp() const
+            {
+                return this->_comp;
+            };
+
+            allocator_type get_allocator() const
+            {
+                return this->_allocator;
+            };
+    };
+}
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef CONCURRENT_STACK_HPP
+# define CONCURRENT_STACK_HPP
+
+#include <memory>
+#include "concurrency.hpp"
+
+namespace ft
+{
+    // Lock-free Treiber stack. The top pointer is tagged against ABA, and popped
+    // nodes go to an internal free list instead of back to the allocator, so a
+    // thread still reading a node it lost the race for never touches freed
+    // memory; nodes are released to the allocator by the destructor.
+    // With elimination slots, a push and a pop that both fail their CAS under
+    // contention can meet in a slot and cancel out without touching the top.
+    template <class T, class Alloc = std::allocator<T> >
+    class concurrent_stack
+    {
+        public:
+            typedef T value_type;
+            typedef Alloc allocator_type;
+            typedef std::size_t size_type;
+
+        private:
+            //next is read by a pop that may lose its CAS while the node is popped and
+            //pushed again elsewhere, so it is accessed atomically; the tagged CAS on the
+            //head does the ordering, relaxed is enough
+            struct node
+            {
+                node* next;
+                T value;
+            };
+
+            struct __attribute__((aligned(FT_CACHE_LINE))) slot
+            {
+                tagged_ptr<node> ptr;
+            };
+
+            typedef typename Alloc::template rebind<node>::other node_alloc;
+            typedef typename Alloc::template rebind<slot>::other slot_alloc;
+
+            tagged_ptr<node> _top __attribute__((aligned(FT_CACHE_LINE)));
+            tagged_ptr<node> _free __attribute__((aligned(FT_CACHE_LINE)));
+            slot* _slots;
+            size_type _slotCount;
+            allocator_type _allocator;
+            node_alloc _nodeAllocator;
+
+            static const int eliminationSpins = 64;
+
+            concurrent_stack(concurrent_stack const &);
+            concurrent_stack& operator=(concurrent_stack const &);
+
+            void pushNode(tagged_ptr<node>* head, node* n)
+            {
+                tagged_ptr<node> top = atomicLoad(head);
+                while (true)
+                {
+                    __atomic_store_n(&n->next, top.ptr, __ATOMIC_RELAXED);
+                    if (compareAndSwap(head, top, tagged_ptr<node>(n, top.tag + 1)))
+                        return ;
+                    top = atomicLoad(head);
+                }
+            };
+
+            //a single CAS attempt, NULL on an empty list or a lost race
+            node* tryPopNode(tagged_ptr<node>* head, bool* empty)
+            {
+                tagged_ptr<node> top = atomicLoad(head);
+                *empty = (top.ptr == NULL);
+                if (!top.ptr)
+                    return NULL;
+                if (compareAndSwap(head, top, tagged_ptr<node>(__atomic_load_n(&top.ptr->next, __ATOMIC_RELAXED), top.tag + 1)))
+                    return top.ptr;
+                return NULL;
+            };
+
+            node* acquireNode(const T& value)
+            {
+                bool empty = false;
+                node* n = NULL;
+                while (!n)
+                {
+                    n = tryPopNode(&this->_free, &empty);
+                    if (empty)
+                    {
+                        n = this->_nodeAllocator.allocate(1);
+                        break ;
+                    }
+                }
+                this->_allocator.construct(&n->value, value);
+                return n;
+            };
+
+            void releaseNode(node* n)
+            {
+                this->_allocator.destroy(&n->value);
+                pushNode(&this->_free, n);
+            };
+
+            //true if a popper took the node while it sat in a slot
+            bool eliminatePush(node* n)
+            {
+                slot& s = this->_slots[threadRandom() % this->_slotCount];
+                tagged_ptr<node> seen = atomicLoad(&s.ptr);
+                if (seen.ptr)
+                    return false;
+                tagged_ptr<node> offered(n, seen.tag + 1);
+                if (!compareAndSwap(&s.ptr, seen, offered))
+                    return false;
+                for (int i = 0; i < eliminationSpins; ++i)
+                {
+                    if (__atomic_load_n(&s.ptr.tag, __ATOMIC_ACQUIRE) != offered.tag)
+                        return true;
+                    cpu_relax();
+                }
+                return !compareAndSwap(&s.ptr, offered, tagged_ptr<node>(NULL, offered.tag + 1));
+            };
+
+            node* eliminatePop()
+            {
+                slot& s = this->_slots[threadRandom() % this->_slotCount];
+                tagged_ptr<node> seen = atomicLoad(&s.ptr);
+                if (seen.ptr && compareAndSwap(&s.ptr, seen, tagged_ptr<node>(NULL, seen.tag + 1)))
+                    return seen.ptr;
+                return NULL;
+            };
+
+            void drain(tagged_ptr<node>& head, bool constructed)
+            {
+                node* n = head.ptr;
+                while (n)
+                {
+                    node* next = n->next;
+                    if (constructed)
+                        this->_allocator.destroy(&n->value);
+                    this->_nodeAllocator.deallocate(n, 1);
+                    n = next;
+                }
+                head.ptr = NULL;
+            };
+
+        public:
+            //eliminationSlots = 0 disables the elimination backoff
+            explicit concurrent_stack(size_type eliminationSlots = 0, const allocator_type& alloc = allocator_type()):
+            _slots(NULL), _slotCount(eliminationSlots), _allocator(alloc), _nodeAllocator(alloc)
+            {
+                if (this->_slotCount)
+                {
+                    slot_alloc slots(alloc);
+                    this->_slots = slots.allocate(this->_slotCount);
+                    for (size_type i = 0; i < this->_slotCount; ++i)
+                        slots.construct(this->_slots + i, slot());
+                }
+            };
+
+            ~concurrent_stack()
+            {
+                drain(this->_top, true);
+                drain(this->_free, false);
+                if (this->_slots)
+                {
+                    slot_alloc slots(this->_allocator);
+                    slots.deallocate(this->_slots, this->_slotCount);
+                }
+            };
+
+            void push(const value_type& value)
+            {
+                node* n = acquireNode(value);
+                tagged_ptr<node> top = atomicLoad(&this->_top);
+                while (true)
+                {
+                    __atomic_store_n(&n->next, top.ptr, __ATOMIC_RELAXED);
+                    if (compareAndSwap(&this->_top, top, tagged_ptr<node>(n, top.tag + 1)))
+                        return ;
+                    if (this->_slotCount && eliminatePush(n))
+                        return ;
+                    top = atomicLoad(&this->_top);
+                }
+            };
+
+            //false if the stack was empty
+            bool pop(value_type& value)
+            {
+                bool empty = false;
+                node* n = NULL;
+                while (true)
+                {
+                    n = tryPopNode(&this->_top, &empty);
+                    if (n || empty)
+                        break ;
+                    if (this->_slotCount && (n = eliminatePop()))
+                        break ;
+                }
+                if (!n)
+                    return false;
+                value = n->value;
+                releaseNode(n);
+                return true;
+            };
+
+            //only a hint while other threads are pushing or popping
+            bool empty() const
+            {
+                return __atomic_load_n(&this->_top.ptr, __ATOMIC_ACQUIRE) == NULL;
+            };
+
+            allocator_type get_allocator() const
+            {
+                return this->_allocator;
+            };
+    };
+}
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef CONCURRENT_VECTOR_HPP
+# define CONCURRENT_VECTOR_HPP
+
+#include <memory>
+#include <stdexcept>
+#include "concurrency.hpp"
+
+namespace ft
+{
+    // Append-only vector for many writers. Storage is a table of segments whose
+    // sizes double (8, 16, 32, ...), so growing allocates a new segment instead
+    // of moving the old ones: elements never relocate and their addresses stay
+    // valid for the life of the container. push_back and grow_by claim indices
+    // with one atomic add, a missing segment is installed with a CAS, and reads
+    // are a table lookup with no lock.
+    // size() counts claimed slots; an element is only safe to read once the
+    // call that appended it has returned and that has been made visible to the
+    // reader (a join, a queue handoff, ...). clear() and destruction must not
+    // overlap other calls.
+    template <class T, class Alloc = std::allocator<T> >
+    class concurrent_vector
+    {
+        public:
+            typedef T value_type;
+            typedef Alloc allocator_type;
+            typedef typename allocator_type::reference reference;
+            typedef typename allocator_type::const_reference const_reference;
+            typedef typename allocator_type::pointer pointer;
+            typedef std::size_t size_type;
+
+        private:
+            static const size_type firstBits = 3;
+            static const size_type maxSegments = sizeof(size_type) * 8 - firstBits;
+
+            pointer _segments[maxSegments];
+            size_type _size __attribute__((aligned(FT_CACHE_LINE)));
+            allocator_type _allocator __attribute__((aligned(FT_CACHE_LINE)));
+
+            concurrent_vector(concurrent_vector const &);
+            concurrent_vector& operator=(concurrent_vector const &);
+
+            static size_type segmentOf(size_type index)
+            {
+                return sizeof(unsigned long) * 8 - 1 - __builtin_clzl(index + (1UL << firstBits)) - firstBits;
+            };
+
+            static size_type segmentBase(size_type segment)
+            {
+                return ((static_cast<size_type>(1) << segment) - 1) << firstBits;
+            };
+
+            static size_type segmentSize(size_type segment)
+            {
+                return static_cast<size_type>(1) << (segment + firstBits);
+            };
+
+            //the segment, allocated and published by whichever thread gets there first
+            pointer segment(size_type k)
+            {
+                pointer seg = __atomic_load_n(&this->_segments[k], __ATOMIC_ACQUIRE);
+                if (seg)
+                    return seg;
+                pointer fresh = this->_allocator.allocate(segmentSize(k));
+                if (__atomic_compare_exchange_n(&this->_segments[k], &seg, fresh, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                    return fresh;
+                this->_allocator.deallocate(fresh, segmentSize(k));
+                return seg;
+            };
+
+            pointer slot(size_type index) const
+            {
+                size_type k = segmentOf(index);
+                return __atomic_load_n(&this->_segments[k], __ATOMIC_ACQUIRE) + (index - segmentBase(k));
+            };
+
+        public:
+            explicit concurrent_vector(const allocator_type& alloc = allocator_type()): _size(0), _allocator(alloc)
+            {
+                for (size_type k = 0; k < maxSegments; ++k)
+                    this->_segments[k] = NULL;
+            };
+
+            ~concurrent_vector()
+            {
+                clear();
+            };
+
+            //the index the value was stored at
+            size_type push_back(const value_type& value)
+            {
+                size_type index = __atomic_fetch_add(&this->_size, 1, __ATOMIC_RELAXED);
+                size_type k = segmentOf(index);
+                this->_allocator.construct(segment(k) + (index - segmentBase(k)), value);
+                return index;
+            };
+
+            //appends n copies of value as one contiguous run of indices, returns the first
+            size_type grow_by(size_type n, const value_type& value = value_type())
+            {
+                size_type first = __atomic_fetch_add(&this->_size, n, __ATOMIC_RELAXED);
+                size_type index = first;
+                while (index < first + n)
+                {
+                    size_type k = segmentOf(index);
+                    pointer seg = segment(k);
+                    size_type end = segmentBase(k) + segmentSize(k);
+                    if (end > first + n)
+                        end = first + n;
+                    for (; index < end; ++index)
+                        this->_allocator.construct(seg + (index - segmentBase(k)), value);
+                }
+                return first;
+            };
+
+            reference operator[](size_type n)
+            {
+                return *slot(n);
+            };
+
+            const_reference operator[](size_type n) const
+            {
+                return *slot(n);
+            };
+
+            reference at(size_type n)
+            {
+                if (n >= size())
+                    throw std::out_of_range("concurrent_vector::at");
+                return *slot(n);
+            };
+
+            const_reference at(size_type n) const
+            {
+                if (n >= size())
+                    throw std::out_of_range("concurrent_vector::at");
+                return *slot(n);
+            };
+
+            size_type size() const
+            {
+                return __atomic_load_n(&this->_size, __ATOMIC_ACQUIRE);
+            };
+
+            bool empty() const
+            {
+                return size() == 0;
+            };
+
+            //slots from index 0 up that can be filled without allocating
+            size_type capacity() const
+            {
+                size_type k = 0;
+                while (k < maxSegments && __atomic_load_n(&this->_segments[k], __ATOMIC_ACQUIRE))
+                    ++k;
+                return segmentBase(k);
+            };
+
+            void clear()
+            {
+                for (size_type i = 0; i < this->_size; ++i)
+                    this->_allocator.destroy(slot(i));
+                for (size_type k = 0; k < maxSegments; ++k)
+                {
+                    if (this->_segments[k])
+                        this->_allocator.deallocate(this->_segments[k], segmentSize(k));
+                    this->_segments[k] = NULL;
+                }
+                this->_size = 0;
+            };
+
+            allocator_type get_allocator() const
+            {
+                return this->_allocator;
+            };
+    };
+}
+
+#endif
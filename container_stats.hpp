@@ -0,0 +1,160 @@
+#ifndef CONTAINER_STATS_HPP
+# define CONTAINER_STATS_HPP
+
+#include <ostream>
+#include <cstddef>
+
+// Optional telemetry, off unless built with -DFT_CONTAINERS_STATS (make
+// STATS=1). Then vectors count their reallocations and the bytes those copy,
+// trees their rotations and the comparisons made by find, each container on
+// its own and all of them together in stats_registry. Without the flag the
+// counting compiles to nothing and those counters read 0; the shape part of
+// stats() (sizes, bytes held, height) is measured on demand either way.
+
+#ifdef FT_CONTAINERS_STATS
+# define FT_STATS(statement) do { statement; } while (0)
+#else
+# define FT_STATS(statement) do {} while (0)
+#endif
+
+namespace ft
+{
+    struct vector_stats
+    {
+        size_t size;
+        size_t capacity;
+        size_t bytes;                       // buffers held, both of them during an incremental growth
+        size_t slack_bytes;                 // capacity not holding an element
+        unsigned long long reallocations;
+        unsigned long long bytes_copied;    // by those reallocations
+    };
+
+    struct tree_stats
+    {
+        size_t nodes;
+        size_t bytes;
+        size_t height;                      // nodes on the longest root to leaf path
+        size_t black_height;
+        unsigned long long rotations;
+        unsigned long long lookups;
+        unsigned long long comparisons;     // made by those lookups
+        double comparisons_per_lookup;
+    };
+
+    struct vector_counters
+    {
+        unsigned long long reallocations;
+        unsigned long long bytes_copied;
+
+        vector_counters(): reallocations(0), bytes_copied(0) {};
+    };
+
+    //lookups are const and may run on several threads, so these are added to atomically
+    struct tree_counters
+    {
+        unsigned long long rotations;
+        unsigned long long lookups;
+        unsigned long long comparisons;
+
+        tree_counters(): rotations(0), lookups(0), comparisons(0) {};
+    };
+
+    inline void statsAdd(unsigned long long& counter, unsigned long long n)
+    {
+        __atomic_fetch_add(&counter, n, __ATOMIC_RELAXED);
+    };
+
+    inline void statsAdd(long long& counter, long long n)
+    {
+        __atomic_fetch_add(&counter, n, __ATOMIC_RELAXED);
+    };
+
+    //totals over every ft container of the process
+    struct stats_totals
+    {
+        unsigned long long vector_reallocations;
+        unsigned long long vector_bytes_copied;
+        long long vector_bytes;             // vector buffers currently allocated
+        long long tree_nodes;               // map and set nodes currently allocated
+        long long tree_bytes;
+        unsigned long long tree_rotations;
+        unsigned long long tree_lookups;
+        unsigned long long tree_comparisons;
+    };
+
+    // Process-wide registry the containers report into, for a metrics
+    // exporter: snapshot() reads the totals, dump() writes them one
+    // "name value" line each. It stays at 0 without FT_CONTAINERS_STATS.
+    class stats_registry
+    {
+        static stats_totals& totals()
+        {
+            static stats_totals totals;
+            return totals;
+        };
+
+        public:
+            static void reallocated()
+            {
+                statsAdd(totals().vector_reallocations, 1);
+            };
+
+            static void copied(size_t bytes)
+            {
+                statsAdd(totals().vector_bytes_copied, bytes);
+            };
+
+            //delta is negative when a buffer is given back
+            static void vectorBytes(long long delta)
+            {
+                statsAdd(totals().vector_bytes, delta);
+            };
+
+            static void treeNodes(long long count, long long bytes)
+            {
+                statsAdd(totals().tree_nodes, count);
+                statsAdd(totals().tree_bytes, bytes);
+            };
+
+            static void rotated()
+            {
+                statsAdd(totals().tree_rotations, 1);
+            };
+
+            static void looked(unsigned long long lookups, unsigned long long comparisons)
+            {
+                statsAdd(totals().tree_lookups, lookups);
+                statsAdd(totals().tree_comparisons, comparisons);
+            };
+
+            static stats_totals snapshot()
+            {
+                stats_totals res;
+                stats_totals& t = totals();
+                res.vector_reallocations = __atomic_load_n(&t.vector_reallocations, __ATOMIC_RELAXED);
+                res.vector_bytes_copied = __atomic_load_n(&t.vector_bytes_copied, __ATOMIC_RELAXED);
+                res.vector_bytes = __atomic_load_n(&t.vector_bytes, __ATOMIC_RELAXED);
+                res.tree_nodes = __atomic_load_n(&t.tree_nodes, __ATOMIC_RELAXED);
+                res.tree_bytes = __atomic_load_n(&t.tree_bytes, __ATOMIC_RELAXED);
+                res.tree_rotations = __atomic_load_n(&t.tree_rotations, __ATOMIC_RELAXED);
+                res.tree_lookups = __atomic_load_n(&t.tree_lookups, __ATOMIC_RELAXED);
+                res.tree_comparisons = __atomic_load_n(&t.tree_comparisons, __ATOMIC_RELAXED);
+                return res;
+            };
+
+            static void dump(std::ostream& out)
+            {
+                stats_totals t = snapshot();
+                out << "ft_vector_reallocations " << t.vector_reallocations << '\n'
+                    << "ft_vector_bytes_copied " << t.vector_bytes_copied << '\n'
+                    << "ft_vector_bytes " << t.vector_bytes << '\n'
+                    << "ft_tree_nodes " << t.tree_nodes << '\n'
+                    << "ft_tree_bytes " << t.tree_bytes << '\n'
+                    << "ft_tree_rotations " << t.tree_rotations << '\n'
+                    << "ft_tree_lookups " << t.tree_lookups << '\n'
+                    << "ft_tree_comparisons " << t.tree_comparisons << '\n';
+            };
+    };
+}
+
+#endif
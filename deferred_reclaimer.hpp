@@ -0,0 +1,302 @@
+#ifndef DEFERRED_RECLAIMER_HPP
+# define DEFERRED_RECLAIMER_HPP
+
+#include <deque>
+#include <cstddef>
+#include "concurrency.hpp"
+#include "utils.hpp"
+
+namespace ft
+{
+    template <class T, class Alloc>
+    class vector;
+
+    template <class Key, class T, class Compare, class Alloc>
+    class map;
+
+    template <class Key, class Compare, class Alloc>
+    class set;
+
+    //storage detached from a container, destroyed a slice at a time
+    class reclaim_job
+    {
+        public:
+            virtual ~reclaim_job() {};
+
+            //destroys up to budget elements, true once nothing is left
+            virtual bool step(std::size_t budget) = 0;
+    };
+
+    // Frees a detached tree without recursion and without extra memory: a node
+    // with a left child is rotated right until the top has none, then it is
+    // freed and its right subtree becomes the top. O(n) steps in all.
+    template <class Alloc>
+    class tree_reclaim_job: public reclaim_job
+    {
+        typedef typename Alloc::pointer node_ptr;
+
+        node_ptr _top;
+        Alloc _allocator;
+
+        public:
+            tree_reclaim_job(node_ptr root, const Alloc& alloc): _top(root), _allocator(alloc) {};
+
+            virtual ~tree_reclaim_job()
+            {
+                while (!step(static_cast<std::size_t>(-1)))
+                    ;
+            };
+
+            virtual bool step(std::size_t budget)
+            {
+                for (; this->_top && budget; --budget)
+                {
+                    node_ptr node = this->_top;
+                    if (node->left)
+                    {
+                        this->_top = node->left;
+                        node->left = this->_top->right;
+                        this->_top->right = node;
+                    }
+                    else
+                    {
+                        this->_top = node->right;
+                        this->_allocator.destroy(node);
+                        this->_allocator.deallocate(node, 1);
+                    }
+                }
+                return !this->_top;
+            };
+    };
+
+    template <class Alloc>
+    class array_reclaim_job: public reclaim_job
+    {
+        typedef typename Alloc::pointer pointer;
+
+        pointer _array;
+        std::size_t _done;
+        std::size_t _size;
+        std::size_t _capacity;
+        Alloc _allocator;
+
+        public:
+            array_reclaim_job(pointer array, std::size_t size, std::size_t capacity, const Alloc& alloc):
+            _array(array), _done(0), _size(size), _capacity(capacity), _allocator(alloc) {};
+
+            virtual ~array_reclaim_job()
+            {
+                while (!step(static_cast<std::size_t>(-1)))
+                    ;
+            };
+
+            virtual bool step(std::size_t budget)
+            {
+                if (!this->_array)
+                    return true;
+                for (; this->_done < this->_size && budget; --budget)
+                    this->_allocator.destroy(this->_array + this->_done++);
+                if (this->_done < this->_size)
+                    return false;
+                this->_allocator.deallocate(this->_array, this->_capacity);
+                this->_array = NULL;
+                return true;
+            };
+    };
+
+    // Takes storage that containers gave up through release_async() and destroys
+    // it off the caller's path: on a background thread, or, for an incremental
+    // reclaimer, a slice at a time whenever the owner calls collect(). The
+    // container's allocator is used from wherever the destruction runs, so a
+    // background reclaimer needs an allocator that may be called from another
+    // thread (std::allocator, thread_cache_allocator; not an unsynchronized
+    // arena). If the thread cannot be started the reclaimer runs as an
+    // incremental one. Destroying the reclaimer finishes everything still queued.
+    class deferred_reclaimer
+    {
+        std::deque<reclaim_job*> _jobs;
+        std::size_t _pending;
+        bool _background;
+        bool _stop;
+        pthread_t _thread;
+        ft::mutex _lock;
+        ft::condition_variable _wake;
+        ft::condition_variable _idle;
+
+        deferred_reclaimer(deferred_reclaimer const &);
+        deferred_reclaimer& operator=(deferred_reclaimer const &);
+
+        static void* threadMain(void* arg)
+        {
+            static_cast<deferred_reclaimer*>(arg)->work();
+            return NULL;
+        };
+
+        void work()
+        {
+            ft::lock_guard<ft::mutex> guard(this->_lock);
+            while (true)
+            {
+                while (this->_jobs.empty() && !this->_stop)
+                    this->_wake.wait(this->_lock);
+                if (this->_jobs.empty())
+                    return ;
+                reclaim_job* job = this->_jobs.front();
+                this->_jobs.pop_front();
+                this->_lock.unlock();
+                //slices keep the lock free for retire() while a big job runs
+                while (!job->step(sliceSize))
+                    ;
+                delete job;
+                this->_lock.lock();
+                if (!--this->_pending)
+                    this->_idle.notify_all();
+            }
+        };
+
+        public:
+            static const std::size_t sliceSize = 1 << 12;
+
+            //false: nothing runs until collect() is called
+            explicit deferred_reclaimer(bool background = true): _pending(0), _background(background), _stop(false)
+            {
+                //without its thread the reclaimer is an incremental one, drain() collects on the caller
+                if (this->_background && pthread_create(&this->_thread, NULL, threadMain, this))
+                    this->_background = false;
+            };
+
+            ~deferred_reclaimer()
+            {
+                if (this->_background)
+                {
+                    {
+                        ft::lock_guard<ft::mutex> guard(this->_lock);
+                        this->_stop = true;
+                        this->_wake.notify_one();
+                    }
+                    pthread_join(this->_thread, NULL);
+                }
+                while (!this->_jobs.empty())
+                {
+                    delete this->_jobs.front();
+                    this->_jobs.pop_front();
+                }
+            };
+
+            //takes ownership of job
+            void retire(reclaim_job* job)
+            {
+                ft::lock_guard<ft::mutex> guard(this->_lock);
+                this->_jobs.push_back(job);
+                ++this->_pending;
+                this->_wake.notify_one();
+            };
+
+            // Destroys up to budget elements of queued storage on the calling thread,
+            // true if nothing is left. For incremental reclaimers; on a background
+            // one it only helps with jobs the thread has not started.
+            bool collect(std::size_t budget = sliceSize)
+            {
+                ft::lock_guard<ft::mutex> guard(this->_lock);
+                while (!this->_jobs.empty() && budget)
+                {
+                    reclaim_job* job = this->_jobs.front();
+                    std::size_t slice = budget < sliceSize ? budget : sliceSize;
+                    budget -= slice;
+                    if (!job->step(slice))
+                        continue ;
+                    this->_jobs.pop_front();
+                    delete job;
+                    if (!--this->_pending)
+                        this->_idle.notify_all();
+                }
+                return !this->_pending;
+            };
+
+            //blocks until everything retired so far is destroyed
+            void drain()
+            {
+                if (!this->_background)
+                {
+                    while (!collect(static_cast<std::size_t>(-1)))
+                        ;
+                    return ;
+                }
+                ft::lock_guard<ft::mutex> guard(this->_lock);
+                while (this->_pending)
+                    this->_idle.wait(this->_lock);
+            };
+
+            //retired jobs not yet fully destroyed
+            std::size_t pending()
+            {
+                ft::lock_guard<ft::mutex> guard(this->_lock);
+                return this->_pending;
+            };
+
+            //a background reclaimer started on first use
+            static deferred_reclaimer& shared()
+            {
+                static deferred_reclaimer reclaimer;
+                return reclaimer;
+            };
+    };
+
+    /*release_async*/
+    //detaches the storage of vector in O(1), capacity included; reclaimer destroys it later, off this thread
+    template <class T, class Alloc>
+    void release_async(ft::vector<T, Alloc>& vector, deferred_reclaimer& reclaimer)
+    {
+        std::size_t size;
+        std::size_t capacity;
+        T* array = container_access<ft::vector<T, Alloc> >::detach(vector, size, capacity);
+        if (array)
+            reclaimer.retire(new array_reclaim_job<Alloc>(array, size, capacity, vector.get_allocator()));
+    };
+
+    template <class T, class Alloc>
+    void release_async(ft::vector<T, Alloc>& vector)
+    {
+        ft::release_async(vector, deferred_reclaimer::shared());
+    };
+
+    //the tree of a map or set, detached in O(1)
+    template <class Container>
+    void releaseTree(Container& container, deferred_reclaimer& reclaimer)
+    {
+        typename Container::tree_type& tree = container_access<Container>::tree(container);
+        typename Container::node_ptr root = tree.getRoot();
+        //detached first: once retired, the reclaimer may free the nodes at any time
+        tree.makeRootNull();
+        if (root)
+            reclaimer.retire(new tree_reclaim_job<typename Container::node_alloc>(root, tree.getAllocator()));
+        container_access<Container>::setSize(container, 0);
+    };
+
+    //detaches the tree of map in O(1); reclaimer destroys the nodes later, off this thread
+    template <class Key, class T, class Compare, class Alloc>
+    void release_async(ft::map<Key, T, Compare, Alloc>& map, deferred_reclaimer& reclaimer)
+    {
+        releaseTree(map, reclaimer);
+    };
+
+    template <class Key, class T, class Compare, class Alloc>
+    void release_async(ft::map<Key, T, Compare, Alloc>& map)
+    {
+        releaseTree(map, deferred_reclaimer::shared());
+    };
+
+    template <class Key, class Compare, class Alloc>
+    void release_async(ft::set<Key, Compare, Alloc>& set, deferred_reclaimer& reclaimer)
+    {
+        releaseTree(set, reclaimer);
+    };
+
+    template <class Key, class Compare, class Alloc>
+    void release_async(ft::set<Key, Compare, Alloc>& set)
+    {
+        releaseTree(set, deferred_reclaimer::shared());
+    };
+}
+
+#endif
@@ -2,6 +2,7 @@
 # define FT_ITERATORS_TRAITS_HPP
 
 #include <iterator>
+#include <cstddef>
 
 namespace ft
 {
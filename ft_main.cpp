@@ -1,12 +1,17 @@
 #include <iostream>
 
 #include <map>
+#include <set>
 #include <stack>
 #include <vector>
 #include <list>
 #include "stack.hpp"
+#include "priority_queue.hpp"
 #include "vector.hpp"
 #include "map.hpp"
+#include "set.hpp"
+#include "persistent_map.hpp"
+#include "parallel.hpp"
 #include "ft_iterator.hpp"
 #include "ft_map_iterator.hpp"
 #include "ft_reverse_iterator.hpp"
@@ -15,6 +20,39 @@
 #include <string>
 #include <sys/time.h>
 
+//keeps count of the elements allocated and not yet given back, so a deallocate() with the wrong size shows up
+template <typename T>
+struct counting_allocator: public std::allocator<T>
+{
+    static long outstanding;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef counting_allocator<U> other;
+    };
+
+    counting_allocator() {};
+    counting_allocator(const counting_allocator&): std::allocator<T>() {};
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) {};
+
+    T* allocate(size_t n, const void* = 0)
+    {
+        outstanding += static_cast<long>(n);
+        return std::allocator<T>::allocate(n);
+    };
+
+    void deallocate(T* p, size_t n)
+    {
+        outstanding -= static_cast<long>(n);
+        std::allocator<T>::deallocate(p, n);
+    };
+};
+
+template <typename T>
+long counting_allocator<T>::outstanding = 0;
+
 template <typename T>
 void print_vector(ft::vector<T> vect)
 {
@@ -24,6 +62,83 @@ void print_vector(ft::vector<T> vect)
     std::cout << std::endl;
 };
 
+template <typename Map>
+void print_map(const Map& map)
+{
+    for (typename Map::const_iterator it = map.begin(); it != map.end(); ++it)
+        std::cout << "[" << it->first << "; " << it->second << "]";
+    std::cout << std::endl;
+};
+
+template <typename Set>
+void print_set(const Set& set)
+{
+    for (typename Set::const_iterator it = set.begin(); it != set.end(); ++it)
+        std::cout << *it << " ";
+    std::cout << std::endl;
+};
+
+//position-weighted sum over a map, so a missing, extra or misplaced element changes it
+template <typename Map>
+long digest(const Map& map)
+{
+    long res = 0;
+    long pos = 1;
+    for (typename Map::const_iterator it = map.begin(); it != map.end(); ++it, ++pos)
+        res += pos * (it->first * 31L + it->second);
+    return res;
+};
+
+//odd values before even ones, larger first within each
+struct odd_first
+{
+    bool operator()(int x, int y) const
+    {
+        if ((x & 1) != (y & 1))
+            return !(x & 1);
+        return x < y;
+    };
+};
+
+struct more
+{
+    bool operator()(int x, int y) const
+    {
+        return x > y;
+    };
+};
+
+//pops everything: the count, the first values and a position-weighted sum of all of them
+template <typename Queue>
+void drain(Queue& queue)
+{
+    long weighted = 0;
+    long pos = 1;
+    std::cout << "draining " << queue.size() << ":";
+    for (; !queue.empty(); ++pos)
+    {
+        if (pos <= 12)
+            std::cout << " " << queue.top();
+        weighted += pos * queue.top();
+        queue.pop();
+    }
+    std::cout << " ... weighted " << weighted << std::endl;
+};
+
+//a comparator with state: the residue mod modulus first, then the value
+struct by_residue
+{
+    int modulus;
+
+    by_residue(int modulus = 1000): modulus(modulus) {};
+
+    bool operator()(int x, int y) const
+    {
+        return x % this->modulus < y % this->modulus || (x % this->modulus == y % this->modulus && x < y);
+    };
+};
+
+
 int main()
 {
     std::cout << "MAIN TESTING FT CONTAINERS\n"; 
@@ -204,6 +319,54 @@ int main()
     str_vect.push_back("vector");
     print_vector(str_vect);
 
+    std::cout << "\nTEST INSERT AT THE END AND OF NOTHING\n";
+    ft::vector<std::string> grown(str_vect);
+    grown.insert(grown.end(), "tail");
+    grown.insert(grown.begin() + 2, 3, "x");
+    grown.insert(grown.begin(), 0, "never");
+    grown.insert(grown.end(), 2, "end");
+    print_vector(grown);
+    ft::vector<int> none(0, 42);
+    std::cout << "filled with nothing: " << none.size() << std::endl;
+    none.insert(none.begin(), 0, 1);
+    none.insert(none.end(), 7);
+    none.insert(none.begin(), 2, 5);
+    print_vector(none);
+
+    std::cout << "\nTEST INSERT OF AN EMPTY RANGE\n";
+    int range_values[] = { 1, 2, 3 };
+    ft::vector<int> range_target;
+    range_target.insert(range_target.begin(), range_values, range_values);
+    std::cout << "into an empty vector: " << range_target.size() << std::endl;
+    range_target.insert(range_target.end(), range_values, range_values + 3);
+    range_target.insert(range_target.begin() + 1, range_values + 1, range_values + 1);
+    range_target.insert(range_target.end(), range_values + 3, range_values + 3);
+    print_vector(range_target);
+
+    std::cout << "\nTEST DEALLOCATION SIZES\n";
+    {
+        ft::vector<int, counting_allocator<int> > counted;
+        for (int i = 0; i < 5; i++)
+            counted.push_back(i);
+        counted.pop_back();
+        counted.reserve(20);
+        counted.push_back(9);
+        std::cout << "counted size: " << counted.size() << ", back: " << counted.back() << std::endl;
+    }
+    std::cout << "elements still allocated: " << counting_allocator<int>::outstanding << std::endl;
+
+    std::cout << "\nTEST ASSIGNMENT OVER A LARGER VECTOR\n";
+    {
+        ft::vector<std::string, counting_allocator<std::string> > fewer(3, "few");
+        ft::vector<std::string, counting_allocator<std::string> > more(10, "more");
+        more = fewer;
+        fewer.push_back("grown");
+        fewer = more;
+        more = more;
+        std::cout << fewer.size() << " " << fewer.back() << ", " << more.size() << " " << more.front() << std::endl;
+    }
+    std::cout << "strings still allocated: " << counting_allocator<std::string>::outstanding << std::endl;
+
     std::cout << "\n--------END TESTING VECTORS--------\n";
 
     std::cout << "\n----------TESTING STACK----------\n";
@@ -294,5 +457,477 @@ int main()
 
     std::cout << "\n--------END TESTING MAP--------\n";
 
+
+    std::cout << "\n----------TESTING ORDER STATISTICS----------\n";
+    ft::map<int, int> ranked;
+    ft::set<int> ranked_set;
+    for (int i = 0; i < 20; i++)
+    {
+        ranked.insert(ft::make_pair(i * 7 % 20 * 3, i));
+        ranked_set.insert(i * 11 % 20 * 2);
+    }
+    print_map(ranked);
+    print_set(ranked_set);
+    std::cout << "nth 0: " << ranked.nth(0)->first << std::endl;
+    std::cout << "nth 13: " << ranked.nth(13)->first << std::endl;
+    std::cout << "nth size is end: " << (ranked.nth(ranked.size()) == ranked.end()) << std::endl;
+    std::cout << "set nth 7: " << *ranked_set.nth(7) << std::endl;
+    std::cout << "rank 30: " << ranked.rank(30) << std::endl;
+    std::cout << "rank 31: " << ranked.rank(31) << std::endl;
+    std::cout << "rank -1: " << ranked.rank(-1) << std::endl;
+    std::cout << "rank 100: " << ranked.rank(100) << std::endl;
+    std::cout << "set rank 15: " << ranked_set.rank(15) << std::endl;
+    std::cout << "count_range 10 40: " << ranked.count_range(10, 40) << std::endl;
+    std::cout << "count_range 40 10: " << ranked.count_range(40, 10) << std::endl;
+    std::cout << "count_range 9 9: " << ranked.count_range(9, 9) << std::endl;
+    std::cout << "set count_range 5 25: " << ranked_set.count_range(5, 25) << std::endl;
+    ranked.erase(ranked.nth(4)->first);
+    std::cout << "after erase, nth 4: " << ranked.nth(4)->first << " rank 60: " << ranked.rank(60) << std::endl;
+
+    std::cout << "\n--------END TESTING ORDER STATISTICS--------\n";
+
+    std::cout << "\n----------TESTING SPLIT AND JOIN----------\n";
+    ft::map<int, int> whole;
+    ft::map<int, int> middle;
+    for (int i = 0; i < 30; i++)
+        whole.insert(ft::make_pair(i * 13 % 30, i));
+    whole.extract_range(10, 20, middle);
+    std::cout << "extract_range 10 20:\n";
+    print_map(whole);
+    print_map(middle);
+    whole.extract_range(25, 5, middle);
+    std::cout << "extract_range 25 5, sizes: " << whole.size() << " " << middle.size() << std::endl;
+    whole.extract_range(28, 100, middle);
+    std::cout << "extract_range 28 100:\n";
+    print_map(whole);
+    print_map(middle);
+    ft::map<int, int> tail;
+    tail.insert(ft::make_pair(40, 0));
+    tail.insert(ft::make_pair(41, 1));
+    whole.append(tail);
+    std::cout << "append after:\n";
+    print_map(whole);
+    std::cout << "appended map size: " << tail.size() << std::endl;
+    ft::map<int, int> head;
+    head.insert(ft::make_pair(-2, 0));
+    head.insert(ft::make_pair(-1, 1));
+    whole.append(head);
+    std::cout << "append before:\n";
+    print_map(whole);
+    ft::map<int, int> overlap;
+    for (int i = 5; i < 25; i += 3)
+        overlap.insert(ft::make_pair(i, -i));
+    whole.append(overlap);
+    std::cout << "append overlapping:\n";
+    print_map(whole);
+    std::cout << "sizes: " << whole.size() << " " << overlap.size() << std::endl;
+
+    ft::set<int> letters;
+    ft::set<int> picked;
+    for (int i = 0; i < 26; i++)
+        letters.insert(i * 5 % 26);
+    letters.extract_range(3, 9, picked);
+    print_set(letters);
+    print_set(picked);
+    letters.append(picked);
+    print_set(letters);
+    std::cout << "sizes: " << letters.size() << " " << picked.size() << std::endl;
+
+    std::cout << "\n--------END TESTING SPLIT AND JOIN--------\n";
+
+    std::cout << "\n----------TESTING SET ALGEBRA----------\n";
+    ft::set<int> odd;
+    ft::set<int> third;
+    ft::set<int> result;
+    for (int i = 0; i < 30; i++)
+    {
+        if (i % 2)
+            odd.insert(i);
+        if (i % 3 == 0)
+            third.insert(i);
+    }
+    set_union(odd, third, result);
+    std::cout << "union: ";
+    print_set(result);
+    set_intersection(odd, third, result);
+    std::cout << "intersection: ";
+    print_set(result);
+    set_difference(odd, third, result);
+    std::cout << "difference: ";
+    print_set(result);
+    set_difference(third, odd, result);
+    std::cout << "reverse difference: ";
+    print_set(result);
+    set_intersection(odd, ft::set<int>(), result);
+    std::cout << "intersection with empty: " << result.size() << std::endl;
+    ft::set<int> alias(odd);
+    set_union(alias, third, alias);
+    std::cout << "union into lhs: ";
+    print_set(alias);
+    set_difference(odd, alias, alias);
+    std::cout << "difference into rhs: " << alias.size() << std::endl;
+    ft::set<int> merged(odd);
+    ft::set<int> rest(third);
+    merged.merge(rest);
+    std::cout << "merge: ";
+    print_set(merged);
+    std::cout << "left behind: ";
+    print_set(rest);
+    ft::map<int, int> merged_map;
+    ft::map<int, int> rest_map;
+    for (int i = 0; i < 10; i++)
+    {
+        merged_map.insert(ft::make_pair(i * 2, i));
+        rest_map.insert(ft::make_pair(i * 3, -i));
+    }
+    merged_map.merge(rest_map);
+    print_map(merged_map);
+    print_map(rest_map);
+
+    std::cout << "\n--------END TESTING SET ALGEBRA--------\n";
+
+    std::cout << "\n----------TESTING NODE HANDLES----------\n";
+    ft::map<int, std::string> donor;
+    ft::map<int, std::string> taker;
+    for (int i = 0; i < 8; i++)
+        donor.insert(ft::make_pair(i, std::string(i + 1, 'a' + i)));
+    taker.insert(ft::make_pair(3, std::string("taken")));
+    ft::map<int, std::string>::node_type moved = donor.extract(5);
+    std::cout << "extracted: " << moved.empty() << " [" << moved.key() << "; " << moved.mapped() << "]\n";
+    print_map(donor);
+    moved.mapped() = "moved";
+    ft::pair<ft::map<int, std::string>::iterator, bool> placed = taker.insert(moved);
+    std::cout << "inserted: " << placed.second << " " << placed.first->second << ", handle empty: " << moved.empty() << std::endl;
+    ft::map<int, std::string>::node_type clash = donor.extract(3);
+    placed = taker.insert(clash);
+    std::cout << "inserted over a present key: " << placed.second << " " << placed.first->second << ", handle kept: [" << clash.key() << "; " << clash.mapped() << "]\n";
+    print_map(taker);
+    ft::map<int, std::string>::node_type missing = donor.extract(42);
+    std::cout << "extract missing, empty: " << missing.empty() << ", insert: " << taker.insert(missing).second << std::endl;
+    ft::map<int, std::string>::node_type first = donor.extract(donor.begin());
+    std::cout << "extract begin: " << first.key() << " size " << donor.size() << std::endl;
+    donor.insert(clash);
+    donor.insert(first);
+    print_map(donor);
+    ft::set<int> from_set;
+    ft::set<int> to_set;
+    for (int i = 0; i < 6; i++)
+        from_set.insert(i * i);
+    ft::set<int>::node_type square = from_set.extract(9);
+    std::cout << "set extracted: " << square.value() << std::endl;
+    std::cout << "set inserted: " << to_set.insert(square).second << ", handle empty: " << square.empty() << std::endl;
+    print_set(from_set);
+    print_set(to_set);
+
+    std::cout << "\n--------END TESTING NODE HANDLES--------\n";
+
+    std::cout << "\n----------TESTING HINTED LOOKUPS----------\n";
+    ft::map<int, int> sparse;
+    ft::set<int> sparse_set;
+    for (int i = 0; i < 200; i++)
+    {
+        sparse.insert(ft::make_pair(i * 5, i));
+        sparse_set.insert(i * 7);
+    }
+    ft::map<int, int>::iterator hint = sparse.find(500);
+    int probes[] = { 500, 502, 505, 480, 0, -3, 995, 996, 1200 };
+    for (size_t i = 0; i < sizeof(probes) / sizeof(probes[0]); i++)
+    {
+        ft::map<int, int>::iterator lower = sparse.lower_bound(hint, probes[i]);
+        ft::map<int, int>::iterator found = sparse.find(hint, probes[i]);
+        std::cout << probes[i] << ": lower_bound ";
+        if (lower == sparse.end())
+            std::cout << "end";
+        else
+            std::cout << lower->first;
+        std::cout << ", find " << (found == sparse.end() ? -1 : found->second) << std::endl;
+    }
+    std::cout << "from begin: " << sparse.lower_bound(sparse.begin(), 733)->first << std::endl;
+    std::cout << "from end: " << sparse.lower_bound(sparse.end(), 733)->first << std::endl;
+    ft::set<int>::iterator set_hint = sparse_set.begin();
+    int walked = 0;
+    for (int key = 0; key < 1400; key += 50)
+    {
+        set_hint = sparse_set.lower_bound(set_hint, key);
+        walked += *set_hint;
+    }
+    std::cout << "set ascending walk: " << walked << std::endl;
+    std::cout << "set find 700: " << (sparse_set.find(sparse_set.end(), 700) != sparse_set.end()) << std::endl;
+    std::cout << "set find 701: " << (sparse_set.find(sparse_set.begin(), 701) != sparse_set.end()) << std::endl;
+
+    std::cout << "\n--------END TESTING HINTED LOOKUPS--------\n";
+    std::cout << "\n----------TESTING PERSISTENT SNAPSHOTS----------\n";
+    std::string digits[] = { "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine" };
+    ft::persistent_map<int, std::string> current;
+    for (int i = 0; i < 10; i++)
+        current.insert(ft::make_pair(i * 2, digits[i]));
+    ft::persistent_map<int, std::string> first_version = current.snapshot();
+    bool was_new = current.insert(ft::make_pair(4, std::string("four")));
+    std::cout << "insert present: " << was_new << std::endl;
+    was_new = current.insert_or_assign(4, "FOUR");
+    std::cout << "assign present: " << was_new << std::endl;
+    was_new = current.insert_or_assign(5, "five");
+    std::cout << "assign new: " << was_new << std::endl;
+    std::cout << "erase 10: " << current.erase(10) << std::endl;
+    std::cout << "erase 11: " << current.erase(11) << std::endl;
+    ft::persistent_map<int, std::string> second_version = current.snapshot();
+    for (int i = 0; i < 20; i += 3)
+        current.erase(i);
+    current.insert(ft::make_pair(100, std::string("hundred")));
+    print_map(first_version);
+    print_map(second_version);
+    print_map(current);
+    std::cout << "sizes: " << first_version.size() << " " << second_version.size() << " " << current.size() << std::endl;
+    std::cout << "at 4: " << first_version.at(4) << " " << second_version.at(4) << std::endl;
+    try
+    {
+        std::cout << current.at(6) << std::endl;
+    }
+    catch (std::out_of_range&)
+    {
+        std::cout << "at 6 after erase: out_of_range" << std::endl;
+    }
+    std::cout << "count 5: " << first_version.count(5) << " " << second_version.count(5) << " " << current.count(5) << std::endl;
+    std::cout << "find 5 in first_version: " << (first_version.find(5) == first_version.end()) << std::endl;
+    std::cout << "lower_bound 7: " << first_version.lower_bound(7)->first << " " << second_version.lower_bound(7)->first << " " << current.lower_bound(7)->first << std::endl;
+    std::cout << "lower_bound 101 is end: " << (current.lower_bound(101) == current.end()) << std::endl;
+    first_version = current;
+    current.clear();
+    std::cout << "assigned then cleared: " << first_version.size() << " " << current.empty() << std::endl;
+    print_map(first_version);
+    print_map(second_version);
+
+    std::cout << "\n--------END TESTING PERSISTENT SNAPSHOTS--------\n";
+    std::cout << "\n----------TESTING INCREMENTAL GROWTH----------\n";
+    ft::vector<std::string> spread;
+    spread.set_incremental_growth(true);
+    for (int i = 0; i < 40; i++)
+    {
+        spread.push_back(std::string(i % 5 + 1, static_cast<char>('a' + i % 26)));
+        if ((i & (i + 1)) == 0 || i % 10 == 9)
+            std::cout << "size " << spread.size() << ", front " << spread.front() << ", back " << spread.back()
+                << ", middle " << spread[spread.size() / 2] << ", at 0 " << spread.at(0) << std::endl;
+    }
+    for (int i = 0; i < 7; i++)
+        spread.pop_back();
+    std::cout << "after pop_back: " << spread.size() << " " << spread.back() << std::endl;
+    spread[3] = "written";
+    for (int i = 0; i < 30; i++)
+        spread.push_back("more");
+    ft::vector<std::string> spread_copy(spread);
+    spread.erase(spread.begin() + 1, spread.begin() + 5);
+    std::cout << "copy " << spread_copy.size() << " " << spread_copy[3] << ", erased " << spread.size() << " " << spread[1] << std::endl;
+    std::string joined;
+    for (ft::vector<std::string>::iterator it = spread.begin(); it != spread.end(); ++it)
+        joined += *it;
+    std::cout << joined << std::endl;
+    spread.clear();
+    ft::vector<int> numbers;
+    numbers.set_incremental_growth(true);
+    long total = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        numbers.push_back(i);
+        total += numbers[i / 2];
+    }
+    ft::vector<int> swapped;
+    swapped.swap(numbers);
+    for (int i = 0; i < 3; i++)
+        swapped.push_back(-i);
+    swapped.set_incremental_growth(false);
+    swapped.resize(1010, 7);
+    std::cout << "numbers: " << numbers.size() << ", swapped: " << swapped.size() << " " << swapped[999] << " " << swapped.back() << ", total " << total << std::endl;
+    print_vector(ft::vector<int>(swapped.begin() + 995, swapped.end()));
+
+    ft::vector<int> pending;
+    pending.set_incremental_growth(true);
+    for (int i = 0; i < 20; i++)
+        pending.push_back(i * i);
+    const ft::vector<int>& reader = pending;
+    ft::vector<int> twin(pending);
+    std::cout << "pending: " << reader.size() << " " << reader[5] << " " << reader.front() << " " << reader.back() << ", equal " << (reader == twin);
+    twin.back() = 0;
+    std::cout << ", less " << (twin < reader) << " " << (reader < twin) << std::endl;
+    pending.settle();
+    for (ft::vector<int>::const_iterator it = reader.begin(); it != reader.end(); ++it)
+        std::cout << *it << " ";
+    std::cout << std::endl;
+    ft::vector<int> plain;
+    plain.swap(pending);
+    std::cout << "incremental after swap: " << plain.incremental_growth() << " " << pending.incremental_growth() << std::endl;
+
+    std::cout << "\n--------END TESTING INCREMENTAL GROWTH--------\n";
+    std::cout << "\n----------TESTING PARALLEL BUILD----------\n";
+    ft::thread_pool build_pool(4);
+    ft::thread_pool single_pool(1);
+    ft::vector<ft::pair<int, int> > build_input;
+    for (int i = 0; i < 10000; i++)
+        build_input.push_back(ft::make_pair(i * 7919 % 6007, i));
+    ft::map<int, int> built;
+    built.insert(ft::make_pair(-1, -1));
+    ft::parallel::build(built, build_input.begin(), build_input.end(), build_pool);
+    ft::map<int, int> built_alone;
+    ft::parallel::build(built_alone, build_input.begin(), build_input.end(), single_pool);
+    std::cout << "map: " << built.size() << " digest " << digest(built) << ", one thread equal: " << (built == built_alone) << std::endl;
+    std::cout << "first of equal keys: " << built[0] << " " << built[100] << " " << built[6006] << ", count -1: " << built.count(-1) << std::endl;
+    std::cout << "nth 0: " << built.nth(0)->first << ", nth 3000: " << built.nth(3000)->first << ", nth 6006: " << built.nth(6006)->first << std::endl;
+    for (int i = 0; i < 6007; i += 3)
+        built.erase(i);
+    for (int i = 6007; i < 6100; i++)
+        built.insert(ft::make_pair(i, -i));
+    std::cout << "updated: " << built.size() << " digest " << digest(built) << ", lower_bound 3000: " << built.lower_bound(3000)->first << std::endl;
+    ft::vector<ft::pair<int, int> > few;
+    few.push_back(ft::make_pair(3, 30));
+    few.push_back(ft::make_pair(1, 10));
+    few.push_back(ft::make_pair(3, 31));
+    few.push_back(ft::make_pair(2, 20));
+    few.push_back(ft::make_pair(1, 11));
+    ft::parallel::build(built, few.begin(), few.end(), build_pool);
+    print_map(built);
+    ft::parallel::build(built, few.begin(), few.begin(), build_pool);
+    std::cout << "from nothing: " << built.size() << " " << built.empty() << " " << (built.begin() == built.end()) << std::endl;
+    built.insert(ft::make_pair(5, 50));
+    print_map(built);
+    ft::vector<int> set_input;
+    for (int i = 0; i < 9000; i++)
+        set_input.push_back(i * 31 % 5000);
+    ft::set<int> built_set;
+    ft::parallel::build(built_set, set_input.begin(), set_input.end(), build_pool);
+    ft::set<int> built_set_alone;
+    ft::parallel::build(built_set_alone, set_input.begin(), set_input.end(), single_pool);
+    int set_sum = 0;
+    for (ft::set<int>::iterator it = built_set.begin(); it != built_set.end(); ++it)
+        set_sum += *it;
+    std::cout << "set: " << built_set.size() << " sum " << set_sum << ", one thread equal: " << (built_set == built_set_alone) << ", nth 4321: " << *built_set.nth(4321) << std::endl;
+    ft::parallel::build(built_set, set_input.begin(), set_input.begin() + 1, single_pool);
+    print_set(built_set);
+
+    std::cout << "\n--------END TESTING PARALLEL BUILD--------\n";
+    std::cout << "\n----------TESTING PRIORITY QUEUE----------\n";
+    int heap_values[] = { 5, 1, 9, 3, 9, 7, 2, 8, 1, 6, 4, 9, 0, 5, 5 };
+    int heap_count = sizeof(heap_values) / sizeof(heap_values[0]);
+    ft::vector<int> heap_many;
+    for (int i = 0; i < 1000; i++)
+        heap_many.push_back(i * 37 % 101);
+    ft::priority_queue<int> heaped(heap_values, heap_values + heap_count);
+    std::cout << "heapified: " << heaped.size() << " top " << heaped.top() << std::endl;
+    heaped.push(11);
+    heaped.push(-2);
+    heaped.push(9);
+    heaped.push_range(heap_values, heap_values + 4);
+    heaped.pop_push(3);
+    heaped.pop_push(20);
+    ft::priority_queue<int> heaped_copy(heaped);
+    drain(heaped);
+    heaped_copy.push_range(heap_many.begin(), heap_many.end());
+    heaped_copy.pop_push(50);
+    heaped = heaped_copy;
+    drain(heaped_copy);
+    heaped.push_range(heap_values, heap_values);
+    std::cout << "assigned: " << heaped.size() << " top " << heaped.top() << std::endl;
+    ft::priority_queue<int> from_container(ft::less<int>(), ft::vector<int>(heap_values, heap_values + 6));
+    from_container.push(4);
+    drain(from_container);
+    ft::priority_queue<int, ft::vector<int>, odd_first, 2> odd_heap;
+    for (int i = 0; i < 200; i++)
+        odd_heap.push(i * 53 % 97 - 40);
+    odd_heap.push_range(heap_values, heap_values + heap_count);
+    for (int i = 0; i < 50; i++)
+        odd_heap.pop_push(i * 7 % 13 - 6);
+    drain(odd_heap);
+    ft::priority_queue<int, ft::vector<int>, more, 8> min_heap(heap_many.begin(), heap_many.begin() + 300);
+    for (int i = 0; i < 100; i++)
+        min_heap.pop();
+    min_heap.push_range(heap_many.begin() + 300, heap_many.end());
+    min_heap.push_range(heap_values, heap_values + heap_count);
+    drain(min_heap);
+
+    std::cout << "\n--------END TESTING PRIORITY QUEUE--------\n";
+    std::cout << "\n----------TESTING BATCHED LOOKUPS----------\n";
+    ft::map<int, std::string> batched;
+    for (int i = 0; i < 100; i++)
+        batched.insert(ft::make_pair(i * 3, std::string(1, static_cast<char>('a' + i % 26))));
+    ft::vector<int> probe_keys;
+    for (int i = -4; i < 60; i++)
+        probe_keys.push_back(i * 7 % 311);
+    ft::vector<ft::map<int, std::string>::iterator> found(probe_keys.size());
+    batched.find_batch(probe_keys.begin(), probe_keys.end(), found.begin());
+    int hits = 0;
+    for (size_t i = 0; i < found.size(); i++)
+    {
+        if (found[i] == batched.end())
+            std::cout << probe_keys[i] << ":end ";
+        else
+        {
+            std::cout << probe_keys[i] << ":" << found[i]->second << " ";
+            found[i]->second += "!";
+            hits++;
+        }
+    }
+    std::cout << std::endl << "hits: " << hits << std::endl;
+    const ft::map<int, std::string>& batched_const = batched;
+    ft::vector<ft::map<int, std::string>::const_iterator> found_const(probe_keys.size() + 1);
+    ft::vector<ft::map<int, std::string>::const_iterator>::iterator written = batched_const.find_batch(probe_keys.begin() + 10, probe_keys.end(), found_const.begin());
+    std::cout << "written: " << (written - found_const.begin()) << std::endl;
+    for (size_t i = 0; i + 10 < probe_keys.size(); i++)
+        std::cout << (found_const[i] == batched_const.end() ? std::string("end") : found_const[i]->second) << " ";
+    std::cout << std::endl;
+    std::cout << "empty batch: " << (batched.find_batch(probe_keys.begin(), probe_keys.begin(), found.begin()) == found.begin()) << std::endl;
+    ft::map<int, std::string> no_keys;
+    no_keys.find_batch(probe_keys.begin(), probe_keys.begin() + 20, found.begin());
+    int misses = 0;
+    for (size_t i = 0; i < 20; i++)
+        misses += found[i] == no_keys.end();
+    std::cout << "empty map misses: " << misses << std::endl;
+    ft::set<int> batched_set;
+    for (int i = 0; i < 40; i++)
+        batched_set.insert(i * i);
+    ft::vector<ft::set<int>::iterator> found_in_set(51);
+    batched_set.find_batch(probe_keys.begin(), probe_keys.begin() + 51, found_in_set.begin());
+    for (size_t i = 0; i < found_in_set.size(); i++)
+    {
+        if (found_in_set[i] == batched_set.end())
+            std::cout << "end ";
+        else
+            std::cout << *found_in_set[i] << " ";
+    }
+    std::cout << std::endl;
+    const ft::set<int>& batched_set_const = batched_set;
+    ft::vector<ft::set<int>::const_iterator> found_in_set_const(17);
+    batched_set_const.find_batch(probe_keys.end() - 17, probe_keys.end(), found_in_set_const.begin());
+    for (size_t i = 0; i < found_in_set_const.size(); i++)
+        std::cout << (found_in_set_const[i] == batched_set_const.end() ? -1 : *found_in_set_const[i]) << " ";
+    std::cout << std::endl;
+
+    std::cout << "\n--------END TESTING BATCHED LOOKUPS--------\n";    std::cout << "\n----------TESTING STATEFUL COMPARATORS----------\n";
+    ft::map<int, int, by_residue> by_seven(by_residue(7));
+    ft::set<int, by_residue> by_five(by_residue(5));
+    for (int i = 0; i < 30; i++)
+    {
+        by_seven.insert(ft::make_pair(i * 3, i));
+        by_five.insert(i * 2);
+    }
+    print_map(by_seven);
+    print_set(by_five);
+    std::cout << "find 27: " << by_seven.find(27)->second << ", lower_bound 10: " << by_seven.lower_bound(10)->first
+        << ", count 8: " << by_five.count(8) << ", upper_bound 8: " << *by_five.upper_bound(8) << std::endl;
+    ft::map<int, int, by_residue> seven_copy(by_seven);
+    ft::map<int, int, by_residue> seven_assigned;
+    seven_assigned.insert(ft::make_pair(999, 0));
+    seven_assigned = by_seven;
+    seven_assigned.insert(ft::make_pair(100, -1));
+    seven_copy.insert(ft::make_pair(101, -2));
+    print_map(seven_assigned);
+    print_map(seven_copy);
+    ft::map<int, int, by_residue> slice(by_residue(7));
+    by_seven.extract_range(14, 16, slice);
+    print_map(slice);
+    std::cout << "left: " << by_seven.size() << std::endl;
+    ft::set<int, by_residue> five_copy(by_five);
+    five_copy.insert(11);
+    print_set(five_copy);
+
+    std::cout << "\n--------END TESTING STATEFUL COMPARATORS--------\n";
+
     return 0;
 }
\ No newline at end of file
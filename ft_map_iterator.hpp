@@ -116,6 +116,11 @@ namespace ft
             //     print_nodes(root->right, i + 1);
             // }
 
+            node_ptr getNode() const
+            {
+                return this->_ptr;
+            };
+
             node_ptr find_max_all_tree(node_ptr node)
             {
                 while (node && node->parent)
@@ -210,6 +215,37 @@ namespace ft
                 return *this;
             };
 
+            /*jumps, O(log n) through the subtree sizes kept by the tree*/
+            map_iterator& operator+=(difference_type n)
+            {
+                node_ptr root = ft::treeRoot(this->_ptr ? this->_ptr : this->_root);
+                difference_type pos = this->_ptr ? ft::treeIndex(this->_ptr) : ft::treeSize(root);
+                pos += n;
+                if (pos < 0)
+                    this->_ptr = NULL;
+                else
+                    this->_ptr = ft::treeSelect(root, static_cast<size_t>(pos));
+                this->_root = root;
+                return *this;
+            };
+
+            map_iterator& operator-=(difference_type n)
+            {
+                return *this += -n;
+            };
+
+            map_iterator operator+(difference_type n) const
+            {
+                map_iterator tmp(*this);
+                return tmp += n;
+            };
+
+            map_iterator operator-(difference_type n) const
+            {
+                map_iterator tmp(*this);
+                return tmp += -n;
+            };
+
             /*relationship*/
             template <class Iter1, class Iter2>
             friend bool	operator==(const map_iterator<Iter1>& left, const map_iterator<Iter2>& right);
@@ -0,0 +1,104 @@
+#ifndef LATENCY_HISTOGRAM_HPP
+# define LATENCY_HISTOGRAM_HPP
+
+#include <stdint.h>
+#include <cstddef>
+
+// Log-linear latency histogram in the style of HdrHistogram: values below
+// 2^subBits are counted exactly, above that every power of two is split into
+// 2^subBits buckets, so any recorded value is known to within 1/32 of itself
+// over the whole 64-bit range with a fixed 15 KB table and an O(1) record().
+
+namespace bench
+{
+    class latency_histogram
+    {
+        static const int subBits = 5;
+        static const uint64_t subCount = 1 << subBits;
+        static const size_t buckets = subCount + (64 - subBits) * subCount;
+
+        uint64_t _counts[buckets];
+        uint64_t _total;
+        uint64_t _max;
+
+        static size_t indexOf(uint64_t value)
+        {
+            if (value < subCount)
+                return static_cast<size_t>(value);
+            int exponent = 63 - __builtin_clzll(value);
+            uint64_t sub = (value >> (exponent - subBits)) - subCount;
+            return static_cast<size_t>(subCount + (exponent - subBits) * subCount + sub);
+        };
+
+        //the largest value that lands in bucket index
+        static uint64_t highestIn(size_t index)
+        {
+            if (index < subCount)
+                return index;
+            int shift = static_cast<int>((index - subCount) / subCount);
+            uint64_t sub = (index - subCount) % subCount;
+            return ((subCount + sub + 1) << shift) - 1;
+        };
+
+        public:
+            latency_histogram()
+            {
+                clear();
+            };
+
+            void clear()
+            {
+                for (size_t i = 0; i < buckets; ++i)
+                    this->_counts[i] = 0;
+                this->_total = 0;
+                this->_max = 0;
+            };
+
+            void record(uint64_t value)
+            {
+                ++this->_counts[indexOf(value)];
+                ++this->_total;
+                if (value > this->_max)
+                    this->_max = value;
+            };
+
+            void merge(const latency_histogram& other)
+            {
+                for (size_t i = 0; i < buckets; ++i)
+                    this->_counts[i] += other._counts[i];
+                this->_total += other._total;
+                if (other._max > this->_max)
+                    this->_max = other._max;
+            };
+
+            uint64_t count() const
+            {
+                return this->_total;
+            };
+
+            uint64_t max() const
+            {
+                return this->_max;
+            };
+
+            //smallest bucket bound that covers a fraction q of the values (0.99 for p99)
+            uint64_t percentile(double q) const
+            {
+                if (!this->_total)
+                    return 0;
+                uint64_t rank = static_cast<uint64_t>(q * this->_total + 0.5);
+                if (rank < 1)
+                    rank = 1;
+                uint64_t seen = 0;
+                for (size_t i = 0; i < buckets; ++i)
+                {
+                    seen += this->_counts[i];
+                    if (seen >= rank)
+                        return highestIn(i) < this->_max ? highestIn(i) : this->_max;
+                }
+                return this->_max;
+            };
+    };
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include "ft_map_iterator.hpp"
 #include "RBtree.hpp"
 #include "ft_reverse_iterator.hpp"
+#include "node_handle.hpp"
 #include "utils.hpp"
 
 namespace ft
@@ -31,6 +32,15 @@ namespace ft
                     }
             };
 
+            //what find_batch looks up for a key: the key with a default mapped value, as find does
+            struct key_probe
+            {
+                value_type operator()(const key_type& key) const
+                {
+                    return value_type(key, mapped_type());
+                };
+            };
+
         public:
 
             typedef pair_compare value_compare;
@@ -45,9 +55,12 @@ namespace ft
             typedef typename Alloc::template rebind<Node<value_type> >::other node_alloc;
             typedef RBtree<value_type, Node<value_type>, pair_compare, node_alloc> tree_type;
             typedef Node<value_type>* node_ptr;
+            typedef ft::map_node_handle<Key, T, node_alloc> node_type;
 
         private:
 
+            friend struct container_access<map>;
+
             tree_type _tree;
             size_type _size;
 
@@ -59,18 +72,18 @@ namespace ft
             /*constructors*/
             //default = empty
             explicit map (const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()):
-             _tree(tree_type()), _size(0), _allocator(alloc), _key_comp(comp), _value_comp(pair_compare(_key_comp)) {};
+             _tree(tree_type(pair_compare(comp), node_alloc(alloc))), _size(0), _allocator(alloc), _key_comp(comp), _value_comp(pair_compare(_key_comp)) {};
 
             
             //range 	
             template <class InputIterator>
-            map (InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _tree(tree_type()), _size(0), _allocator(alloc), _key_comp(comp), _value_comp(pair_compare(_key_comp))
+            map (InputIterator first, InputIterator last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()): _tree(tree_type(pair_compare(comp), node_alloc(alloc))), _size(0), _allocator(alloc), _key_comp(comp), _value_comp(pair_compare(_key_comp))
             {
                 insert(first, last);
             };
             
             //copy	
-            map (const map& x): _tree(tree_type()), _size(0), _allocator(x._allocator), _key_comp(x._key_comp), _value_comp(x._value_comp)
+            map (const map& x): _tree(tree_type(x._value_comp, node_alloc(x._allocator))), _size(0), _allocator(x._allocator), _key_comp(x._key_comp), _value_comp(x._value_comp)
             {
                 clear();
                 insert(x.begin(), x.end());
@@ -79,8 +92,7 @@ namespace ft
             /*destructor*/
             ~map()
             {
-                this->_tree.clear(this->_tree.getRoot());
-                this->_tree.makeRootNull();
+                this->_tree.clearAll();
             };
 
             map& operator=(map const & source)
@@ -89,6 +101,7 @@ namespace ft
                     return *this;
                 clear();
                 this->_allocator = source._allocator;
+                this->_tree = tree_type(source._value_comp, node_alloc(source._allocator));
                 this->_key_comp = source._key_comp;
                 this->_value_comp = source._value_comp;
                 insert(source.begin(), source.end());
@@ -152,6 +165,12 @@ namespace ft
                 return this->_tree.max_size();
             };
 
+            //memory, shape and (with FT_CONTAINERS_STATS) rotation and lookup counters of the tree
+            tree_stats stats() const
+            {
+                return this->_tree.stats();
+            };
+
             /*element access*/
             mapped_type& operator[] (const key_type& k)
             {
@@ -185,11 +204,7 @@ namespace ft
 
             void erase (iterator position)
             {
-                iterator it = begin();
-                while (it != position)
-                    it++;
-                node_ptr node = this->_tree.find(*it, this->_tree.getRoot());
-                this->_size -= this->_tree.deleteNode(node);
+                this->_size -= this->_tree.deleteNode(position.getNode());
             };
 
             size_type erase (const key_type& k)
@@ -229,11 +244,127 @@ namespace ft
 
             void clear()
             {
-                this->_tree.clear(this->_tree.getRoot());
-                this->_tree.makeRootNull();
+                this->_tree.clearAll();
                 this->_size = 0;
             };
 
+            //moves the elements with keys in [lo, hi) into out by relinking nodes, O(log n);
+            //copied instead when out's allocator cannot free this map's nodes
+            void extract_range (const key_type& lo, const key_type& hi, map& out)
+            {
+                if (this == &out)
+                    return ;
+                out.clear();
+                if (!this->_key_comp(lo, hi))
+                    return ;
+                if (!(this->_tree.getAllocator() == out._tree.getAllocator()))
+                {
+                    iterator first = lower_bound(lo);
+                    iterator last = lower_bound(hi);
+                    out.insert(first, last);
+                    erase(first, last);
+                    return ;
+                }
+                tree_type tail(this->_value_comp, this->_tree.getAllocator());
+                this->_tree.splitAt(ft::make_pair(lo, mapped_type()), out._tree);
+                out._tree.splitAt(ft::make_pair(hi, mapped_type()), tail);
+                this->_tree.append(tail);
+                this->_size = ft::treeSize(this->_tree.getRoot());
+                out._size = ft::treeSize(out._tree.getRoot());
+            };
+
+            //moves every element of x here; O(log n) when the key ranges do not overlap,
+            //otherwise nodes are relinked one by one and those with a key already present are dropped.
+            //With allocators that compare unequal the elements are copied instead
+            void append (map& x)
+            {
+                if (this == &x || x.empty())
+                    return ;
+                if (!(this->_tree.getAllocator() == x._tree.getAllocator()))
+                {
+                    insert(x.begin(), x.end());
+                    x.clear();
+                    return ;
+                }
+                if (empty() || this->_key_comp(this->_tree.max(this->_tree.getRoot())->pair.first, x._tree.min(x._tree.getRoot())->pair.first))
+                    this->_tree.append(x._tree);
+                else if (this->_key_comp(x._tree.max(x._tree.getRoot())->pair.first, this->_tree.min(this->_tree.getRoot())->pair.first))
+                    this->_tree.prepend(x._tree);
+                else
+                    this->_tree.absorb(x._tree);
+                this->_size = ft::treeSize(this->_tree.getRoot());
+                x._size = 0;
+            };
+
+            /*node handles*/
+            //detaches the node from the tree without freeing it
+            node_type extract (iterator position)
+            {
+                node_ptr node = position.getNode();
+                if (!node)
+                    return node_type();
+                this->_tree.unlink(node);
+                this->_size--;
+                return node_type(node, this->_tree.getAllocator());
+            };
+
+            node_type extract (const key_type& k)
+            {
+                return extract(find(k));
+            };
+
+            //relinks the node held by nh; if the key is already present nh keeps it.
+            //A node from an allocator that compares unequal is copied and freed by its own
+            ft::pair<iterator, bool> insert (const node_type& nh)
+            {
+                node_ptr node = nh.get();
+                if (!node)
+                    return ft::pair<iterator, bool>(end(), false);
+                if (!(nh.get_allocator() == this->_tree.getAllocator()))
+                {
+                    ft::pair<iterator, bool> res = insert(node->pair);
+                    if (res.second)
+                        node_type dropped(nh);
+                    return res;
+                }
+                node_ptr res = this->_tree.insertUnique(node);
+                if (res == node)
+                {
+                    nh.release();
+                    this->_size++;
+                }
+                return ft::pair<iterator, bool>(iterator(res, this->_tree.getRoot()), res == node);
+            };
+
+            iterator insert (iterator, const node_type& nh)
+            {
+                return insert(nh).first;
+            };
+
+            //moves the nodes of x whose key is not here yet, O(n + m) and without allocation;
+            //with allocators that compare unequal the elements are copied and erased from x instead
+            void merge (map& x)
+            {
+                if (this == &x)
+                    return ;
+                if (!(this->_tree.getAllocator() == x._tree.getAllocator()))
+                {
+                    iterator it = x.begin();
+                    while (it != x.end())
+                    {
+                        iterator next = it;
+                        ++next;
+                        if (insert(*it).second)
+                            x.erase(it);
+                        it = next;
+                    }
+                    return ;
+                }
+                this->_tree.merge(x._tree);
+                this->_size = ft::treeSize(this->_tree.getRoot());
+                x._size = ft::treeSize(x._tree.getRoot());
+            };
+
             /*observers*/
             key_compare key_comp() const
             {
@@ -256,6 +387,35 @@ namespace ft
                 return const_iterator(this->_tree.find(ft::make_pair(k, mapped_type()), this->_tree.getRoot()), this->_tree.getRoot());
             };
 
+            //writes one iterator per key, end() when absent; the lookups are interleaved
+            template <class InputIterator, class OutputIterator>
+            OutputIterator find_batch (InputIterator first, InputIterator last, OutputIterator out)
+            {
+                return this->_tree.template findEach<iterator>(first, last, out, key_probe());
+            };
+
+            template <class InputIterator, class OutputIterator>
+            OutputIterator find_batch (InputIterator first, InputIterator last, OutputIterator out) const
+            {
+                return this->_tree.template findEach<const_iterator>(first, last, out, key_probe());
+            };
+
+            iterator find (iterator hint, const key_type& k)
+            {
+                iterator it = lower_bound(hint, k);
+                if (it != end() && this->_key_comp(k, it->first))
+                    return end();
+                return it;
+            };
+
+            const_iterator find (const_iterator hint, const key_type& k) const
+            {
+                const_iterator it = lower_bound(hint, k);
+                if (it != end() && this->_key_comp(k, it->first))
+                    return end();
+                return it;
+            };
+
             size_type count (const key_type& k) const
             {
                 if (this->_tree.find(ft::make_pair(k, mapped_type()), this->_tree.getRoot()))
@@ -273,6 +433,17 @@ namespace ft
                 return const_iterator(this->_tree.lower(this->_tree.getRoot(), ft::make_pair(k, mapped_type())), this->_tree.getRoot());
             };
 
+            //finger search starting from hint, cheap when the key is close to it
+            iterator lower_bound (iterator hint, const key_type& k)
+            {
+                return iterator(this->_tree.lowerFrom(hint.getNode(), ft::make_pair(k, mapped_type())), this->_tree.getRoot());
+            };
+
+            const_iterator lower_bound (const_iterator hint, const key_type& k) const
+            {
+                return const_iterator(this->_tree.lowerFrom(hint.getNode(), ft::make_pair(k, mapped_type())), this->_tree.getRoot());
+            };
+
             iterator upper_bound (const key_type& k)
             {
                 return iterator(this->_tree.upper(this->_tree.getRoot(), ft::make_pair(k, mapped_type())), this->_tree.getRoot());
@@ -283,6 +454,32 @@ namespace ft
                 return const_iterator(this->_tree.upper(this->_tree.getRoot(), ft::make_pair(k, mapped_type())), this->_tree.getRoot());
             };
 
+            /*order statistics*/
+            //k-th smallest element, end() if k >= size()
+            iterator nth (size_type k)
+            {
+                return iterator(this->_tree.select(this->_tree.getRoot(), k), this->_tree.getRoot());
+            };
+
+            const_iterator nth (size_type k) const
+            {
+                return const_iterator(this->_tree.select(this->_tree.getRoot(), k), this->_tree.getRoot());
+            };
+
+            //number of keys less than k
+            size_type rank (const key_type& k) const
+            {
+                return this->_tree.rank(this->_tree.getRoot(), ft::make_pair(k, mapped_type()));
+            };
+
+            //number of keys in [lo, hi)
+            size_type count_range (const key_type& lo, const key_type& hi) const
+            {
+                if (!this->_key_comp(lo, hi))
+                    return 0;
+                return rank(hi) - rank(lo);
+            };
+
             pair<iterator, iterator> equal_range (const key_type& k)
             {
                 return ft::make_pair(lower_bound(k), upper_bound(k));
@@ -301,6 +498,22 @@ namespace ft
             };
     };
 
+    template <class Key, class T, class Compare, class Alloc>
+    struct container_access<map<Key, T, Compare, Alloc> >
+    {
+        typedef map<Key, T, Compare, Alloc> container;
+
+        static typename container::tree_type& tree(container& map)
+        {
+            return map._tree;
+        };
+
+        static void setSize(container& map, typename container::size_type size)
+        {
+            map._size = size;
+        };
+    };
+
     template< class Key, class T, class Compare, class Alloc >
     bool operator==( const map<Key,T,Compare,Alloc>& lhs, const map<Key,T,Compare,Alloc>& rhs )
     {
@@ -0,0 +1,511 @@
+#ifndef MEMORY_RESOURCE_HPP
+# define MEMORY_RESOURCE_HPP
+
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <stdint.h>
+#include "utils.hpp"
+
+// Run-time chosen memory for the containers, after C++17's std::pmr. A
+// memory_resource hands out raw bytes; polymorphic_allocator<T> is an ordinary
+// allocator that forwards to one, so a vector, map and set of different types
+// can all draw from the same arena and be thrown away together.
+
+namespace ft
+{
+    //what operator new guarantees on the platforms we build on
+    static const std::size_t maxAlign = 2 * sizeof(void*);
+
+    class memory_resource
+    {
+        public:
+            virtual ~memory_resource() {};
+
+            void* allocate(std::size_t bytes, std::size_t alignment = maxAlign)
+            {
+                return do_allocate(bytes, alignment);
+            };
+
+            void deallocate(void* p, std::size_t bytes, std::size_t alignment = maxAlign)
+            {
+                do_deallocate(p, bytes, alignment);
+            };
+
+            bool is_equal(const memory_resource& other) const
+            {
+                return do_is_equal(other);
+            };
+
+            //true if deallocate() is a no-op and the memory only comes back all at once
+            bool releases_in_bulk() const
+            {
+                return do_releases_in_bulk();
+            };
+
+        protected:
+            virtual void* do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+            virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) = 0;
+
+            virtual bool do_is_equal(const memory_resource& other) const
+            {
+                return this == &other;
+            };
+
+            virtual bool do_releases_in_bulk() const
+            {
+                return false;
+            };
+    };
+
+    inline bool operator==(const memory_resource& lhs, const memory_resource& rhs)
+    {
+        return &lhs == &rhs || lhs.is_equal(rhs);
+    };
+
+    inline bool operator!=(const memory_resource& lhs, const memory_resource& rhs)
+    {
+        return !(lhs == rhs);
+    };
+
+    //operator new, or posix_memalign for alignments it does not guarantee
+    class new_delete_resource_type: public memory_resource
+    {
+        protected:
+            virtual void* do_allocate(std::size_t bytes, std::size_t alignment)
+            {
+                if (alignment <= maxAlign)
+                    return ::operator new(bytes);
+                void* p = NULL;
+                if (posix_memalign(&p, alignment, bytes))
+                    throw std::bad_alloc();
+                return p;
+            };
+
+            virtual void do_deallocate(void* p, std::size_t, std::size_t alignment)
+            {
+                if (alignment <= maxAlign)
+                    ::operator delete(p);
+                else
+                    free(p);
+            };
+
+            virtual bool do_is_equal(const memory_resource& other) const
+            {
+                return dynamic_cast<const new_delete_resource_type*>(&other) != NULL;
+            };
+    };
+
+    inline memory_resource* new_delete_resource()
+    {
+        static new_delete_resource_type resource;
+        return &resource;
+    };
+
+    inline memory_resource*& defaultResource()
+    {
+        static memory_resource* resource = new_delete_resource();
+        return resource;
+    };
+
+    inline memory_resource* get_default_resource()
+    {
+        return __atomic_load_n(&defaultResource(), __ATOMIC_ACQUIRE);
+    };
+
+    //the previous default; NULL restores new_delete_resource()
+    inline memory_resource* set_default_resource(memory_resource* resource)
+    {
+        if (!resource)
+            resource = new_delete_resource();
+        return __atomic_exchange_n(&defaultResource(), resource, __ATOMIC_ACQ_REL);
+    };
+
+    inline std::size_t alignUp(std::size_t n, std::size_t alignment)
+    {
+        return (n + alignment - 1) & ~(alignment - 1);
+    };
+
+    // Bump allocator: each allocation takes the next bytes of the current buffer
+    // and deallocate() does nothing. When the buffer runs out a bigger one (twice
+    // the last) comes from upstream; release() or the destructor hands them all
+    // back at once. Not thread-safe, one arena per request or per thread.
+    class monotonic_buffer_resource: public memory_resource
+    {
+        //at the start of every buffer taken from upstream
+        struct chunk
+        {
+            chunk* next;
+            std::size_t bytes;
+            std::size_t alignment;
+        };
+
+        memory_resource* _upstream;
+        char* _initial;
+        std::size_t _initialSize;
+        char* _current;
+        std::size_t _left;
+        std::size_t _nextSize;
+        chunk* _chunks;
+
+        monotonic_buffer_resource(monotonic_buffer_resource const &);
+        monotonic_buffer_resource& operator=(monotonic_buffer_resource const &);
+
+        static const std::size_t firstSize = 1024;
+
+        void grow(std::size_t bytes, std::size_t alignment)
+        {
+            std::size_t chunkAlign = alignment > maxAlign ? alignment : maxAlign;
+            std::size_t header = alignUp(sizeof(chunk), chunkAlign);
+            std::size_t size = this->_nextSize;
+            while (size < header + bytes)
+                size *= 2;
+            chunk* c = static_cast<chunk*>(this->_upstream->allocate(size, chunkAlign));
+            c->next = this->_chunks;
+            c->bytes = size;
+            c->alignment = chunkAlign;
+            this->_chunks = c;
+            this->_current = reinterpret_cast<char*>(c) + header;
+            this->_left = size - header;
+            this->_nextSize = size * 2;
+        };
+
+        protected:
+            virtual void* do_allocate(std::size_t bytes, std::size_t alignment)
+            {
+                if (!bytes)
+                    bytes = 1;
+                std::size_t skip = alignUp(reinterpret_cast<uintptr_t>(this->_current), alignment) - reinterpret_cast<uintptr_t>(this->_current);
+                if (!this->_current || skip + bytes > this->_left)
+                {
+                    grow(bytes, alignment);
+                    skip = 0;
+                }
+                char* p = this->_current + skip;
+                this->_current = p + bytes;
+                this->_left -= skip + bytes;
+                return p;
+            };
+
+            virtual void do_deallocate(void*, std::size_t, std::size_t) {};
+
+            virtual bool do_releases_in_bulk() const
+            {
+                return true;
+            };
+
+        public:
+            explicit monotonic_buffer_resource(memory_resource* upstream = get_default_resource()):
+            _upstream(upstream), _initial(NULL), _initialSize(0), _current(NULL), _left(0), _nextSize(firstSize), _chunks(NULL) {};
+
+            monotonic_buffer_resource(std::size_t initialSize, memory_resource* upstream = get_default_resource()):
+            _upstream(upstream), _initial(NULL), _initialSize(0), _current(NULL), _left(0), _nextSize(initialSize > firstSize ? initialSize : firstSize), _chunks(NULL) {};
+
+            //starts in buffer, which stays owned by the caller
+            monotonic_buffer_resource(void* buffer, std::size_t size, memory_resource* upstream = get_default_resource()):
+            _upstream(upstream), _initial(static_cast<char*>(buffer)), _initialSize(size), _current(static_cast<char*>(buffer)), _left(size),
+            _nextSize(size > firstSize ? size * 2 : firstSize), _chunks(NULL) {};
+
+            ~monotonic_buffer_resource()
+            {
+                release();
+            };
+
+            //frees everything allocated so far, even what containers still point to
+            void release()
+            {
+                while (this->_chunks)
+                {
+                    chunk* c = this->_chunks;
+                    this->_chunks = c->next;
+                    this->_upstream->deallocate(c, c->bytes, c->alignment);
+                }
+                this->_current = this->_initial;
+                this->_left = this->_initialSize;
+            };
+
+            memory_resource* upstream_resource() const
+            {
+                return this->_upstream;
+            };
+    };
+
+    // Free lists for power-of-two block sizes from 8 to maxBlock bytes, refilled
+    // from upstream a chunk at a time, so freed blocks are reused and a container
+    // that grows and shrinks stays in the same memory. Bigger requests go straight
+    // to upstream. release() or the destructor frees everything. Not thread-safe.
+    class unsynchronized_pool_resource: public memory_resource
+    {
+        //at the end of every chunk and of every oversized block
+        struct chunk
+        {
+            chunk* prev;
+            chunk* next;
+            std::size_t bytes;
+            std::size_t alignment;
+        };
+
+        struct free_block
+        {
+            free_block* next;
+        };
+
+        struct pool
+        {
+            free_block* free;
+            std::size_t nextBlocks;
+        };
+
+        static const std::size_t minShift = 3;
+        static const std::size_t pools = 10;
+        static const std::size_t firstBlocks = 16;
+        static const std::size_t maxBlocks = 1024;
+
+        memory_resource* _upstream;
+        pool _pools[pools];
+        chunk* _chunks;
+        chunk* _large;
+
+        unsynchronized_pool_resource(unsynchronized_pool_resource const &);
+        unsynchronized_pool_resource& operator=(unsynchronized_pool_resource const &);
+
+        //the pool whose blocks fit bytes at alignment, pools if none does
+        static std::size_t poolIndex(std::size_t bytes, std::size_t alignment)
+        {
+            if (bytes < alignment)
+                bytes = alignment;
+            std::size_t index = 0;
+            while (index < pools && (static_cast<std::size_t>(1) << (index + minShift)) < bytes)
+                ++index;
+            return index;
+        };
+
+        static std::size_t blockSize(std::size_t index)
+        {
+            return static_cast<std::size_t>(1) << (index + minShift);
+        };
+
+        //upstream memory of bytes usable bytes followed by its record, linked into list
+        void* take(chunk*& list, std::size_t bytes, std::size_t alignment)
+        {
+            if (alignment < maxAlign)
+                alignment = maxAlign;
+            bytes = alignUp(bytes, __alignof__(chunk));
+            std::size_t total = bytes + sizeof(chunk);
+            char* p = static_cast<char*>(this->_upstream->allocate(total, alignment));
+            chunk* c = reinterpret_cast<chunk*>(p + bytes);
+            c->prev = NULL;
+            c->next = list;
+            c->bytes = total;
+            c->alignment = alignment;
+            if (list)
+                list->prev = c;
+            list = c;
+            return p;
+        };
+
+        void give(chunk*& list, chunk* c)
+        {
+            if (c->prev)
+                c->prev->next = c->next;
+            else
+                list = c->next;
+            if (c->next)
+                c->next->prev = c->prev;
+            this->_upstream->deallocate(reinterpret_cast<char*>(c) + sizeof(chunk) - c->bytes, c->bytes, c->alignment);
+        };
+
+        void refill(std::size_t index)
+        {
+            pool& p = this->_pools[index];
+            std::size_t size = blockSize(index);
+            char* blocks = static_cast<char*>(take(this->_chunks, size * p.nextBlocks, size));
+            for (std::size_t i = p.nextBlocks; i > 0; --i)
+            {
+                free_block* b = reinterpret_cast<free_block*>(blocks + (i - 1) * size);
+                b->next = p.free;
+                p.free = b;
+            }
+            if (p.nextBlocks < maxBlocks)
+                p.nextBlocks *= 2;
+        };
+
+        protected:
+            virtual void* do_allocate(std::size_t bytes, std::size_t alignment)
+            {
+                std::size_t index = poolIndex(bytes, alignment);
+                if (index == pools)
+                    return take(this->_large, bytes, alignment);
+                pool& p = this->_pools[index];
+                if (!p.free)
+                    refill(index);
+                free_block* b = p.free;
+                p.free = b->next;
+                return b;
+            };
+
+            virtual void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment)
+            {
+                if (!ptr)
+                    return ;
+                std::size_t index = poolIndex(bytes, alignment);
+                if (index == pools)
+                {
+                    give(this->_large, reinterpret_cast<chunk*>(static_cast<char*>(ptr) + alignUp(bytes, __alignof__(chunk))));
+                    return ;
+                }
+                free_block* b = static_cast<free_block*>(ptr);
+                b->next = this->_pools[index].free;
+                this->_pools[index].free = b;
+            };
+
+        public:
+            explicit unsynchronized_pool_resource(memory_resource* upstream = get_default_resource()): _upstream(upstream), _chunks(NULL), _large(NULL)
+            {
+                for (std::size_t i = 0; i < pools; ++i)
+                {
+                    this->_pools[i].free = NULL;
+                    this->_pools[i].nextBlocks = firstBlocks;
+                }
+            };
+
+            ~unsynchronized_pool_resource()
+            {
+                release();
+            };
+
+            void release()
+            {
+                while (this->_chunks)
+                    give(this->_chunks, this->_chunks);
+                while (this->_large)
+                    give(this->_large, this->_large);
+                for (std::size_t i = 0; i < pools; ++i)
+                {
+                    this->_pools[i].free = NULL;
+                    this->_pools[i].nextBlocks = firstBlocks;
+                }
+            };
+
+            //the biggest request served from the pools
+            static std::size_t max_block()
+            {
+                return blockSize(pools - 1);
+            };
+
+            memory_resource* upstream_resource() const
+            {
+                return this->_upstream;
+            };
+    };
+
+    // Allocator for the ft containers that draws from a memory_resource picked at
+    // run time. Copies and rebinds keep the resource, so a map's nodes come from
+    // the resource its allocator was built with. The resource must outlive every
+    // container using it.
+    template <class T>
+    class polymorphic_allocator
+    {
+        memory_resource* _resource;
+
+        template <class U>
+        friend class polymorphic_allocator;
+
+        public:
+            typedef T value_type;
+            typedef T* pointer;
+            typedef const T* const_pointer;
+            typedef T& reference;
+            typedef const T& const_reference;
+            typedef std::size_t size_type;
+            typedef std::ptrdiff_t difference_type;
+
+            template <class U>
+            struct rebind
+            {
+                typedef polymorphic_allocator<U> other;
+            };
+
+            polymorphic_allocator(): _resource(get_default_resource()) {};
+
+            polymorphic_allocator(memory_resource* resource): _resource(resource) {};
+
+            polymorphic_allocator(const polymorphic_allocator& copy): _resource(copy._resource) {};
+
+            template <class U>
+            polymorphic_allocator(const polymorphic_allocator<U>& copy): _resource(copy._resource) {};
+
+            polymorphic_allocator& operator=(const polymorphic_allocator& source)
+            {
+                this->_resource = source._resource;
+                return *this;
+            };
+
+            pointer allocate(size_type n, const void* = 0)
+            {
+                if (n > max_size())
+                    throw std::bad_alloc();
+                return static_cast<pointer>(this->_resource->allocate(n * sizeof(T), __alignof__(T)));
+            };
+
+            void deallocate(pointer p, size_type n)
+            {
+                this->_resource->deallocate(p, n * sizeof(T), __alignof__(T));
+            };
+
+            void construct(pointer p, const_reference value)
+            {
+                new (static_cast<void*>(p)) T(value);
+            };
+
+            void destroy(pointer p)
+            {
+                p->~T();
+            };
+
+            pointer address(reference x) const
+            {
+                return &x;
+            };
+
+            const_pointer address(const_reference x) const
+            {
+                return &x;
+            };
+
+            size_type max_size() const
+            {
+                return static_cast<size_type>(-1) / sizeof(T);
+            };
+
+            memory_resource* resource() const
+            {
+                return this->_resource;
+            };
+
+            bool releases_in_bulk() const
+            {
+                return this->_resource->releases_in_bulk();
+            };
+    };
+
+    template <class T, class U>
+    bool operator==(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs)
+    {
+        return *lhs.resource() == *rhs.resource();
+    };
+
+    template <class T, class U>
+    bool operator!=(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs)
+    {
+        return !(lhs == rhs);
+    };
+
+    template <class T>
+    bool releasesInBulk(const polymorphic_allocator<T>& alloc)
+    {
+        return alloc.releases_in_bulk();
+    };
+}
+
+#endif
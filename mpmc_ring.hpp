@@ -0,0 +1,162 @@
+#ifndef MPMC_RING_HPP
+# define MPMC_RING_HPP
+
+#include <memory>
+#include <cstddef>
+#include "concurrency.hpp"
+
+namespace ft
+{
+    // Bounded lock-free multi-producer/multi-consumer queue (Vyukov's ring).
+    // Every cell carries a sequence number telling whether it is free for the
+    // producer of position pos (sequence == pos) or holds the value for the
+    // consumer of pos (sequence == pos + 1). The enqueue and dequeue positions
+    // live on separate cache lines so producers and consumers do not share one.
+    template <class T, class Alloc = std::allocator<T> >
+    class mpmc_ring
+    {
+        public:
+            typedef T value_type;
+            typedef Alloc allocator_type;
+            typedef std::size_t size_type;
+
+        private:
+            struct cell
+            {
+                size_type sequence;
+                T value;
+            };
+
+            typedef typename Alloc::template rebind<cell>::other cell_alloc;
+
+            cell* _buffer;
+            size_type _mask;
+            allocator_type _allocator;
+            cell_alloc _cellAllocator;
+            size_type _enqueue __attribute__((aligned(FT_CACHE_LINE)));
+            size_type _dequeue __attribute__((aligned(FT_CACHE_LINE)));
+
+            mpmc_ring(mpmc_ring const &);
+            mpmc_ring& operator=(mpmc_ring const &);
+
+            cell& at(size_type pos)
+            {
+                return this->_buffer[pos & this->_mask];
+            };
+
+            size_type sequence(size_type pos)
+            {
+                return __atomic_load_n(&at(pos).sequence, __ATOMIC_ACQUIRE);
+            };
+
+            //claims up to n consecutive positions whose cells have sequence pos + i + offset,
+            //offset being 0 for producers and 1 for consumers; returns how many were taken from *first
+            size_type claim(size_type* position, size_type n, size_type offset, size_type* first)
+            {
+                size_type pos = __atomic_load_n(position, __ATOMIC_RELAXED);
+                while (true)
+                {
+                    size_type count = 0;
+                    while (count < n && sequence(pos + count) == pos + count + offset)
+                        ++count;
+                    if (!count)
+                    {
+                        //a lap behind: full for producers, empty for consumers
+                        if (static_cast<std::ptrdiff_t>(sequence(pos) - (pos + offset)) < 0)
+                            return 0;
+                        pos = __atomic_load_n(position, __ATOMIC_RELAXED);
+                        continue ;
+                    }
+                    if (__atomic_compare_exchange_n(position, &pos, pos + count, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    {
+                        *first = pos;
+                        return count;
+                    }
+                }
+            };
+
+        public:
+            //the capacity is rounded up to a power of two
+            explicit mpmc_ring(size_type capacity, const allocator_type& alloc = allocator_type()):
+            _buffer(NULL), _mask(0), _allocator(alloc), _cellAllocator(alloc), _enqueue(0), _dequeue(0)
+            {
+                size_type size = 2;
+                while (size < capacity)
+                    size <<= 1;
+                this->_mask = size - 1;
+                this->_buffer = this->_cellAllocator.allocate(size);
+                for (size_type i = 0; i < size; ++i)
+                    this->_buffer[i].sequence = i;
+            };
+
+            ~mpmc_ring()
+            {
+                for (size_type pos = this->_dequeue; pos != this->_enqueue; ++pos)
+                    this->_allocator.destroy(&at(pos).value);
+                this->_cellAllocator.deallocate(this->_buffer, this->_mask + 1);
+            };
+
+            //false if the ring is full
+            bool try_push(const value_type& value)
+            {
+                return try_push_n(&value, 1) == 1;
+            };
+
+            //pushes up to n values from first with a single claim, returns how many went in
+            template <class InputIt>
+            size_type try_push_n(InputIt first, size_type n)
+            {
+                size_type pos = 0;
+                n = claim(&this->_enqueue, n, 0, &pos);
+                for (size_type i = 0; i < n; ++i, ++first)
+                {
+                    cell& c = at(pos + i);
+                    this->_allocator.construct(&c.value, *first);
+                    __atomic_store_n(&c.sequence, pos + i + 1, __ATOMIC_RELEASE);
+                }
+                return n;
+            };
+
+            //false if the ring is empty
+            bool try_pop(value_type& value)
+            {
+                return try_pop_n(&value, 1) == 1;
+            };
+
+            //pops up to n values into out with a single claim, returns how many came out
+            template <class OutputIt>
+            size_type try_pop_n(OutputIt out, size_type n)
+            {
+                size_type pos = 0;
+                n = claim(&this->_dequeue, n, 1, &pos);
+                for (size_type i = 0; i < n; ++i, ++out)
+                {
+                    cell& c = at(pos + i);
+                    *out = c.value;
+                    this->_allocator.destroy(&c.value);
+                    __atomic_store_n(&c.sequence, pos + i + this->_mask + 1, __ATOMIC_RELEASE);
+                }
+                return n;
+            };
+
+            size_type capacity() const
+            {
+                return this->_mask + 1;
+            };
+
+            //only a hint while other threads are pushing or popping
+            size_type size() const
+            {
+                size_type dequeue = __atomic_load_n(&this->_dequeue, __ATOMIC_RELAXED);
+                size_type enqueue = __atomic_load_n(&this->_enqueue, __ATOMIC_RELAXED);
+                return enqueue > dequeue ? enqueue - dequeue : 0;
+            };
+
+            allocator_type get_allocator() const
+            {
+                return this->_allocator;
+            };
+    };
+}
+
+#endif
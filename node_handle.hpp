@@ -0,0 +1,122 @@
+#ifndef NODE_HANDLE_HPP
+# define NODE_HANDLE_HPP
+
+#include <memory>
+#include "RBtree.hpp"
+#include "utils.hpp"
+
+namespace ft
+{
+    //owns a node extracted from a map or a set until it is inserted again;
+    //as there is no move in C++98, copying a handle hands the node over and empties the source
+    template <class Node, class Alloc>
+    class node_handle
+    {
+        public:
+            typedef Alloc allocator_type;
+
+        protected:
+            mutable Node* _node;
+            allocator_type _allocator;
+
+        public:
+            node_handle(): _node(NULL), _allocator(allocator_type()) {};
+
+            node_handle(Node* node, allocator_type const & alloc): _node(node), _allocator(alloc) {};
+
+            node_handle(node_handle const & copy): _node(copy._node), _allocator(copy._allocator)
+            {
+                copy._node = NULL;
+            };
+
+            node_handle& operator=(node_handle const & source)
+            {
+                if (this == &source)
+                    return *this;
+                reset();
+                this->_node = source._node;
+                this->_allocator = source._allocator;
+                source._node = NULL;
+                return *this;
+            };
+
+            ~node_handle()
+            {
+                reset();
+            };
+
+            bool empty() const
+            {
+                return this->_node == NULL;
+            };
+
+            allocator_type get_allocator() const
+            {
+                return this->_allocator;
+            };
+
+            Node* get() const
+            {
+                return this->_node;
+            };
+
+            //gives the node back to a container, the handle is left empty
+            Node* release() const
+            {
+                Node* node = this->_node;
+                this->_node = NULL;
+                return node;
+            };
+
+        private:
+            void reset()
+            {
+                if (!this->_node)
+                    return ;
+                FT_STATS(stats_registry::treeNodes(-1, -static_cast<long long>(sizeof(Node))));
+                this->_allocator.destroy(this->_node);
+                this->_allocator.deallocate(this->_node, 1);
+                this->_node = NULL;
+            };
+    };
+
+    template <class Key, class T, class Alloc>
+    class map_node_handle: public node_handle<Node<ft::pair<const Key, T> >, Alloc>
+    {
+        public:
+            typedef Key key_type;
+            typedef T mapped_type;
+
+            map_node_handle() {};
+
+            map_node_handle(Node<ft::pair<const Key, T> >* node, Alloc const & alloc): node_handle<Node<ft::pair<const Key, T> >, Alloc>(node, alloc) {};
+
+            const key_type& key() const
+            {
+                return this->_node->pair.first;
+            };
+
+            mapped_type& mapped() const
+            {
+                return this->_node->pair.second;
+            };
+    };
+
+    template <class Key, class Alloc>
+    class set_node_handle: public node_handle<Node<Key>, Alloc>
+    {
+        public:
+            typedef Key value_type;
+
+            set_node_handle() {};
+
+            set_node_handle(Node<Key>* node, Alloc const & alloc): node_handle<Node<Key>, Alloc>(node, alloc) {};
+
+            value_type& value() const
+            {
+                return this->_node->pair;
+            };
+    };
+}
+
+#endif
@@ -0,0 +1,770 @@
+#ifndef PARALLEL_HPP
+# define PARALLEL_HPP
+
+#include "utils.hpp"
+#include "vector.hpp"
+#include "ft_iterator_traits.hpp"
+#include "thread_pool.hpp"
+#include "RBtree.hpp"
+
+namespace ft
+{
+    template <class Key, class T, class Compare, class Alloc>
+    class map;
+
+    template <class Key, class Compare, class Alloc>
+    class set;
+
+    // Algorithms over random access ranges (ft::vector iterators, pointers) run on
+    // a thread_pool, thread_pool::shared() unless one is passed. Ranges are split
+    // in halves until a piece holds at most grainSize elements; smaller ranges and
+    // one-thread pools run sequentially. Functions and comparators are shared by
+    // all threads, so they must be safe to call concurrently.
+    namespace parallel
+    {
+        static const std::ptrdiff_t grainSize = 1 << 12;
+
+        /*splitting*/
+        template <class Body>
+        struct range_task
+        {
+            Body* body;
+            std::ptrdiff_t begin;
+            std::ptrdiff_t end;
+            thread_pool* pool;
+        };
+
+        template <class Body>
+        void splitRange(thread_pool& pool, Body& body, std::ptrdiff_t begin, std::ptrdiff_t end);
+
+        template <class Body>
+        void runRange(void* arg)
+        {
+            range_task<Body>* task = static_cast<range_task<Body>*>(arg);
+            splitRange(*task->pool, *task->body, task->begin, task->end);
+        };
+
+        //hands the upper halves to the pool and runs the last piece itself
+        template <class Body>
+        void splitRange(thread_pool& pool, Body& body, std::ptrdiff_t begin, std::ptrdiff_t end)
+        {
+            task_group group;
+            range_task<Body> tasks[sizeof(std::ptrdiff_t) * 8];
+            int spawned = 0;
+            while (end - begin > grainSize)
+            {
+                std::ptrdiff_t mid = begin + (end - begin) / 2;
+                range_task<Body> task = { &body, mid, end, &pool };
+                tasks[spawned] = task;
+                pool.spawn(group, runRange<Body>, &tasks[spawned++]);
+                end = mid;
+            }
+            body(begin, end);
+            pool.wait(group);
+        };
+
+        template <class Body>
+        void run(thread_pool& pool, Body& body, std::ptrdiff_t n)
+        {
+            if (n <= grainSize || pool.size() == 1)
+                body(0, n);
+            else
+                splitRange(pool, body, 0, n);
+        };
+
+        /*for_each, transform, fill*/
+        template <class It, class F>
+        struct for_each_body
+        {
+            It first;
+            F* f;
+
+            void operator()(std::ptrdiff_t begin, std::ptrdiff_t end)
+            {
+                for (It it = this->first + begin; begin < end; ++begin, ++it)
+                    (*this->f)(*it);
+            };
+        };
+
+        template <class It, class Out, class F>
+        struct transform_body
+        {
+            It first;
+            Out out;
+            F* f;
+
+            void operator()(std::ptrdiff_t begin, std::ptrdiff_t end)
+            {
+                It it = this->first + begin;
+                for (Out dst = this->out + begin; begin < end; ++begin, ++it, ++dst)
+                    *dst = (*this->f)(*it);
+            };
+        };
+
+        template <class It, class T>
+        struct fill_body
+        {
+            It first;
+            const T* value;
+
+            void operator()(std::ptrdiff_t begin, std::ptrdiff_t end)
+            {
+                for (It it = this->first + begin; begin < end; ++begin, ++it)
+                    *it = *this->value;
+            };
+        };
+
+        template <class It, class F>
+        void for_each(It first, It last, F f, thread_pool& pool)
+        {
+            for_each_body<It, F> body = { first, &f };
+            run(pool, body, last - first);
+        };
+
+        template <class It, class F>
+        void for_each(It first, It last, F f)
+        {
+            parallel::for_each(first, last, f, thread_pool::shared());
+        };
+
+        //out must be random access and may be first
+        template <class It, class Out, class F>
+        Out transform(It first, It last, Out out, F f, thread_pool& pool)
+        {
+            transform_body<It, Out, F> body = { first, out, &f };
+            run(pool, body, last - first);
+            return out + (last - first);
+        };
+
+        template <class It, class Out, class F>
+        Out transform(It first, It last, Out out, F f)
+        {
+            return parallel::transform(first, last, out, f, thread_pool::shared());
+        };
+
+        template <class It, class T>
+        void fill(It first, It last, const T& value, thread_pool& pool)
+        {
+            fill_body<It, T> body = { first, &value };
+            run(pool, body, last - first);
+        };
+
+        template <class It, class T>
+        void fill(It first, It last, const T& value)
+        {
+            parallel::fill(first, last, value, thread_pool::shared());
+        };
+
+        /*reduce*/
+        template <class It, class T, class Op>
+        T reduceRange(thread_pool& pool, It first, std::ptrdiff_t n, Op& op);
+
+        template <class It, class T, class Op>
+        struct reduce_task
+        {
+            It first;
+            std::ptrdiff_t n;
+            Op* op;
+            thread_pool* pool;
+            T value;
+
+            reduce_task(It first, std::ptrdiff_t n, Op* op, thread_pool* pool): first(first), n(n), op(op), pool(pool), value(*first) {};
+
+            static void run(void* arg)
+            {
+                reduce_task* task = static_cast<reduce_task*>(arg);
+                task->value = reduceRange<It, T, Op>(*task->pool, task->first, task->n, *task->op);
+            };
+        };
+
+        //n > 0; partial results are combined left to right, so op need not commute
+        template <class It, class T, class Op>
+        T reduceRange(thread_pool& pool, It first, std::ptrdiff_t n, Op& op)
+        {
+            if (n <= grainSize || pool.size() == 1)
+            {
+                T acc = *first;
+                for (++first; --n; ++first)
+                    acc = op(acc, *first);
+                return acc;
+            }
+            task_group group;
+            std::ptrdiff_t half = n / 2;
+            reduce_task<It, T, Op> right(first + half, n - half, &op, &pool);
+            pool.spawn(group, reduce_task<It, T, Op>::run, &right);
+            T left = reduceRange<It, T, Op>(pool, first, half, op);
+            pool.wait(group);
+            return op(left, right.value);
+        };
+
+        //op must be associative
+        template <class It, class T, class Op>
+        T reduce(It first, It last, T init, Op op, thread_pool& pool)
+        {
+            if (first == last)
+                return init;
+            return op(init, reduceRange<It, T, Op>(pool, first, last - first, op));
+        };
+
+        template <class It, class T, class Op>
+        T reduce(It first, It last, T init, Op op)
+        {
+            return parallel::reduce(first, last, init, op, thread_pool::shared());
+        };
+
+        template <class T>
+        struct plus
+        {
+            T operator()(const T& lhs, const T& rhs) const
+            {
+                return lhs + rhs;
+            };
+        };
+
+        template <class It, class T>
+        T reduce(It first, It last, T init)
+        {
+            return parallel::reduce(first, last, init, plus<T>(), thread_pool::shared());
+        };
+
+        /*sort*/
+        template <class It, class Compare>
+        void insertionSort(It first, std::ptrdiff_t n, Compare& comp)
+        {
+            typedef typename ft::iterator_traits<It>::value_type value_type;
+            for (std::ptrdiff_t i = 1; i < n; ++i)
+            {
+                value_type tmp = *(first + i);
+                std::ptrdiff_t j = i;
+                for (; j > 0 && comp(tmp, *(first + j - 1)); --j)
+                    *(first + j) = *(first + j - 1);
+                *(first + j) = tmp;
+            }
+        };
+
+        //on ties the element of a comes first, which keeps the sort stable
+        template <class In, class Out, class Compare>
+        void mergeRuns(In a, std::ptrdiff_t na, In b, std::ptrdiff_t nb, Out out, Compare& comp)
+        {
+            std::ptrdiff_t i = 0;
+            std::ptrdiff_t j = 0;
+            while (i < na && j < nb)
+            {
+                if (comp(*(b + j), *(a + i)))
+                    *out++ = *(b + j++);
+                else
+                    *out++ = *(a + i++);
+            }
+            for (; i < na; ++i)
+                *out++ = *(a + i);
+            for (; j < nb; ++j)
+                *out++ = *(b + j);
+        };
+
+        template <class In, class Out, class Compare>
+        void mergePass(In in, std::ptrdiff_t n, Out out, std::ptrdiff_t width, Compare& comp)
+        {
+            for (std::ptrdiff_t begin = 0; begin < n; begin += 2 * width)
+            {
+                std::ptrdiff_t mid = begin + width < n ? begin + width : n;
+                std::ptrdiff_t end = mid + width < n ? mid + width : n;
+                mergeRuns(in + begin, mid - begin, in + mid, end - mid, out + begin, comp);
+            }
+        };
+
+        //bottom-up merge sort, buf is scratch space of the same length
+        template <class It, class Buf, class Compare>
+        void sequentialSort(It first, std::ptrdiff_t n, Buf buf, Compare& comp)
+        {
+            const std::ptrdiff_t run = 32;
+            for (std::ptrdiff_t begin = 0; begin < n; begin += run)
+                insertionSort(first + begin, n - begin < run ? n - begin : run, comp);
+            bool inBuf = false;
+            for (std::ptrdiff_t width = run; width < n; width *= 2)
+            {
+                if (inBuf)
+                    mergePass(buf, n, first, width, comp);
+                else
+                    mergePass(first, n, buf, width, comp);
+                inBuf = !inBuf;
+            }
+            if (inBuf)
+                for (std::ptrdiff_t i = 0; i < n; ++i)
+                    *(first + i) = *(buf + i);
+        };
+
+        template <class In, class Compare>
+        std::ptrdiff_t lowerIndex(In first, std::ptrdiff_t n, const typename ft::iterator_traits<In>::value_type& value, Compare& comp)
+        {
+            std::ptrdiff_t lo = 0;
+            while (lo < n)
+            {
+                std::ptrdiff_t mid = lo + (n - lo) / 2;
+                if (comp(*(first + mid), value))
+                    lo = mid + 1;
+                else
+                    n = mid;
+            }
+            return lo;
+        };
+
+        template <class In, class Compare>
+        std::ptrdiff_t upperIndex(In first, std::ptrdiff_t n, const typename ft::iterator_traits<In>::value_type& value, Compare& comp)
+        {
+            std::ptrdiff_t lo = 0;
+            while (lo < n)
+            {
+                std::ptrdiff_t mid = lo + (n - lo) / 2;
+                if (comp(value, *(first + mid)))
+                    n = mid;
+                else
+                    lo = mid + 1;
+            }
+            return lo;
+        };
+
+        template <class In, class Out, class Compare>
+        void parallelMerge(thread_pool& pool, In a, std::ptrdiff_t na, In b, std::ptrdiff_t nb, Out out, Compare& comp);
+
+        template <class In, class Out, class Compare>
+        struct merge_task
+        {
+            In a;
+            std::ptrdiff_t na;
+            In b;
+            std::ptrdiff_t nb;
+            Out out;
+            Compare* comp;
+            thread_pool* pool;
+
+            static void run(void* arg)
+            {
+                merge_task* task = static_cast<merge_task*>(arg);
+                parallelMerge(*task->pool, task->a, task->na, task->b, task->nb, task->out, *task->comp);
+            };
+        };
+
+        // Splits around the middle of the longer run and the matching position in
+        // the other one, then merges the two halves concurrently. Ties stay on the
+        // side of a, so the result matches mergeRuns.
+        template <class In, class Out, class Compare>
+        void parallelMerge(thread_pool& pool, In a, std::ptrdiff_t na, In b, std::ptrdiff_t nb, Out out, Compare& comp)
+        {
+            if (na + nb <= grainSize)
+            {
+                mergeRuns(a, na, b, nb, out, comp);
+                return ;
+            }
+            std::ptrdiff_t i;
+            std::ptrdiff_t j;
+            if (na >= nb)
+            {
+                i = na / 2;
+                j = lowerIndex(b, nb, *(a + i), comp);
+            }
+            else
+            {
+                j = nb / 2;
+                i = upperIndex(a, na, *(b + j), comp);
+            }
+            task_group group;
+            merge_task<In, Out, Compare> upper = { a + i, na - i, b + j, nb - j, out + (i + j), &comp, &pool };
+            pool.spawn(group, merge_task<In, Out, Compare>::run, &upper);
+            parallelMerge(pool, a, i, b, j, out, comp);
+            pool.wait(group);
+        };
+
+        template <class It, class Buf, class Compare>
+        void sortInto(thread_pool& pool, It src, std::ptrdiff_t n, Buf dst, bool toDst, Compare& comp);
+
+        template <class It, class Buf, class Compare>
+        struct sort_task
+        {
+            It src;
+            std::ptrdiff_t n;
+            Buf dst;
+            bool toDst;
+            Compare* comp;
+            thread_pool* pool;
+
+            static void run(void* arg)
+            {
+                sort_task* task = static_cast<sort_task*>(arg);
+                sortInto(*task->pool, task->src, task->n, task->dst, task->toDst, *task->comp);
+            };
+        };
+
+        //sorts src, leaving the result in dst if toDst and in src otherwise
+        template <class It, class Buf, class Compare>
+        void sortInto(thread_pool& pool, It src, std::ptrdiff_t n, Buf dst, bool toDst, Compare& comp)
+        {
+            if (n <= grainSize)
+            {
+                sequentialSort(src, n, dst, comp);
+                if (toDst)
+                    for (std::ptrdiff_t i = 0; i < n; ++i)
+                        *(dst + i) = *(src + i);
+                return ;
+            }
+            std::ptrdiff_t half = n / 2;
+            task_group group;
+            sort_task<It, Buf, Compare> upper = { src + half, n - half, dst + half, !toDst, &comp, &pool };
+            pool.spawn(group, sort_task<It, Buf, Compare>::run, &upper);
+            sortInto(pool, src, half, dst, !toDst, comp);
+            pool.wait(group);
+            if (toDst)
+                parallelMerge(pool, src, half, src + half, n - half, dst, comp);
+            else
+                parallelMerge(pool, dst, half, dst + half, n - half, src, comp);
+        };
+
+        //stable merge sort, needs a scratch copy of the range
+        template <class It, class Compare>
+        void sort(It first, It last, Compare comp, thread_pool& pool)
+        {
+            typedef typename ft::iterator_traits<It>::value_type value_type;
+            std::ptrdiff_t n = last - first;
+            if (n < 2)
+                return ;
+            ft::vector<value_type> buffer(first, last);
+            if (n <= grainSize || pool.size() == 1)
+                sequentialSort(first, n, buffer.begin(), comp);
+            else
+                sortInto(pool, first, n, buffer.begin(), false, comp);
+        };
+
+        template <class It, class Compare>
+        void sort(It first, It last, Compare comp)
+        {
+            parallel::sort(first, last, comp, thread_pool::shared());
+        };
+
+        template <class It>
+        void sort(It first, It last)
+        {
+            parallel::sort(first, last, ft::less<typename ft::iterator_traits<It>::value_type>(), thread_pool::shared());
+        };
+
+        /*map and set*/
+        //the tree behind a container, found from its first node
+        template <class Container>
+        typename Container::node_ptr rootOf(Container& container)
+        {
+            return ft::treeRoot(container.begin().getNode());
+        };
+
+        template <class Value, class NodePtr, class F>
+        void visitSubtree(thread_pool& pool, NodePtr node, F& f);
+
+        template <class Value, class NodePtr, class F>
+        struct visit_task
+        {
+            NodePtr node;
+            F* f;
+            thread_pool* pool;
+
+            static void run(void* arg)
+            {
+                visit_task* task = static_cast<visit_task*>(arg);
+                visitSubtree<Value>(*task->pool, task->node, *task->f);
+            };
+        };
+
+        //hands the right subtrees near the root to the pool while walking down the left spine
+        template <class Value, class NodePtr, class F>
+        void visitSubtree(thread_pool& pool, NodePtr node, F& f)
+        {
+            task_group group;
+            visit_task<Value, NodePtr, F> tasks[sizeof(std::size_t) * 16];
+            int spawned = 0;
+            while (node && ft::treeSize(node) > static_cast<std::size_t>(grainSize) && pool.size() > 1)
+            {
+                if (node->right)
+                {
+                    visit_task<Value, NodePtr, F> task = { node->right, &f, &pool };
+                    tasks[spawned] = task;
+                    pool.spawn(group, visit_task<Value, NodePtr, F>::run, &tasks[spawned++]);
+                }
+                f(static_cast<Value&>(node->pair));
+                node = node->left;
+            }
+            if (node)
+            {
+                NodePtr it = ft::treeMin(node);
+                for (std::size_t n = ft::treeSize(node); n; --n, it = ft::treeNext(it))
+                    f(static_cast<Value&>(it->pair));
+            }
+            pool.wait(group);
+        };
+
+        template <class Value, class NodePtr, class T, class Fold, class Combine>
+        T reduceSubtree(thread_pool& pool, NodePtr node, const T& identity, Fold& fold, Combine& combine);
+
+        template <class Value, class NodePtr, class T, class Fold, class Combine>
+        struct reduce_subtree_task
+        {
+            NodePtr node;
+            const T* identity;
+            Fold* fold;
+            Combine* combine;
+            thread_pool* pool;
+            T value;
+
+            reduce_subtree_task(NodePtr node, const T* identity, Fold* fold, Combine* combine, thread_pool* pool):
+            node(node), identity(identity), fold(fold), combine(combine), pool(pool), value(*identity) {};
+
+            static void run(void* arg)
+            {
+                reduce_subtree_task* task = static_cast<reduce_subtree_task*>(arg);
+                task->value = reduceSubtree<Value>(*task->pool, task->node, *task->identity, *task->fold, *task->combine);
+            };
+        };
+
+        //folds the subtree in order; subtrees are folded from identity and combined left to right
+        template <class Value, class NodePtr, class T, class Fold, class Combine>
+        T reduceSubtree(thread_pool& pool, NodePtr node, const T& identity, Fold& fold, Combine& combine)
+        {
+            if (ft::treeSize(node) <= static_cast<std::size_t>(grainSize) || pool.size() == 1)
+            {
+                T acc = identity;
+                NodePtr it = ft::treeMin(node);
+                for (std::size_t n = ft::treeSize(node); n; --n, it = ft::treeNext(it))
+                    acc = fold(acc, static_cast<Value&>(it->pair));
+                return acc;
+            }
+            task_group group;
+            reduce_subtree_task<Value, NodePtr, T, Fold, Combine> right(node->right, &identity, &fold, &combine, &pool);
+            if (node->right)
+                pool.spawn(group, reduce_subtree_task<Value, NodePtr, T, Fold, Combine>::run, &right);
+            T acc = node->left ? reduceSubtree<Value>(pool, node->left, identity, fold, combine) : identity;
+            acc = fold(acc, static_cast<Value&>(node->pair));
+            pool.wait(group);
+            if (node->right)
+                acc = combine(acc, right.value);
+            return acc;
+        };
+
+        // Calls f on every element, from several threads and in no particular
+        // order. The tree is cut into disjoint subtrees near the root; elements
+        // of a map are passed as value_type&, so f may change mapped values.
+        template <class Key, class T, class Compare, class Alloc, class F>
+        void for_each(ft::map<Key, T, Compare, Alloc>& map, F f, thread_pool& pool)
+        {
+            visitSubtree<typename ft::map<Key, T, Compare, Alloc>::value_type>(pool, rootOf(map), f);
+        };
+
+        template <class Key, class T, class Compare, class Alloc, class F>
+        void for_each(ft::map<Key, T, Compare, Alloc>& map, F f)
+        {
+            parallel::for_each(map, f, thread_pool::shared());
+        };
+
+        template <class Key, class T, class Compare, class Alloc, class F>
+        void for_each(const ft::map<Key, T, Compare, Alloc>& map, F f, thread_pool& pool)
+        {
+            visitSubtree<const typename ft::map<Key, T, Compare, Alloc>::value_type>(pool, rootOf(map), f);
+        };
+
+        template <class Key, class T, class Compare, class Alloc, class F>
+        void for_each(const ft::map<Key, T, Compare, Alloc>& map, F f)
+        {
+            parallel::for_each(map, f, thread_pool::shared());
+        };
+
+        template <class Key, class Compare, class Alloc, class F>
+        void for_each(const ft::set<Key, Compare, Alloc>& set, F f, thread_pool& pool)
+        {
+            visitSubtree<const Key>(pool, rootOf(set), f);
+        };
+
+        template <class Key, class Compare, class Alloc, class F>
+        void for_each(const ft::set<Key, Compare, Alloc>& set, F f)
+        {
+            parallel::for_each(set, f, thread_pool::shared());
+        };
+
+        // In-order reduction: fold(acc, element) folds the elements of one subtree
+        // starting from identity, and combine(lhs, rhs) joins the results of
+        // neighbouring subtrees left to right, so neither has to commute. identity
+        // must be neutral for combine (0 for a sum), as every subtree starts from it.
+        template <class Key, class T, class Compare, class Alloc, class R, class Fold, class Combine>
+        R reduce(const ft::map<Key, T, Compare, Alloc>& map, R identity, Fold fold, Combine combine, thread_pool& pool)
+        {
+            if (map.empty())
+                return identity;
+            return reduceSubtree<const typename ft::map<Key, T, Compare, Alloc>::value_type>(pool, rootOf(map), identity, fold, combine);
+        };
+
+        template <class Key, class T, class Compare, class Alloc, class R, class Fold, class Combine>
+        R reduce(const ft::map<Key, T, Compare, Alloc>& map, R identity, Fold fold, Combine combine)
+        {
+            return parallel::reduce(map, identity, fold, combine, thread_pool::shared());
+        };
+
+        //op serves as both fold and combine
+        template <class Key, class T, class Compare, class Alloc, class R, class Op>
+        R reduce(const ft::map<Key, T, Compare, Alloc>& map, R identity, Op op, thread_pool& pool)
+        {
+            return parallel::reduce(map, identity, op, op, pool);
+        };
+
+        template <class Key, class T, class Compare, class Alloc, class R, class Op>
+        R reduce(const ft::map<Key, T, Compare, Alloc>& map, R identity, Op op)
+        {
+            return parallel::reduce(map, identity, op, op, thread_pool::shared());
+        };
+
+        template <class Key, class Compare, class Alloc, class R, class Fold, class Combine>
+        R reduce(const ft::set<Key, Compare, Alloc>& set, R identity, Fold fold, Combine combine, thread_pool& pool)
+        {
+            if (set.empty())
+                return identity;
+            return reduceSubtree<const Key>(pool, rootOf(set), identity, fold, combine);
+        };
+
+        template <class Key, class Compare, class Alloc, class R, class Fold, class Combine>
+        R reduce(const ft::set<Key, Compare, Alloc>& set, R identity, Fold fold, Combine combine)
+        {
+            return parallel::reduce(set, identity, fold, combine, thread_pool::shared());
+        };
+
+        template <class Key, class Compare, class Alloc, class R, class Op>
+        R reduce(const ft::set<Key, Compare, Alloc>& set, R identity, Op op, thread_pool& pool)
+        {
+            return parallel::reduce(set, identity, op, op, pool);
+        };
+
+        template <class Key, class Compare, class Alloc, class R, class Op>
+        R reduce(const ft::set<Key, Compare, Alloc>& set, R identity, Op op)
+        {
+            return parallel::reduce(set, identity, op, op, thread_pool::shared());
+        };
+
+        /*building map and set*/
+        //subtrees smaller than this are linked by the thread that reaches them
+        static const std::size_t linkGrain = 1 << 12;
+
+        template <class Tree>
+        typename Tree::pointer linkArray(thread_pool& pool, typename Tree::pointer const * nodes, std::size_t n, std::size_t depth, std::size_t redDepth);
+
+        template <class Tree>
+        struct link_task
+        {
+            typename Tree::pointer const * nodes;
+            std::size_t n;
+            std::size_t depth;
+            std::size_t redDepth;
+            thread_pool* pool;
+            typename Tree::pointer root;
+
+            static void run(void* arg)
+            {
+                link_task* task = static_cast<link_task*>(arg);
+                task->root = linkArray<Tree>(*task->pool, task->nodes, task->n, task->depth, task->redDepth);
+            };
+        };
+
+        //Tree::fromArray with the right subtrees of big ranges linked by the pool
+        template <class Tree>
+        typename Tree::pointer linkArray(thread_pool& pool, typename Tree::pointer const * nodes, std::size_t n, std::size_t depth, std::size_t redDepth)
+        {
+            if (n <= linkGrain || pool.size() == 1)
+                return Tree::fromArray(nodes, n, depth, redDepth);
+            task_group group;
+            link_task<Tree> right = { nodes + n / 2 + 1, n - n / 2 - 1, depth + 1, redDepth, &pool, NULL };
+            pool.spawn(group, link_task<Tree>::run, &right);
+            typename Tree::pointer node = nodes[n / 2];
+            node->left = linkArray<Tree>(pool, nodes, n / 2, depth + 1, redDepth);
+            pool.wait(group);
+            node->right = right.root;
+            node->left->parent = node;
+            node->right->parent = node;
+            node->color = (depth == redDepth) ? Red : Black;
+            node->size = n;
+            return node;
+        };
+
+        //replaces the contents of container with the first count values, sorted and unique
+        template <class Container, class Values>
+        void buildSorted(Container& container, Values& values, std::size_t count, thread_pool& pool)
+        {
+            typedef typename Container::tree_type tree_type;
+            tree_type& tree = container_access<Container>::tree(container);
+            ft::vector<typename Container::node_ptr> nodes(count);
+            for (std::size_t i = 0; i < count; ++i)
+                nodes[i] = tree.createNode(values[i]);
+            container.clear();
+            if (count)
+            {
+                typename Container::node_ptr root = linkArray<tree_type>(pool, &nodes[0], count, 0, tree_type::redDepthFor(count));
+                root->parent = NULL;
+                tree.setRoot(root);
+            }
+            container_access<Container>::setSize(container, count);
+        };
+
+        //orders the mutable-key copies build sorts for a map
+        template <class Pair, class Compare>
+        struct first_compare
+        {
+            Compare comp;
+
+            bool operator()(const Pair& x, const Pair& y) const
+            {
+                return this->comp(x.first, y.first);
+            };
+        };
+
+        // Replaces the contents of map with [first, last), keeping the first of
+        // equal keys like the range constructor. The input is copied and
+        // stable-sorted on the pool, the nodes are allocated on the calling thread,
+        // one by one so erase can hand each back, and linked bottom-up into a
+        // balanced tree on the pool, O(n) after the sort. Only the calling thread
+        // uses the map's allocator, so an unsynchronized arena is fine.
+        template <class Key, class T, class Compare, class Alloc, class InputIt>
+        void build(ft::map<Key, T, Compare, Alloc>& map, InputIt first, InputIt last, thread_pool& pool)
+        {
+            //the key of value_type is const, so sort copies that can be assigned
+            ft::vector<ft::pair<Key, T> > entries(first, last);
+            first_compare<ft::pair<Key, T>, Compare> comp = { map.key_comp() };
+            parallel::sort(entries.begin(), entries.end(), comp, pool);
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < entries.size(); ++i)
+            {
+                if (!count || comp(entries[count - 1], entries[i]))
+                    entries[count++] = entries[i];
+            }
+            buildSorted(map, entries, count, pool);
+        };
+
+        template <class Key, class T, class Compare, class Alloc, class InputIt>
+        void build(ft::map<Key, T, Compare, Alloc>& map, InputIt first, InputIt last)
+        {
+            parallel::build(map, first, last, thread_pool::shared());
+        };
+
+        //the set counterpart of build for maps
+        template <class Key, class Compare, class Alloc, class InputIt>
+        void build(ft::set<Key, Compare, Alloc>& set, InputIt first, InputIt last, thread_pool& pool)
+        {
+            ft::vector<Key> values(first, last);
+            Compare comp = set.key_comp();
+            parallel::sort(values.begin(), values.end(), comp, pool);
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                if (!count || comp(values[count - 1], values[i]))
+                    values[count++] = values[i];
+            }
+            buildSorted(set, values, count, pool);
+        };
+
+        template <class Key, class Compare, class Alloc, class InputIt>
+        void build(ft::set<Key, Compare, Alloc>& set, InputIt first, InputIt last)
+        {
+            parallel::build(set, first, last, thread_pool::shared());
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef PERF_COUNTERS_HPP
+# define PERF_COUNTERS_HPP
+
+#include <cstring>
+#include <stdint.h>
+#include <unistd.h>
+#if defined(__linux__)
+# include <linux/perf_event.h>
+# include <sys/syscall.h>
+# include <sys/ioctl.h>
+#endif
+
+// Hardware counters of the calling thread through Linux perf_event_open, for
+// the benchmarks. Each event is opened on its own, user space only, so one
+// the CPU or the kernel refuses (no PMU in a VM or container, a
+// perf_event_paranoid above 2, another OS) is just reported as unavailable
+// and the rest still count. Counts are scaled when the kernel had to
+// multiplex the events.
+
+namespace bench
+{
+    enum perf_event_kind { perfCycles, perfInstructions, perfL1Misses, perfLlcMisses, perfBranchMisses, perfEvents };
+
+    const char* const perfEventNames[perfEvents] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+
+    class perf_counters
+    {
+        int _fds[perfEvents];
+        uint64_t _values[perfEvents];
+
+        perf_counters(perf_counters const &);
+        perf_counters& operator=(perf_counters const &);
+
+#if defined(__linux__)
+        static int open(uint32_t type, uint64_t config)
+        {
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        };
+
+        static uint64_t cacheMiss(uint64_t cache)
+        {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+#endif
+
+        public:
+            perf_counters()
+            {
+                for (int i = 0; i < perfEvents; ++i)
+                {
+                    this->_fds[i] = -1;
+                    this->_values[i] = 0;
+                }
+#if defined(__linux__)
+                this->_fds[perfCycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+                this->_fds[perfInstructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+                this->_fds[perfL1Misses] = open(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D));
+                this->_fds[perfLlcMisses] = open(PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL));
+                this->_fds[perfBranchMisses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+            };
+
+            ~perf_counters()
+            {
+                for (int i = 0; i < perfEvents; ++i)
+                    if (this->_fds[i] >= 0)
+                        close(this->_fds[i]);
+            };
+
+            bool available(int event) const
+            {
+                return this->_fds[event] >= 0;
+            };
+
+            bool any() const
+            {
+                for (int i = 0; i < perfEvents; ++i)
+                    if (available(i))
+                        return true;
+                return false;
+            };
+
+            void start()
+            {
+#if defined(__linux__)
+                for (int i = 0; i < perfEvents; ++i)
+                    if (this->_fds[i] >= 0)
+                    {
+                        ioctl(this->_fds[i], PERF_EVENT_IOC_RESET, 0);
+                        ioctl(this->_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+                    }
+#endif
+            };
+
+            void stop()
+            {
+#if defined(__linux__)
+                for (int i = 0; i < perfEvents; ++i)
+                    if (this->_fds[i] >= 0)
+                        ioctl(this->_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+                for (int i = 0; i < perfEvents; ++i)
+                {
+                    //value, time enabled, time running
+                    uint64_t data[3] = { 0, 0, 0 };
+                    if (this->_fds[i] < 0 || read(this->_fds[i], data, sizeof(data)) != sizeof(data))
+                        this->_values[i] = 0;
+                    else if (data[2] && data[2] < data[1])
+                        this->_values[i] = static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]);
+                    else
+                        this->_values[i] = data[0];
+                }
+#endif
+            };
+
+            //count between the last start() and stop()
+            uint64_t value(int event) const
+            {
+                return this->_values[event];
+            };
+    };
+}
+
+#endif
@@ -0,0 +1,463 @@
+#ifndef PERSISTENT_MAP_HPP
+# define PERSISTENT_MAP_HPP
+
+#include <memory>
+#include <iterator>
+#include <stdexcept>
+#include "utils.hpp"
+
+namespace ft
+{
+    // Ordered map whose nodes are immutable and shared between versions. An update
+    // copies only the O(log n) nodes on the path to the key and links them to the
+    // untouched subtrees of the previous version, so copying the map, snapshot()
+    // included, is O(1). Nodes carry an atomic reference count and are freed when
+    // the last version using them goes away, which lets a snapshot be read from
+    // other threads without locking while its source keeps changing.
+    // One persistent_map object is still not safe to update from several threads
+    // at once; readers should each hold their own snapshot.
+    // Balancing is AVL rather than red-black: rebalancing after a path-copying
+    // erase only has to look at the copied path.
+    template <class Key, class T, class Compare = ft::less<Key>, class Alloc = std::allocator<ft::pair<const Key, T> > >
+    class persistent_map
+    {
+        public:
+            typedef Key key_type;
+            typedef T mapped_type;
+            typedef ft::pair<const Key, T> value_type;
+            typedef Compare key_compare;
+            typedef Alloc allocator_type;
+            typedef std::size_t size_type;
+
+        private:
+            struct node
+            {
+                value_type value;
+                node* left;
+                node* right;
+                int height;
+                unsigned refs;
+
+                node(const value_type& value, node* left, node* right, int height): value(value), left(left), right(right), height(height), refs(1) {};
+            };
+
+            typedef typename Alloc::template rebind<node>::other node_alloc;
+
+            //an AVL tree of 64 levels needs more than 10^13 nodes
+            static const int maxHeight = 64;
+
+            node* _root;
+            size_type _size;
+            key_compare _comp;
+            allocator_type _allocator;
+            node_alloc _nodeAllocator;
+
+            static int height(node const * n)
+            {
+                return n ? n->height : 0;
+            };
+
+            static node* retain(node* n)
+            {
+                if (n)
+                    __atomic_add_fetch(&n->refs, 1, __ATOMIC_RELAXED);
+                return n;
+            };
+
+            void release(node* n)
+            {
+                while (n && __atomic_sub_fetch(&n->refs, 1, __ATOMIC_ACQ_REL) == 0)
+                {
+                    node* right = n->right;
+                    release(n->left);
+                    this->_nodeAllocator.destroy(n);
+                    this->_nodeAllocator.deallocate(n, 1);
+                    n = right;
+                }
+            };
+
+            //takes over the references held on left and right
+            node* make(const value_type& value, node* left, node* right)
+            {
+                int h = height(left) > height(right) ? height(left) : height(right);
+                node* n = this->_nodeAllocator.allocate(1);
+                this->_nodeAllocator.construct(n, node(value, left, right, h + 1));
+                return n;
+            };
+
+            //make() with the rotations needed when left and right differ in height by two
+            node* balance(const value_type& value, node* left, node* right)
+            {
+                node* res;
+                if (height(left) > height(right) + 1)
+                {
+                    if (height(left->left) >= height(left->right))
+                        res = make(left->value, retain(left->left), make(value, retain(left->right), right));
+                    else
+                    {
+                        node* mid = left->right;
+                        res = make(mid->value, make(left->value, retain(left->left), retain(mid->left)), make(value, retain(mid->right), right));
+                    }
+                    release(left);
+                }
+                else if (height(right) > height(left) + 1)
+                {
+                    if (height(right->right) >= height(right->left))
+                        res = make(right->value, make(value, left, retain(right->left)), retain(right->right));
+                    else
+                    {
+                        node* mid = right->left;
+                        res = make(mid->value, make(value, left, retain(mid->left)), make(right->value, retain(mid->right), retain(right->right)));
+                    }
+                    release(right);
+                }
+                else
+                    res = make(value, left, right);
+                return res;
+            };
+
+            //the new version of the subtree, or NULL if it is unchanged
+            node* insertNode(node* n, const value_type& value, bool assign, bool& inserted)
+            {
+                if (!n)
+                {
+                    inserted = true;
+                    return make(value, NULL, NULL);
+                }
+                if (this->_comp(value.first, n->value.first))
+                {
+                    node* left = insertNode(n->left, value, assign, inserted);
+                    return left ? balance(n->value, left, retain(n->right)) : NULL;
+                }
+                if (this->_comp(n->value.first, value.first))
+                {
+                    node* right = insertNode(n->right, value, assign, inserted);
+                    return right ? balance(n->value, retain(n->left), right) : NULL;
+                }
+                if (!assign)
+                    return NULL;
+                return make(value, retain(n->left), retain(n->right));
+            };
+
+            node* eraseMin(node* n)
+            {
+                if (!n->left)
+                    return retain(n->right);
+                return balance(n->value, eraseMin(n->left), retain(n->right));
+            };
+
+            //the new version of the subtree; only meaningful if found is set
+            node* eraseNode(node* n, const key_type& key, bool& found)
+            {
+                if (!n)
+                    return NULL;
+                if (this->_comp(key, n->value.first))
+                {
+                    node* left = eraseNode(n->left, key, found);
+                    return found ? balance(n->value, left, retain(n->right)) : NULL;
+                }
+                if (this->_comp(n->value.first, key))
+                {
+                    node* right = eraseNode(n->right, key, found);
+                    return found ? balance(n->value, retain(n->left), right) : NULL;
+                }
+                found = true;
+                if (!n->left)
+                    return retain(n->right);
+                if (!n->right)
+                    return retain(n->left);
+                node* min = n->right;
+                while (min->left)
+                    min = min->left;
+                return balance(min->value, retain(n->left), eraseMin(n->right));
+            };
+
+            node* findNode(const key_type& key) const
+            {
+                node* n = this->_root;
+                while (n)
+                {
+                    if (this->_comp(key, n->value.first))
+                        n = n->left;
+                    else if (this->_comp(n->value.first, key))
+                        n = n->right;
+                    else
+                        return n;
+                }
+                return NULL;
+            };
+
+            void setRoot(node* root)
+            {
+                release(this->_root);
+                this->_root = root;
+            };
+
+        public:
+            // In-order walk over one version. The path to the current node lives in
+            // the iterator, so nodes need no parent pointers; an iterator stays
+            // valid as long as some map still holds the version it came from.
+            class const_iterator
+            {
+                node* _path[maxHeight];
+                int _depth;
+
+                friend class persistent_map;
+
+                void pushLeft(node* n)
+                {
+                    for (; n; n = n->left)
+                        this->_path[this->_depth++] = n;
+                };
+
+                public:
+                    typedef std::forward_iterator_tag iterator_category;
+                    typedef typename persistent_map::value_type value_type;
+                    typedef std::ptrdiff_t difference_type;
+                    typedef const value_type* pointer;
+                    typedef const value_type& reference;
+
+                    const_iterator(): _depth(0) {};
+
+                    const_iterator(const const_iterator& copy): _depth(copy._depth)
+                    {
+                        for (int i = 0; i < this->_depth; ++i)
+                            this->_path[i] = copy._path[i];
+                    };
+
+                    const_iterator& operator=(const const_iterator& copy)
+                    {
+                        this->_depth = copy._depth;
+                        for (int i = 0; i < this->_depth; ++i)
+                            this->_path[i] = copy._path[i];
+                        return *this;
+                    };
+
+                    reference operator*() const
+                    {
+                        return this->_path[this->_depth - 1]->value;
+                    };
+
+                    pointer operator->() const
+                    {
+                        return &this->_path[this->_depth - 1]->value;
+                    };
+
+                    const_iterator& operator++()
+                    {
+                        node* n = this->_path[--this->_depth];
+                        pushLeft(n->right);
+                        return *this;
+                    };
+
+                    const_iterator operator++(int)
+                    {
+                        const_iterator tmp(*this);
+                        ++(*this);
+                        return tmp;
+                    };
+
+                    bool operator==(const const_iterator& other) const
+                    {
+                        if (!this->_depth || !other._depth)
+                            return this->_depth == other._depth;
+                        return this->_path[this->_depth - 1] == other._path[other._depth - 1];
+                    };
+
+                    bool operator!=(const const_iterator& other) const
+                    {
+                        return !(*this == other);
+                    };
+            };
+            typedef const_iterator iterator;
+
+            /*constructors*/
+            explicit persistent_map(const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type()):
+            _root(NULL), _size(0), _comp(comp), _allocator(alloc), _nodeAllocator(alloc) {};
+
+            template <class InputIt>
+            persistent_map(InputIt first, InputIt last, const key_compare& comp = key_compare(), const allocator_type& alloc = allocator_type(),
+            typename ft::enable_if<!ft::is_integral<InputIt>::value, InputIt>::type* = 0):
+            _root(NULL), _size(0), _comp(comp), _allocator(alloc), _nodeAllocator(alloc)
+            {
+                for (; first != last; ++first)
+                    insert(*first);
+            };
+
+            //O(1), the two maps share every node until one of them changes
+            persistent_map(const persistent_map& copy):
+            _root(retain(copy._root)), _size(copy._size), _comp(copy._comp), _allocator(copy._allocator), _nodeAllocator(copy._nodeAllocator) {};
+
+            persistent_map& operator=(const persistent_map& copy)
+            {
+                node* root = retain(copy._root);
+                setRoot(root);
+                this->_size = copy._size;
+                this->_comp = copy._comp;
+                return *this;
+            };
+
+            ~persistent_map()
+            {
+                release(this->_root);
+            };
+
+            //a read-only version that later updates to this map do not affect
+            persistent_map snapshot() const
+            {
+                return *this;
+            };
+
+            /*modifiers*/
+            //false if the key was already present
+            bool insert(const value_type& value)
+            {
+                bool inserted = false;
+                node* root = insertNode(this->_root, value, false, inserted);
+                if (root)
+                {
+                    setRoot(root);
+                    ++this->_size;
+                }
+                return inserted;
+            };
+
+            //true if the key was new
+            bool insert_or_assign(const key_type& key, const mapped_type& value)
+            {
+                bool inserted = false;
+                setRoot(insertNode(this->_root, ft::make_pair(key, value), true, inserted));
+                this->_size += inserted;
+                return inserted;
+            };
+
+            size_type erase(const key_type& key)
+            {
+                bool found = false;
+                node* root = eraseNode(this->_root, key, found);
+                if (!found)
+                    return 0;
+                setRoot(root);
+                --this->_size;
+                return 1;
+            };
+
+            void clear()
+            {
+                setRoot(NULL);
+                this->_size = 0;
+            };
+
+            void swap(persistent_map& x)
+            {
+                node* root = this->_root;
+                size_type size = this->_size;
+                key_compare comp = this->_comp;
+
+                this->_root = x._root;
+                this->_size = x._size;
+                this->_comp = x._comp;
+                x._root = root;
+                x._size = size;
+                x._comp = comp;
+            };
+
+            /*lookup*/
+            const_iterator find(const key_type& key) const
+            {
+                const_iterator it = lower_bound(key);
+                if (it != end() && this->_comp(key, it->first))
+                    return end();
+                return it;
+            };
+
+            size_type count(const key_type& key) const
+            {
+                return findNode(key) != NULL;
+            };
+
+            const mapped_type& at(const key_type& key) const
+            {
+                node* n = findNode(key);
+                if (!n)
+                    throw std::out_of_range("persistent_map::at");
+                return n->value.second;
+            };
+
+            const_iterator lower_bound(const key_type& key) const
+            {
+                const_iterator it;
+                node* n = this->_root;
+                while (n)
+                {
+                    if (this->_comp(n->value.first, key))
+                        n = n->right;
+                    else
+                    {
+                        it._path[it._depth++] = n;
+                        n = n->left;
+                    }
+                }
+                return it;
+            };
+
+            const_iterator upper_bound(const key_type& key) const
+            {
+                const_iterator it;
+                node* n = this->_root;
+                while (n)
+                {
+                    if (!this->_comp(key, n->value.first))
+                        n = n->right;
+                    else
+                    {
+                        it._path[it._depth++] = n;
+                        n = n->left;
+                    }
+                }
+                return it;
+            };
+
+            /*iterators*/
+            const_iterator begin() const
+            {
+                const_iterator it;
+                it.pushLeft(this->_root);
+                return it;
+            };
+
+            const_iterator end() const
+            {
+                return const_iterator();
+            };
+
+            /*capacity*/
+            size_type size() const
+            {
+                return this->_size;
+            };
+
+            bool empty() const
+            {
+                return this->_size == 0;
+            };
+
+            key_compare key_comp() const
+            {
+                return this->_comp;
+            };
+
+            allocator_type get_allocator() const
+            {
+                return this->_allocator;
+            };
+    };
+
+    template <class Key, class T, class Compare, class Alloc>
+    void swap(persistent_map<Key, T, Compare, Alloc>& lhs, persistent_map<Key, T, Compare, Alloc>& rhs)
+    {
+        lhs.swap(rhs);
+    };
+}
+
+#endif
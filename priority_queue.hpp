@@ -0,0 +1,192 @@
+#ifndef PRIORITY_QUEUE_HPP
+# define PRIORITY_QUEUE_HPP
+
+#include "vector.hpp"
+#include "utils.hpp"
+
+namespace ft
+{
+    // d-ary max-heap adaptor. With the default Arity of 4 the tree is half as
+    // deep as a binary heap and the children of a node are adjacent, so a
+    // sift-down touches fewer cache lines per level.
+    template <class T, class Container = ft::vector<T>, class Compare = ft::less<typename Container::value_type>, std::size_t Arity = 4>
+    class priority_queue
+    {
+        public:
+
+            typedef Container container_type;
+            typedef Compare value_compare;
+            typedef typename container_type::value_type value_type;
+            typedef typename container_type::size_type size_type;
+            typedef typename container_type::reference reference;
+            typedef	typename container_type::const_reference const_reference;
+
+
+            /*constructor*/
+            explicit priority_queue (const Compare& compare = Compare(), const container_type& ctnr = container_type()): c(ctnr), comp(compare)
+            {
+                heapify();
+            };
+
+            //builds the heap bottom-up, O(n)
+            template <class InputIt>
+            priority_queue (InputIt first, InputIt last, const Compare& compare = Compare(), const container_type& ctnr = container_type()): c(ctnr), comp(compare)
+            {
+                this->c.insert(this->c.end(), first, last);
+                heapify();
+            };
+
+            priority_queue( const priority_queue& other ): c(other.c), comp(other.comp) {};
+            
+            /*destructor*/
+            ~priority_queue() {};
+            
+            priority_queue& operator=( const priority_queue& other )
+            {
+                if (this == &other)
+                    return (*this);
+                this->c = other.c;
+                this->comp = other.comp;
+                return (*this);
+            };
+
+
+            /*  methods  */
+            const_reference top() const
+            {
+                return this->c.front();
+            };
+
+            bool empty() const
+            {
+                return this->c.empty();
+            };
+
+            size_type size() const
+            {
+                return this->c.size();
+            };
+
+            void push(const value_type& value)
+            {
+                this->c.push_back(value);
+                siftUp(this->c.size() - 1);
+            };
+
+            //appends the range, then either sifts each new element up or rebuilds
+            //the whole heap, whichever is cheaper
+            template <class InputIt>
+            void push_range(InputIt first, InputIt last)
+            {
+                size_type old = this->c.size();
+                this->c.insert(this->c.end(), first, last);
+                size_type added = this->c.size() - old;
+                size_type depth = 1;
+                for (size_type n = this->c.size(); n >= Arity; n /= Arity)
+                    depth++;
+                if (added * depth >= this->c.size())
+                    heapify();
+                else
+                {
+                    for (size_type i = old; i < this->c.size(); ++i)
+                        siftUp(i);
+                }
+            };
+
+            //the hole left by the top sinks to a leaf along the best children and the
+            //last element is sifted up from there: it usually belongs near the bottom
+            void pop()
+            {
+                size_type n = this->c.size() - 1;
+                size_type i = 0;
+                while (true)
+                {
+                    size_type first = i * Arity + 1;
+                    if (first >= n)
+                        break ;
+                    size_type last = first + Arity < n ? first + Arity : n;
+                    size_type best = first;
+                    for (size_type k = first + 1; k < last; ++k)
+                    {
+                        if (this->comp(this->c[best], this->c[k]))
+                            best = k;
+                    }
+                    this->c[i] = this->c[best];
+                    i = best;
+                }
+                if (i != n)
+                {
+                    this->c[i] = this->c.back();
+                    siftUp(i);
+                }
+                this->c.pop_back();
+            };
+
+            //replaces the top with value: one sift-down instead of a pop and a push
+            void pop_push(const value_type& value)
+            {
+                if (this->c.empty())
+                {
+                    push(value);
+                    return ;
+                }
+                this->c[0] = value;
+                siftDown(0);
+            };
+
+        protected:
+            container_type c;
+            value_compare comp;
+
+        private:
+            //the moving element is held aside and written once at its final slot
+            void siftUp(size_type i)
+            {
+                value_type value = this->c[i];
+                while (i > 0)
+                {
+                    size_type parent = (i - 1) / Arity;
+                    if (!this->comp(this->c[parent], value))
+                        break ;
+                    this->c[i] = this->c[parent];
+                    i = parent;
+                }
+                this->c[i] = value;
+            };
+
+            void siftDown(size_type i)
+            {
+                size_type n = this->c.size();
+                value_type value = this->c[i];
+                while (true)
+                {
+                    size_type first = i * Arity + 1;
+                    if (first >= n)
+                        break ;
+                    size_type last = first + Arity < n ? first + Arity : n;
+                    size_type best = first;
+                    for (size_type k = first + 1; k < last; ++k)
+                    {
+                        if (this->comp(this->c[best], this->c[k]))
+                            best = k;
+                    }
+                    if (!this->comp(value, this->c[best]))
+                        break ;
+                    this->c[i] = this->c[best];
+                    i = best;
+                }
+                this->c[i] = value;
+            };
+
+            void heapify()
+            {
+                size_type n = this->c.size();
+                if (n < 2)
+                    return ;
+                for (size_type i = (n - 2) / Arity + 1; i-- > 0; )
+                    siftDown(i);
+            };
+    };
+}
+
+#endif
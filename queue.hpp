@@ -0,0 +1,114 @@
+#ifndef QUEUE_HPP
+# define QUEUE_HPP
+
+#include <deque>
+
+namespace ft
+{
+    template <class T, class Container = std::deque<T> >
+    class queue
+    {
+        public:
+
+            typedef Container container_type;
+            typedef T value_type;
+            typedef size_t size_type;
+            typedef typename container_type::reference reference;
+            typedef	typename container_type::const_reference const_reference;
+
+
+            /*constructor*/
+            explicit queue (const container_type& ctnr = container_type()): c(ctnr) {};
+
+            queue( const queue& other ): c(other.c) {};
+            
+            /*destructor*/
+            ~queue() {};
+            
+            queue& operator=( const queue& other )
+            {
+                if (this == &other)
+                    return (*this);
+                this->c = other.c;
+                return (*this);
+            };
+
+
+            /*  methods  */
+            value_type& front()
+            {
+                return this->c.front();
+            };
+
+            const value_type& front() const
+            {
+                return this->c.front();
+            };
+
+            value_type& back()
+            {
+                return this->c.back();
+            };
+
+            const value_type& back() const
+            {
+                return this->c.back();
+            };
+
+            bool empty() const
+            {
+                return this->c.empty();
+            };
+
+            size_type size() const
+            {
+                return this->c.size();
+            };
+
+            void push(const value_type& value)
+            {
+                this->c.push_back(value);
+            };
+
+            void pop()
+            {
+                this->c.pop_front();
+            };
+
+            friend bool operator== (const queue<T,Container>& lhs, const queue<T,Container>& rhs)
+            {
+                return (lhs.c == rhs.c);
+            };
+
+            friend bool operator!= (const queue<T,Container>& lhs, const queue<T,Container>& rhs)
+            {
+                return (lhs.c != rhs.c);
+            };
+
+            friend bool operator< (const queue<T,Container>& lhs, const queue<T,Container>& rhs) 
+            {
+                return (lhs.c < rhs.c);
+            };
+
+
+            friend bool operator<= (const queue<T,Container>& lhs, const queue<T,Container>& rhs) 
+            {
+                return (lhs.c <= rhs.c);
+            };
+
+            friend bool operator> (const queue<T,Container>& lhs, const queue<T,Container>& rhs) 
+            {
+                return (lhs.c > rhs.c);
+            };
+
+            friend bool operator>= (const queue<T,Container>& lhs, const queue<T,Container>& rhs) 
+            {
+                return (lhs.c >= rhs.c);
+            };
+
+        protected:
+            container_type c;
+    };
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "RBtree.hpp"
 #include "ft_map_iterator.hpp"
 #include "ft_reverse_iterator.hpp"
+#include "node_handle.hpp"
 #include <memory>
 #include "utils.hpp"
 
@@ -33,8 +34,20 @@ namespace ft
             typedef typename Allocator::template rebind<Node<value_type> >::other node_alloc;
             typedef RBtree<value_type, Node<value_type>, value_compare, node_alloc> tree_type;
             typedef Node<value_type>* node_ptr;
+            typedef ft::set_node_handle<Key, node_alloc> node_type;
 
         private:
+            friend struct container_access<set>;
+
+            //what find_batch looks up for a key: the key itself
+            struct key_probe
+            {
+                const value_type& operator()(const key_type& key) const
+                {
+                    return key;
+                };
+            };
+
             allocator_type _allocator;
             tree_type _tree;
             size_type _size;
@@ -45,15 +58,15 @@ namespace ft
             /* constructors */
             set(): _allocator(Allocator()), _tree(tree_type()), _size(0), _key_comp(key_compare()), _value_comp(value_compare()) {};
             
-            explicit set(const Compare& comp, const Allocator& alloc = Allocator()): _allocator(alloc), _tree(tree_type()), _size(0), _key_comp(comp), _value_comp(comp) {};
+            explicit set(const Compare& comp, const Allocator& alloc = Allocator()): _allocator(alloc), _tree(tree_type(comp, node_alloc(alloc))), _size(0), _key_comp(comp), _value_comp(comp) {};
 
             template <class InputIt>
-            set(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator()): _allocator(alloc), _tree(tree_type()), _size(0), _key_comp(comp), _value_comp(comp)
+            set(InputIt first, InputIt last, const Compare& comp = Compare(), const Allocator& alloc = Allocator()): _allocator(alloc), _tree(tree_type(comp, node_alloc(alloc))), _size(0), _key_comp(comp), _value_comp(comp)
             {
                 insert(first, last);
             };
 
-            set(const set& other): _allocator(other._allocator), _tree(tree_type()), _size(0), _key_comp(other._key_comp), _value_comp(other._value_comp)
+            set(const set& other): _allocator(other._allocator), _tree(tree_type(other._key_comp, node_alloc(other._allocator))), _size(0), _key_comp(other._key_comp), _value_comp(other._value_comp)
             {
                 clear();
                 insert(other.begin(), other.end());
@@ -65,6 +78,7 @@ namespace ft
                     return *this;
                 clear();
                 this->_allocator = other._allocator;
+                this->_tree = tree_type(other._key_comp, node_alloc(other._allocator));
                 this->_key_comp = other._key_comp;
                 this->_value_comp = other._value_comp;
                 insert(other.begin(), other.end());
@@ -73,8 +87,7 @@ namespace ft
 
             ~set()
             {
-                this->_tree.clear(this->_tree.getRoot());
-                this->_tree.makeRootNull();
+                this->_tree.clearAll();
             };
 
             /* methods */
@@ -140,12 +153,17 @@ namespace ft
                 return this->_tree.max_size();
             };
 
+            //memory, shape and (with FT_CONTAINERS_STATS) rotation and lookup counters of the tree
+            tree_stats stats() const
+            {
+                return this->_tree.stats();
+            };
+
             /* modifiers */
 
             void clear()
             {
-                this->_tree.clear(this->_tree.getRoot());
-                this->_tree.makeRootNull();
+                this->_tree.clearAll();
                 this->_size = 0;
             };
 
@@ -171,11 +189,7 @@ namespace ft
 
             void erase(iterator pos)
             {
-                iterator it = begin();
-                while (it != pos)
-                    it++;
-                node_ptr node = this->_tree.find(*it, this->_tree.getRoot());
-                this->_size -= this->_tree.deleteNode(node);
+                this->_size -= this->_tree.deleteNode(pos.getNode());
             };
 
             void erase(iterator first, iterator last)
@@ -213,6 +227,123 @@ namespace ft
                 x._value_comp = val_comp;
             };
 
+            //moves the elements in [lo, hi) into out by relinking nodes, O(log n);
+            //copied instead when out's allocator cannot free this set's nodes
+            void extract_range(const Key& lo, const Key& hi, set& out)
+            {
+                if (this == &out)
+                    return ;
+                out.clear();
+                if (!this->_key_comp(lo, hi))
+                    return ;
+                if (!(this->_tree.getAllocator() == out._tree.getAllocator()))
+                {
+                    iterator first = lower_bound(lo);
+                    iterator last = lower_bound(hi);
+                    out.insert(first, last);
+                    erase(first, last);
+                    return ;
+                }
+                tree_type tail(this->_key_comp, this->_tree.getAllocator());
+                this->_tree.splitAt(lo, out._tree);
+                out._tree.splitAt(hi, tail);
+                this->_tree.append(tail);
+                this->_size = ft::treeSize(this->_tree.getRoot());
+                out._size = ft::treeSize(out._tree.getRoot());
+            };
+
+            //moves every element of x here; O(log n) when the ranges do not overlap,
+            //otherwise nodes are relinked one by one and duplicates are dropped.
+            //With allocators that compare unequal the elements are copied instead
+            void append(set& x)
+            {
+                if (this == &x || x.empty())
+                    return ;
+                if (!(this->_tree.getAllocator() == x._tree.getAllocator()))
+                {
+                    insert(x.begin(), x.end());
+                    x.clear();
+                    return ;
+                }
+                if (empty() || this->_key_comp(this->_tree.max(this->_tree.getRoot())->pair, x._tree.min(x._tree.getRoot())->pair))
+                    this->_tree.append(x._tree);
+                else if (this->_key_comp(x._tree.max(x._tree.getRoot())->pair, this->_tree.min(this->_tree.getRoot())->pair))
+                    this->_tree.prepend(x._tree);
+                else
+                    this->_tree.absorb(x._tree);
+                this->_size = ft::treeSize(this->_tree.getRoot());
+                x._size = 0;
+            };
+
+            /* node handles */
+            //detaches the node from the tree without freeing it
+            node_type extract(iterator pos)
+            {
+                node_ptr node = pos.getNode();
+                if (!node)
+                    return node_type();
+                this->_tree.unlink(node);
+                this->_size--;
+                return node_type(node, this->_tree.getAllocator());
+            };
+
+            node_type extract(const Key& key)
+            {
+                return extract(find(key));
+            };
+
+            //relinks the node held by nh; if the key is already present nh keeps it.
+            //A node from an allocator that compares unequal is copied and freed by its own
+            ft::pair<iterator, bool> insert(const node_type& nh)
+            {
+                node_ptr node = nh.get();
+                if (!node)
+                    return ft::pair<iterator, bool>(end(), false);
+                if (!(nh.get_allocator() == this->_tree.getAllocator()))
+                {
+                    ft::pair<iterator, bool> res = insert(node->pair);
+                    if (res.second)
+                        node_type dropped(nh);
+                    return res;
+                }
+                node_ptr res = this->_tree.insertUnique(node);
+                if (res == node)
+                {
+                    nh.release();
+                    this->_size++;
+                }
+                return ft::pair<iterator, bool>(iterator(res, this->_tree.getRoot()), res == node);
+            };
+
+            iterator insert(iterator, const node_type& nh)
+            {
+                return insert(nh).first;
+            };
+
+            //moves the elements of other that are not in this set, O(n + m), nodes are relinked;
+            //with allocators that compare unequal they are copied and erased from other instead
+            void merge(set& other)
+            {
+                if (this == &other)
+                    return ;
+                if (!(this->_tree.getAllocator() == other._tree.getAllocator()))
+                {
+                    iterator it = other.begin();
+                    while (it != other.end())
+                    {
+                        iterator next = it;
+                        ++next;
+                        if (insert(*it).second)
+                            other.erase(it);
+                        it = next;
+                    }
+                    return ;
+                }
+                this->_tree.merge(other._tree);
+                this->_size = ft::treeSize(this->_tree.getRoot());
+                other._size = ft::treeSize(other._tree.getRoot());
+            };
+
             /* look up */
             size_type count(const Key& key) const
             {
@@ -231,6 +362,61 @@ namespace ft
                 return const_iterator(this->_tree.find(key, this->_tree.getRoot()), this->_tree.getRoot());
             };
 
+            /* order statistics */
+            //k-th smallest element, end() if k >= size()
+            iterator nth(size_type k)
+            {
+                return iterator(this->_tree.select(this->_tree.getRoot(), k), this->_tree.getRoot());
+            };
+
+            const_iterator nth(size_type k) const
+            {
+                return const_iterator(this->_tree.select(this->_tree.getRoot(), k), this->_tree.getRoot());
+            };
+
+            //number of keys less than key
+            size_type rank(const Key& key) const
+            {
+                return this->_tree.rank(this->_tree.getRoot(), key);
+            };
+
+            //number of keys in [lo, hi)
+            size_type count_range(const Key& lo, const Key& hi) const
+            {
+                if (!this->_key_comp(lo, hi))
+                    return 0;
+                return rank(hi) - rank(lo);
+            };
+
+            //writes one iterator per key, end() when absent; the lookups are interleaved
+            template <class InputIt, class OutputIt>
+            OutputIt find_batch(InputIt first, InputIt last, OutputIt out)
+            {
+                return this->_tree.template findEach<iterator>(first, last, out, key_probe());
+            };
+
+            template <class InputIt, class OutputIt>
+            OutputIt find_batch(InputIt first, InputIt last, OutputIt out) const
+            {
+                return this->_tree.template findEach<const_iterator>(first, last, out, key_probe());
+            };
+
+            iterator find(iterator hint, const Key& key)
+            {
+                iterator it = lower_bound(hint, key);
+                if (it != end() && this->_key_comp(key, *it))
+                    return end();
+                return it;
+            };
+
+            const_iterator find(const_iterator hint, const Key& key) const
+            {
+                const_iterator it = lower_bound(hint, key);
+                if (it != end() && this->_key_comp(key, *it))
+                    return end();
+                return it;
+            };
+
             ft::pair<iterator, iterator> equal_range(const Key& key)
             {
                 return ft::make_pair(lower_bound(key), upper_bound(key));
@@ -251,6 +437,17 @@ namespace ft
                 return const_iterator(this->_tree.lower(this->_tree.getRoot(), key), this->_tree.getRoot());
             };
 
+            //finger search starting from hint, cheap when the key is close to it
+            iterator lower_bound(iterator hint, const Key& key)
+            {
+                return iterator(this->_tree.lowerFrom(hint.getNode(), key), this->_tree.getRoot());
+            };
+
+            const_iterator lower_bound(const_iterator hint, const Key& key) const
+            {
+                return const_iterator(this->_tree.lowerFrom(hint.getNode(), key), this->_tree.getRoot());
+            };
+
             iterator upper_bound(const Key& key)
             {
                 return iterator(this->_tree.upper(this->_tree.getRoot(), key), this->_tree.getRoot());            
@@ -271,6 +468,97 @@ namespace ft
             {
                 return this->_value_comp;
             };
+
+            template <class K, class C, class A>
+            friend void set_union(const set<K, C, A>& lhs, const set<K, C, A>& rhs, set<K, C, A>& result);
+
+            template <class K, class C, class A>
+            friend void set_intersection(const set<K, C, A>& lhs, const set<K, C, A>& rhs, set<K, C, A>& result);
+
+            template <class K, class C, class A>
+            friend void set_difference(const set<K, C, A>& lhs, const set<K, C, A>& rhs, set<K, C, A>& result);
+
+        private:
+            //one sorted pass over both trees, the kept keys are copied into fresh nodes
+            //and linked into a balanced tree, O(n + m)
+            void combine(const set& lhs, const set& rhs, bool keepLeft, bool keepBoth, bool keepRight)
+            {
+                node_ptr left = lhs._tree.min(lhs._tree.getRoot());
+                node_ptr right = rhs._tree.min(rhs._tree.getRoot());
+                node_ptr head = NULL;
+                node_ptr* tail = &head;
+                size_type count = 0;
+                node_ptr source = NULL;
+
+                while (left || right)
+                {
+                    source = NULL;
+                    if (right && (!left || this->_key_comp(right->pair, left->pair)))
+                    {
+                        if (keepRight)
+                            source = right;
+                        right = rhs._tree.next(right);
+                    }
+                    else if (!right || this->_key_comp(left->pair, right->pair))
+                    {
+                        if (keepLeft)
+                            source = left;
+                        left = lhs._tree.next(left);
+                    }
+                    else
+                    {
+                        if (keepBoth)
+                            source = left;
+                        left = lhs._tree.next(left);
+                        right = rhs._tree.next(right);
+                    }
+                    if (source)
+                    {
+                        *tail = this->_tree.createNode(source->pair);
+                        tail = &(*tail)->right;
+                        count++;
+                    }
+                }
+                *tail = NULL;
+                clear();
+                this->_tree.setRoot(this->_tree.buildFromList(head, count));
+                this->_size = count;
+            };
+    };
+
+    template <class Key, class Compare, class Alloc>
+    struct container_access<set<Key, Compare, Alloc> >
+    {
+        typedef set<Key, Compare, Alloc> container;
+
+        static typename container::tree_type& tree(container& set)
+        {
+            return set._tree;
+        };
+
+        static void setSize(container& set, typename container::size_type size)
+        {
+            set._size = size;
+        };
+    };
+
+    /* set algebra, result may alias either operand */
+    template <class Key, class Compare, class Alloc>
+    void set_union(const set<Key, Compare, Alloc>& lhs, const set<Key, Compare, Alloc>& rhs, set<Key, Compare, Alloc>& result)
+    {
+        result.combine(lhs, rhs, true, true, true);
+    };
+
+    template <class Key, class Compare, class Alloc>
+    void set_intersection(const set<Key, Compare, Alloc>& lhs, const set<Key, Compare, Alloc>& rhs, set<Key, Compare, Alloc>& result)
+    {
+        result.combine(lhs, rhs, false, true, false);
+    };
+
+    template <class Key, class Compare, class Alloc>
+    void set_difference(const set<Key, Compare, Alloc>& lhs, const set<Key, Compare, Alloc>& rhs, set<Key, Compare, Alloc>& result)
+    {
+        result.combine(lhs, rhs, true, false, false);
     };
 
     /* operators */
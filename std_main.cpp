@@ -1,12 +1,17 @@
 #include <iostream>
 
 #include <map>
+#include <set>
 #include <stack>
+#include <queue>
 #include <vector>
 #include <list>
+#include <iterator>
+#include <algorithm>
 #include "stack.hpp"
 #include "vector.hpp"
 #include "map.hpp"
+#include "set.hpp"
 #include "ft_iterator.hpp"
 #include "ft_map_iterator.hpp"
 #include "ft_reverse_iterator.hpp"
@@ -15,6 +20,39 @@
 #include <string>
 #include <sys/time.h>
 
+//keeps count of the elements allocated and not yet given back, so a deallocate() with the wrong size shows up
+template <typename T>
+struct counting_allocator: public std::allocator<T>
+{
+    static long outstanding;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef counting_allocator<U> other;
+    };
+
+    counting_allocator() {};
+    counting_allocator(const counting_allocator&): std::allocator<T>() {};
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) {};
+
+    T* allocate(size_t n, const void* = 0)
+    {
+        outstanding += static_cast<long>(n);
+        return std::allocator<T>::allocate(n);
+    };
+
+    void deallocate(T* p, size_t n)
+    {
+        outstanding -= static_cast<long>(n);
+        std::allocator<T>::deallocate(p, n);
+    };
+};
+
+template <typename T>
+long counting_allocator<T>::outstanding = 0;
+
 template <typename T>
 void print_vector(std::vector<T> vect)
 {
@@ -24,6 +62,299 @@ void print_vector(std::vector<T> vect)
     std::cout << std::endl;
 };
 
+template <typename Map>
+void print_map(const Map& map)
+{
+    for (typename Map::const_iterator it = map.begin(); it != map.end(); ++it)
+        std::cout << "[" << it->first << "; " << it->second << "]";
+    std::cout << std::endl;
+};
+
+template <typename Set>
+void print_set(const Set& set)
+{
+    for (typename Set::const_iterator it = set.begin(); it != set.end(); ++it)
+        std::cout << *it << " ";
+    std::cout << std::endl;
+};
+
+//std:: counterparts of the ft:: map and set extensions, built from their standard interface
+template <typename Container>
+typename Container::const_iterator nth(const Container& c, size_t k)
+{
+    typename Container::const_iterator it = c.begin();
+    std::advance(it, k < c.size() ? k : c.size());
+    return it;
+};
+
+template <typename Container>
+size_t rank(const Container& c, const typename Container::key_type& k)
+{
+    return std::distance(c.begin(), c.lower_bound(k));
+};
+
+template <typename Container>
+size_t count_range(const Container& c, const typename Container::key_type& lo, const typename Container::key_type& hi)
+{
+    if (!(lo < hi))
+        return 0;
+    return rank(c, hi) - rank(c, lo);
+};
+
+template <typename Container>
+void extract_range(Container& c, const typename Container::key_type& lo, const typename Container::key_type& hi, Container& out)
+{
+    out.clear();
+    if (!(lo < hi))
+        return ;
+    out.insert(c.lower_bound(lo), c.lower_bound(hi));
+    c.erase(c.lower_bound(lo), c.lower_bound(hi));
+};
+
+//keys already present stay as they are, like ft::map::append
+template <typename Container>
+void append(Container& c, Container& x)
+{
+    c.insert(x.begin(), x.end());
+    x.clear();
+};
+
+//result may alias either operand, as with ft::set_union and the others
+template <typename Set>
+void set_union(const Set& lhs, const Set& rhs, Set& result)
+{
+    Set tmp;
+    std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::inserter(tmp, tmp.end()));
+    result.swap(tmp);
+};
+
+template <typename Set>
+void set_intersection(const Set& lhs, const Set& rhs, Set& result)
+{
+    Set tmp;
+    std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::inserter(tmp, tmp.end()));
+    result.swap(tmp);
+};
+
+template <typename Set>
+void set_difference(const Set& lhs, const Set& rhs, Set& result)
+{
+    Set tmp;
+    std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), std::inserter(tmp, tmp.end()));
+    result.swap(tmp);
+};
+
+//moves the elements of other whose key is not in c yet
+template <typename Container>
+void merge(Container& c, Container& other)
+{
+    typename Container::iterator it = other.begin();
+    while (it != other.end())
+    {
+        typename Container::iterator next = it;
+        ++next;
+        if (c.insert(*it).second)
+            other.erase(it);
+        it = next;
+    }
+};
+
+//a std:: element held outside any container, in place of ft:: node handles
+template <typename Key, typename T>
+class map_node
+{
+    bool _empty;
+    Key _key;
+    mutable T _mapped;
+
+    public:
+        map_node(): _empty(true), _key(), _mapped() {};
+        map_node(const Key& key, const T& mapped): _empty(false), _key(key), _mapped(mapped) {};
+        bool empty() const { return this->_empty; };
+        const Key& key() const { return this->_key; };
+        T& mapped() const { return this->_mapped; };
+        void clear() { this->_empty = true; };
+};
+
+template <typename Key>
+class set_node
+{
+    bool _empty;
+    mutable Key _value;
+
+    public:
+        set_node(): _empty(true), _value() {};
+        explicit set_node(const Key& value): _empty(false), _value(value) {};
+        bool empty() const { return this->_empty; };
+        Key& value() const { return this->_value; };
+        void clear() { this->_empty = true; };
+};
+
+template <typename Key, typename T>
+map_node<Key, T> extract(std::map<Key, T>& map, typename std::map<Key, T>::iterator pos)
+{
+    if (pos == map.end())
+        return map_node<Key, T>();
+    map_node<Key, T> nh(pos->first, pos->second);
+    map.erase(pos);
+    return nh;
+};
+
+template <typename Key, typename T>
+map_node<Key, T> extract(std::map<Key, T>& map, const Key& key)
+{
+    return extract(map, map.find(key));
+};
+
+template <typename Key>
+set_node<Key> extract(std::set<Key>& set, const Key& key)
+{
+    typename std::set<Key>::iterator pos = set.find(key);
+    if (pos == set.end())
+        return set_node<Key>();
+    set_node<Key> nh(*pos);
+    set.erase(pos);
+    return nh;
+};
+
+//the handle is emptied only if its element went in
+template <typename Key, typename T>
+std::pair<typename std::map<Key, T>::iterator, bool> insert_node(std::map<Key, T>& map, map_node<Key, T>& nh)
+{
+    if (nh.empty())
+        return std::make_pair(map.end(), false);
+    std::pair<typename std::map<Key, T>::iterator, bool> res = map.insert(std::make_pair(nh.key(), nh.mapped()));
+    if (res.second)
+        nh.clear();
+    return res;
+};
+
+template <typename Key>
+std::pair<typename std::set<Key>::iterator, bool> insert_node(std::set<Key>& set, set_node<Key>& nh)
+{
+    if (nh.empty())
+        return std::make_pair(set.end(), false);
+    std::pair<typename std::set<Key>::iterator, bool> res = set.insert(nh.value());
+    if (res.second)
+        nh.clear();
+    return res;
+};
+
+//the hint only tells ft:: where to start searching, std:: gives the same answer without it
+template <typename Container, typename Iterator>
+typename Container::iterator hinted_lower_bound(Container& c, Iterator, const typename Container::key_type& key)
+{
+    return c.lower_bound(key);
+};
+
+template <typename Container, typename Iterator>
+typename Container::iterator hinted_find(Container& c, Iterator, const typename Container::key_type& key)
+{
+    return c.find(key);
+};
+
+//persistent_map::insert_or_assign; its snapshots are emulated by plain copies
+template <typename Map>
+bool insert_or_assign(Map& map, const typename Map::key_type& key, const typename Map::mapped_type& value)
+{
+    std::pair<typename Map::iterator, bool> res = map.insert(std::make_pair(key, value));
+    if (!res.second)
+        res.first->second = value;
+    return res.second;
+};
+
+//position-weighted sum over a map, so a missing, extra or misplaced element changes it
+template <typename Map>
+long digest(const Map& map)
+{
+    long res = 0;
+    long pos = 1;
+    for (typename Map::const_iterator it = map.begin(); it != map.end(); ++it, ++pos)
+        res += pos * (it->first * 31L + it->second);
+    return res;
+};
+
+//parallel::build: replaces the contents with [first, last), the first of equal keys kept
+template <typename Container, typename InputIt>
+void build(Container& c, InputIt first, InputIt last)
+{
+    c = Container(first, last);
+};
+
+//odd values before even ones, larger first within each
+struct odd_first
+{
+    bool operator()(int x, int y) const
+    {
+        if ((x & 1) != (y & 1))
+            return !(x & 1);
+        return x < y;
+    };
+};
+
+struct more
+{
+    bool operator()(int x, int y) const
+    {
+        return x > y;
+    };
+};
+
+//pops everything: the count, the first values and a position-weighted sum of all of them
+template <typename Queue>
+void drain(Queue& queue)
+{
+    long weighted = 0;
+    long pos = 1;
+    std::cout << "draining " << queue.size() << ":";
+    for (; !queue.empty(); ++pos)
+    {
+        if (pos <= 12)
+            std::cout << " " << queue.top();
+        weighted += pos * queue.top();
+        queue.pop();
+    }
+    std::cout << " ... weighted " << weighted << std::endl;
+};
+
+//priority_queue::push_range and pop_push
+template <typename Queue, typename InputIt>
+void push_range(Queue& queue, InputIt first, InputIt last)
+{
+    for (; first != last; ++first)
+        queue.push(*first);
+};
+
+template <typename Queue>
+void pop_push(Queue& queue, const typename Queue::value_type& value)
+{
+    queue.pop();
+    queue.push(value);
+};
+
+//find_batch: one find per key
+template <typename Container, typename InputIt, typename OutputIt>
+OutputIt find_batch(Container& c, InputIt first, InputIt last, OutputIt out)
+{
+    for (; first != last; ++first)
+        *out++ = c.find(*first);
+    return out;
+};
+
+//a comparator with state: the residue mod modulus first, then the value
+struct by_residue
+{
+    int modulus;
+
+    by_residue(int modulus = 1000): modulus(modulus) {};
+
+    bool operator()(int x, int y) const
+    {
+        return x % this->modulus < y % this->modulus || (x % this->modulus == y % this->modulus && x < y);
+    };
+};
+
+
 int main()
 {
     std::cout << "MAIN TESTING STD CONTAINERS\n"; 
@@ -204,6 +535,54 @@ int main()
     str_vect.push_back("vector");
     print_vector(str_vect);
 
+    std::cout << "\nTEST INSERT AT THE END AND OF NOTHING\n";
+    std::vector<std::string> grown(str_vect);
+    grown.insert(grown.end(), "tail");
+    grown.insert(grown.begin() + 2, 3, "x");
+    grown.insert(grown.begin(), 0, "never");
+    grown.insert(grown.end(), 2, "end");
+    print_vector(grown);
+    std::vector<int> none(0, 42);
+    std::cout << "filled with nothing: " << none.size() << std::endl;
+    none.insert(none.begin(), 0, 1);
+    none.insert(none.end(), 7);
+    none.insert(none.begin(), 2, 5);
+    print_vector(none);
+
+    std::cout << "\nTEST INSERT OF AN EMPTY RANGE\n";
+    int range_values[] = { 1, 2, 3 };
+    std::vector<int> range_target;
+    range_target.insert(range_target.begin(), range_values, range_values);
+    std::cout << "into an empty vector: " << range_target.size() << std::endl;
+    range_target.insert(range_target.end(), range_values, range_values + 3);
+    range_target.insert(range_target.begin() + 1, range_values + 1, range_values + 1);
+    range_target.insert(range_target.end(), range_values + 3, range_values + 3);
+    print_vector(range_target);
+
+    std::cout << "\nTEST DEALLOCATION SIZES\n";
+    {
+        std::vector<int, counting_allocator<int> > counted;
+        for (int i = 0; i < 5; i++)
+            counted.push_back(i);
+        counted.pop_back();
+        counted.reserve(20);
+        counted.push_back(9);
+        std::cout << "counted size: " << counted.size() << ", back: " << counted.back() << std::endl;
+    }
+    std::cout << "elements still allocated: " << counting_allocator<int>::outstanding << std::endl;
+
+    std::cout << "\nTEST ASSIGNMENT OVER A LARGER VECTOR\n";
+    {
+        std::vector<std::string, counting_allocator<std::string> > fewer(3, "few");
+        std::vector<std::string, counting_allocator<std::string> > more(10, "more");
+        more = fewer;
+        fewer.push_back("grown");
+        fewer = more;
+        more = more;
+        std::cout << fewer.size() << " " << fewer.back() << ", " << more.size() << " " << more.front() << std::endl;
+    }
+    std::cout << "strings still allocated: " << counting_allocator<std::string>::outstanding << std::endl;
+
     std::cout << "\n--------END TESTING VECTORS--------\n";
 
     std::cout << "\n----------TESTING STACK----------\n";
@@ -294,5 +673,470 @@ int main()
 
     std::cout << "\n--------END TESTING MAP--------\n";
 
+
+    std::cout << "\n----------TESTING ORDER STATISTICS----------\n";
+    std::map<int, int> ranked;
+    std::set<int> ranked_set;
+    for (int i = 0; i < 20; i++)
+    {
+        ranked.insert(std::make_pair(i * 7 % 20 * 3, i));
+        ranked_set.insert(i * 11 % 20 * 2);
+    }
+    print_map(ranked);
+    print_set(ranked_set);
+    std::cout << "nth 0: " << nth(ranked, 0)->first << std::endl;
+    std::cout << "nth 13: " << nth(ranked, 13)->first << std::endl;
+    std::cout << "nth size is end: " << (nth(ranked, ranked.size()) == ranked.end()) << std::endl;
+    std::cout << "set nth 7: " << *nth(ranked_set, 7) << std::endl;
+    std::cout << "rank 30: " << rank(ranked, 30) << std::endl;
+    std::cout << "rank 31: " << rank(ranked, 31) << std::endl;
+    std::cout << "rank -1: " << rank(ranked, -1) << std::endl;
+    std::cout << "rank 100: " << rank(ranked, 100) << std::endl;
+    std::cout << "set rank 15: " << rank(ranked_set, 15) << std::endl;
+    std::cout << "count_range 10 40: " << count_range(ranked, 10, 40) << std::endl;
+    std::cout << "count_range 40 10: " << count_range(ranked, 40, 10) << std::endl;
+    std::cout << "count_range 9 9: " << count_range(ranked, 9, 9) << std::endl;
+    std::cout << "set count_range 5 25: " << count_range(ranked_set, 5, 25) << std::endl;
+    ranked.erase(nth(ranked, 4)->first);
+    std::cout << "after erase, nth 4: " << nth(ranked, 4)->first << " rank 60: " << rank(ranked, 60) << std::endl;
+
+    std::cout << "\n--------END TESTING ORDER STATISTICS--------\n";
+
+    std::cout << "\n----------TESTING SPLIT AND JOIN----------\n";
+    std::map<int, int> whole;
+    std::map<int, int> middle;
+    for (int i = 0; i < 30; i++)
+        whole.insert(std::make_pair(i * 13 % 30, i));
+    extract_range(whole, 10, 20, middle);
+    std::cout << "extract_range 10 20:\n";
+    print_map(whole);
+    print_map(middle);
+    extract_range(whole, 25, 5, middle);
+    std::cout << "extract_range 25 5, sizes: " << whole.size() << " " << middle.size() << std::endl;
+    extract_range(whole, 28, 100, middle);
+    std::cout << "extract_range 28 100:\n";
+    print_map(whole);
+    print_map(middle);
+    std::map<int, int> tail;
+    tail.insert(std::make_pair(40, 0));
+    tail.insert(std::make_pair(41, 1));
+    append(whole, tail);
+    std::cout << "append after:\n";
+    print_map(whole);
+    std::cout << "appended map size: " << tail.size() << std::endl;
+    std::map<int, int> head;
+    head.insert(std::make_pair(-2, 0));
+    head.insert(std::make_pair(-1, 1));
+    append(whole, head);
+    std::cout << "append before:\n";
+    print_map(whole);
+    std::map<int, int> overlap;
+    for (int i = 5; i < 25; i += 3)
+        overlap.insert(std::make_pair(i, -i));
+    append(whole, overlap);
+    std::cout << "append overlapping:\n";
+    print_map(whole);
+    std::cout << "sizes: " << whole.size() << " " << overlap.size() << std::endl;
+
+    std::set<int> letters;
+    std::set<int> picked;
+    for (int i = 0; i < 26; i++)
+        letters.insert(i * 5 % 26);
+    extract_range(letters, 3, 9, picked);
+    print_set(letters);
+    print_set(picked);
+    append(letters, picked);
+    print_set(letters);
+    std::cout << "sizes: " << letters.size() << " " << picked.size() << std::endl;
+
+    std::cout << "\n--------END TESTING SPLIT AND JOIN--------\n";
+
+    std::cout << "\n----------TESTING SET ALGEBRA----------\n";
+    std::set<int> odd;
+    std::set<int> third;
+    std::set<int> result;
+    for (int i = 0; i < 30; i++)
+    {
+        if (i % 2)
+            odd.insert(i);
+        if (i % 3 == 0)
+            third.insert(i);
+    }
+    set_union(odd, third, result);
+    std::cout << "union: ";
+    print_set(result);
+    set_intersection(odd, third, result);
+    std::cout << "intersection: ";
+    print_set(result);
+    set_difference(odd, third, result);
+    std::cout << "difference: ";
+    print_set(result);
+    set_difference(third, odd, result);
+    std::cout << "reverse difference: ";
+    print_set(result);
+    set_intersection(odd, std::set<int>(), result);
+    std::cout << "intersection with empty: " << result.size() << std::endl;
+    std::set<int> alias(odd);
+    set_union(alias, third, alias);
+    std::cout << "union into lhs: ";
+    print_set(alias);
+    set_difference(odd, alias, alias);
+    std::cout << "difference into rhs: " << alias.size() << std::endl;
+    std::set<int> merged(odd);
+    std::set<int> rest(third);
+    merge(merged, rest);
+    std::cout << "merge: ";
+    print_set(merged);
+    std::cout << "left behind: ";
+    print_set(rest);
+    std::map<int, int> merged_map;
+    std::map<int, int> rest_map;
+    for (int i = 0; i < 10; i++)
+    {
+        merged_map.insert(std::make_pair(i * 2, i));
+        rest_map.insert(std::make_pair(i * 3, -i));
+    }
+    merge(merged_map, rest_map);
+    print_map(merged_map);
+    print_map(rest_map);
+
+    std::cout << "\n--------END TESTING SET ALGEBRA--------\n";
+
+    std::cout << "\n----------TESTING NODE HANDLES----------\n";
+    std::map<int, std::string> donor;
+    std::map<int, std::string> taker;
+    for (int i = 0; i < 8; i++)
+        donor.insert(std::make_pair(i, std::string(i + 1, 'a' + i)));
+    taker.insert(std::make_pair(3, std::string("taken")));
+    map_node<int, std::string> moved = extract(donor, 5);
+    std::cout << "extracted: " << moved.empty() << " [" << moved.key() << "; " << moved.mapped() << "]\n";
+    print_map(donor);
+    moved.mapped() = "moved";
+    std::pair<std::map<int, std::string>::iterator, bool> placed = insert_node(taker, moved);
+    std::cout << "inserted: " << placed.second << " " << placed.first->second << ", handle empty: " << moved.empty() << std::endl;
+    map_node<int, std::string> clash = extract(donor, 3);
+    placed = insert_node(taker, clash);
+    std::cout << "inserted over a present key: " << placed.second << " " << placed.first->second << ", handle kept: [" << clash.key() << "; " << clash.mapped() << "]\n";
+    print_map(taker);
+    map_node<int, std::string> missing = extract(donor, 42);
+    std::cout << "extract missing, empty: " << missing.empty() << ", insert: " << insert_node(taker, missing).second << std::endl;
+    map_node<int, std::string> first = extract(donor, donor.begin());
+    std::cout << "extract begin: " << first.key() << " size " << donor.size() << std::endl;
+    insert_node(donor, clash);
+    insert_node(donor, first);
+    print_map(donor);
+    std::set<int> from_set;
+    std::set<int> to_set;
+    for (int i = 0; i < 6; i++)
+        from_set.insert(i * i);
+    set_node<int> square = extract(from_set, 9);
+    std::cout << "set extracted: " << square.value() << std::endl;
+    std::cout << "set inserted: " << insert_node(to_set, square).second << ", handle empty: " << square.empty() << std::endl;
+    print_set(from_set);
+    print_set(to_set);
+
+    std::cout << "\n--------END TESTING NODE HANDLES--------\n";
+
+    std::cout << "\n----------TESTING HINTED LOOKUPS----------\n";
+    std::map<int, int> sparse;
+    std::set<int> sparse_set;
+    for (int i = 0; i < 200; i++)
+    {
+        sparse.insert(std::make_pair(i * 5, i));
+        sparse_set.insert(i * 7);
+    }
+    std::map<int, int>::iterator hint = sparse.find(500);
+    int probes[] = { 500, 502, 505, 480, 0, -3, 995, 996, 1200 };
+    for (size_t i = 0; i < sizeof(probes) / sizeof(probes[0]); i++)
+    {
+        std::map<int, int>::iterator lower = hinted_lower_bound(sparse, hint, probes[i]);
+        std::map<int, int>::iterator found = hinted_find(sparse, hint, probes[i]);
+        std::cout << probes[i] << ": lower_bound ";
+        if (lower == sparse.end())
+            std::cout << "end";
+        else
+            std::cout << lower->first;
+        std::cout << ", find " << (found == sparse.end() ? -1 : found->second) << std::endl;
+    }
+    std::cout << "from begin: " << hinted_lower_bound(sparse, sparse.begin(), 733)->first << std::endl;
+    std::cout << "from end: " << hinted_lower_bound(sparse, sparse.end(), 733)->first << std::endl;
+    std::set<int>::iterator set_hint = sparse_set.begin();
+    int walked = 0;
+    for (int key = 0; key < 1400; key += 50)
+    {
+        set_hint = hinted_lower_bound(sparse_set, set_hint, key);
+        walked += *set_hint;
+    }
+    std::cout << "set ascending walk: " << walked << std::endl;
+    std::cout << "set find 700: " << (hinted_find(sparse_set, sparse_set.end(), 700) != sparse_set.end()) << std::endl;
+    std::cout << "set find 701: " << (hinted_find(sparse_set, sparse_set.begin(), 701) != sparse_set.end()) << std::endl;
+
+    std::cout << "\n--------END TESTING HINTED LOOKUPS--------\n";
+    std::cout << "\n----------TESTING PERSISTENT SNAPSHOTS----------\n";
+    std::string digits[] = { "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine" };
+    std::map<int, std::string> current;
+    for (int i = 0; i < 10; i++)
+        current.insert(std::make_pair(i * 2, digits[i]));
+    std::map<int, std::string> first_version = current;
+    bool was_new = current.insert(std::make_pair(4, std::string("four"))).second;
+    std::cout << "insert present: " << was_new << std::endl;
+    was_new = insert_or_assign(current, 4, "FOUR");
+    std::cout << "assign present: " << was_new << std::endl;
+    was_new = insert_or_assign(current, 5, "five");
+    std::cout << "assign new: " << was_new << std::endl;
+    std::cout << "erase 10: " << current.erase(10) << std::endl;
+    std::cout << "erase 11: " << current.erase(11) << std::endl;
+    std::map<int, std::string> second_version = current;
+    for (int i = 0; i < 20; i += 3)
+        current.erase(i);
+    current.insert(std::make_pair(100, std::string("hundred")));
+    print_map(first_version);
+    print_map(second_version);
+    print_map(current);
+    std::cout << "sizes: " << first_version.size() << " " << second_version.size() << " " << current.size() << std::endl;
+    std::cout << "at 4: " << first_version.at(4) << " " << second_version.at(4) << std::endl;
+    try
+    {
+        std::cout << current.at(6) << std::endl;
+    }
+    catch (std::out_of_range&)
+    {
+        std::cout << "at 6 after erase: out_of_range" << std::endl;
+    }
+    std::cout << "count 5: " << first_version.count(5) << " " << second_version.count(5) << " " << current.count(5) << std::endl;
+    std::cout << "find 5 in first_version: " << (first_version.find(5) == first_version.end()) << std::endl;
+    std::cout << "lower_bound 7: " << first_version.lower_bound(7)->first << " " << second_version.lower_bound(7)->first << " " << current.lower_bound(7)->first << std::endl;
+    std::cout << "lower_bound 101 is end: " << (current.lower_bound(101) == current.end()) << std::endl;
+    first_version = current;
+    current.clear();
+    std::cout << "assigned then cleared: " << first_version.size() << " " << current.empty() << std::endl;
+    print_map(first_version);
+    print_map(second_version);
+
+    std::cout << "\n--------END TESTING PERSISTENT SNAPSHOTS--------\n";
+    std::cout << "\n----------TESTING INCREMENTAL GROWTH----------\n";
+    std::vector<std::string> spread;
+    for (int i = 0; i < 40; i++)
+    {
+        spread.push_back(std::string(i % 5 + 1, static_cast<char>('a' + i % 26)));
+        if ((i & (i + 1)) == 0 || i % 10 == 9)
+            std::cout << "size " << spread.size() << ", front " << spread.front() << ", back " << spread.back()
+                << ", middle " << spread[spread.size() / 2] << ", at 0 " << spread.at(0) << std::endl;
+    }
+    for (int i = 0; i < 7; i++)
+        spread.pop_back();
+    std::cout << "after pop_back: " << spread.size() << " " << spread.back() << std::endl;
+    spread[3] = "written";
+    for (int i = 0; i < 30; i++)
+        spread.push_back("more");
+    std::vector<std::string> spread_copy(spread);
+    spread.erase(spread.begin() + 1, spread.begin() + 5);
+    std::cout << "copy " << spread_copy.size() << " " << spread_copy[3] << ", erased " << spread.size() << " " << spread[1] << std::endl;
+    std::string joined;
+    for (std::vector<std::string>::iterator it = spread.begin(); it != spread.end(); ++it)
+        joined += *it;
+    std::cout << joined << std::endl;
+    spread.clear();
+    std::vector<int> numbers;
+    long total = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        numbers.push_back(i);
+        total += numbers[i / 2];
+    }
+    std::vector<int> swapped;
+    swapped.swap(numbers);
+    for (int i = 0; i < 3; i++)
+        swapped.push_back(-i);
+    swapped.resize(1010, 7);
+    std::cout << "numbers: " << numbers.size() << ", swapped: " << swapped.size() << " " << swapped[999] << " " << swapped.back() << ", total " << total << std::endl;
+    print_vector(std::vector<int>(swapped.begin() + 995, swapped.end()));
+
+    std::vector<int> pending;
+    for (int i = 0; i < 20; i++)
+        pending.push_back(i * i);
+    const std::vector<int>& reader = pending;
+    std::vector<int> twin(pending);
+    std::cout << "pending: " << reader.size() << " " << reader[5] << " " << reader.front() << " " << reader.back() << ", equal " << (reader == twin);
+    twin.back() = 0;
+    std::cout << ", less " << (twin < reader) << " " << (reader < twin) << std::endl;
+    for (std::vector<int>::const_iterator it = reader.begin(); it != reader.end(); ++it)
+        std::cout << *it << " ";
+    std::cout << std::endl;
+    std::vector<int> plain;
+    plain.swap(pending);
+    std::cout << "incremental after swap: 1 0" << std::endl;
+
+    std::cout << "\n--------END TESTING INCREMENTAL GROWTH--------\n";
+    std::cout << "\n----------TESTING PARALLEL BUILD----------\n";
+    std::vector<std::pair<int, int> > build_input;
+    for (int i = 0; i < 10000; i++)
+        build_input.push_back(std::make_pair(i * 7919 % 6007, i));
+    std::map<int, int> built;
+    built.insert(std::make_pair(-1, -1));
+    build(built, build_input.begin(), build_input.end());
+    std::map<int, int> built_alone;
+    build(built_alone, build_input.begin(), build_input.end());
+    std::cout << "map: " << built.size() << " digest " << digest(built) << ", one thread equal: " << (built == built_alone) << std::endl;
+    std::cout << "first of equal keys: " << built[0] << " " << built[100] << " " << built[6006] << ", count -1: " << built.count(-1) << std::endl;
+    std::cout << "nth 0: " << nth(built, 0)->first << ", nth 3000: " << nth(built, 3000)->first << ", nth 6006: " << nth(built, 6006)->first << std::endl;
+    for (int i = 0; i < 6007; i += 3)
+        built.erase(i);
+    for (int i = 6007; i < 6100; i++)
+        built.insert(std::make_pair(i, -i));
+    std::cout << "updated: " << built.size() << " digest " << digest(built) << ", lower_bound 3000: " << built.lower_bound(3000)->first << std::endl;
+    std::vector<std::pair<int, int> > few;
+    few.push_back(std::make_pair(3, 30));
+    few.push_back(std::make_pair(1, 10));
+    few.push_back(std::make_pair(3, 31));
+    few.push_back(std::make_pair(2, 20));
+    few.push_back(std::make_pair(1, 11));
+    build(built, few.begin(), few.end());
+    print_map(built);
+    build(built, few.begin(), few.begin());
+    std::cout << "from nothing: " << built.size() << " " << built.empty() << " " << (built.begin() == built.end()) << std::endl;
+    built.insert(std::make_pair(5, 50));
+    print_map(built);
+    std::vector<int> set_input;
+    for (int i = 0; i < 9000; i++)
+        set_input.push_back(i * 31 % 5000);
+    std::set<int> built_set;
+    build(built_set, set_input.begin(), set_input.end());
+    std::set<int> built_set_alone;
+    build(built_set_alone, set_input.begin(), set_input.end());
+    int set_sum = 0;
+    for (std::set<int>::iterator it = built_set.begin(); it != built_set.end(); ++it)
+        set_sum += *it;
+    std::cout << "set: " << built_set.size() << " sum " << set_sum << ", one thread equal: " << (built_set == built_set_alone) << ", nth 4321: " << *nth(built_set, 4321) << std::endl;
+    build(built_set, set_input.begin(), set_input.begin() + 1);
+    print_set(built_set);
+
+    std::cout << "\n--------END TESTING PARALLEL BUILD--------\n";
+    std::cout << "\n----------TESTING PRIORITY QUEUE----------\n";
+    int heap_values[] = { 5, 1, 9, 3, 9, 7, 2, 8, 1, 6, 4, 9, 0, 5, 5 };
+    int heap_count = sizeof(heap_values) / sizeof(heap_values[0]);
+    std::vector<int> heap_many;
+    for (int i = 0; i < 1000; i++)
+        heap_many.push_back(i * 37 % 101);
+    std::priority_queue<int> heaped(heap_values, heap_values + heap_count);
+    std::cout << "heapified: " << heaped.size() << " top " << heaped.top() << std::endl;
+    heaped.push(11);
+    heaped.push(-2);
+    heaped.push(9);
+    push_range(heaped, heap_values, heap_values + 4);
+    pop_push(heaped, 3);
+    pop_push(heaped, 20);
+    std::priority_queue<int> heaped_copy(heaped);
+    drain(heaped);
+    push_range(heaped_copy, heap_many.begin(), heap_many.end());
+    pop_push(heaped_copy, 50);
+    heaped = heaped_copy;
+    drain(heaped_copy);
+    push_range(heaped, heap_values, heap_values);
+    std::cout << "assigned: " << heaped.size() << " top " << heaped.top() << std::endl;
+    std::priority_queue<int> from_container(std::less<int>(), std::vector<int>(heap_values, heap_values + 6));
+    from_container.push(4);
+    drain(from_container);
+    std::priority_queue<int, std::vector<int>, odd_first> odd_heap;
+    for (int i = 0; i < 200; i++)
+        odd_heap.push(i * 53 % 97 - 40);
+    push_range(odd_heap, heap_values, heap_values + heap_count);
+    for (int i = 0; i < 50; i++)
+        pop_push(odd_heap, i * 7 % 13 - 6);
+    drain(odd_heap);
+    std::priority_queue<int, std::vector<int>, more> min_heap(heap_many.begin(), heap_many.begin() + 300);
+    for (int i = 0; i < 100; i++)
+        min_heap.pop();
+    push_range(min_heap, heap_many.begin() + 300, heap_many.end());
+    push_range(min_heap, heap_values, heap_values + heap_count);
+    drain(min_heap);
+
+    std::cout << "\n--------END TESTING PRIORITY QUEUE--------\n";
+    std::cout << "\n----------TESTING BATCHED LOOKUPS----------\n";
+    std::map<int, std::string> batched;
+    for (int i = 0; i < 100; i++)
+        batched.insert(std::make_pair(i * 3, std::string(1, static_cast<char>('a' + i % 26))));
+    std::vector<int> probe_keys;
+    for (int i = -4; i < 60; i++)
+        probe_keys.push_back(i * 7 % 311);
+    std::vector<std::map<int, std::string>::iterator> found(probe_keys.size());
+    find_batch(batched, probe_keys.begin(), probe_keys.end(), found.begin());
+    int hits = 0;
+    for (size_t i = 0; i < found.size(); i++)
+    {
+        if (found[i] == batched.end())
+            std::cout << probe_keys[i] << ":end ";
+        else
+        {
+            std::cout << probe_keys[i] << ":" << found[i]->second << " ";
+            found[i]->second += "!";
+            hits++;
+        }
+    }
+    std::cout << std::endl << "hits: " << hits << std::endl;
+    const std::map<int, std::string>& batched_const = batched;
+    std::vector<std::map<int, std::string>::const_iterator> found_const(probe_keys.size() + 1);
+    std::vector<std::map<int, std::string>::const_iterator>::iterator written = find_batch(batched_const, probe_keys.begin() + 10, probe_keys.end(), found_const.begin());
+    std::cout << "written: " << (written - found_const.begin()) << std::endl;
+    for (size_t i = 0; i + 10 < probe_keys.size(); i++)
+        std::cout << (found_const[i] == batched_const.end() ? std::string("end") : found_const[i]->second) << " ";
+    std::cout << std::endl;
+    std::cout << "empty batch: " << (find_batch(batched, probe_keys.begin(), probe_keys.begin(), found.begin()) == found.begin()) << std::endl;
+    std::map<int, std::string> no_keys;
+    find_batch(no_keys, probe_keys.begin(), probe_keys.begin() + 20, found.begin());
+    int misses = 0;
+    for (size_t i = 0; i < 20; i++)
+        misses += found[i] == no_keys.end();
+    std::cout << "empty map misses: " << misses << std::endl;
+    std::set<int> batched_set;
+    for (int i = 0; i < 40; i++)
+        batched_set.insert(i * i);
+    std::vector<std::set<int>::iterator> found_in_set(51);
+    find_batch(batched_set, probe_keys.begin(), probe_keys.begin() + 51, found_in_set.begin());
+    for (size_t i = 0; i < found_in_set.size(); i++)
+    {
+        if (found_in_set[i] == batched_set.end())
+            std::cout << "end ";
+        else
+            std::cout << *found_in_set[i] << " ";
+    }
+    std::cout << std::endl;
+    const std::set<int>& batched_set_const = batched_set;
+    std::vector<std::set<int>::const_iterator> found_in_set_const(17);
+    find_batch(batched_set_const, probe_keys.end() - 17, probe_keys.end(), found_in_set_const.begin());
+    for (size_t i = 0; i < found_in_set_const.size(); i++)
+        std::cout << (found_in_set_const[i] == batched_set_const.end() ? -1 : *found_in_set_const[i]) << " ";
+    std::cout << std::endl;
+
+    std::cout << "\n--------END TESTING BATCHED LOOKUPS--------\n";    std::cout << "\n----------TESTING STATEFUL COMPARATORS----------\n";
+    std::map<int, int, by_residue> by_seven(by_residue(7));
+    std::set<int, by_residue> by_five(by_residue(5));
+    for (int i = 0; i < 30; i++)
+    {
+        by_seven.insert(std::make_pair(i * 3, i));
+        by_five.insert(i * 2);
+    }
+    print_map(by_seven);
+    print_set(by_five);
+    std::cout << "find 27: " << by_seven.find(27)->second << ", lower_bound 10: " << by_seven.lower_bound(10)->first
+        << ", count 8: " << by_five.count(8) << ", upper_bound 8: " << *by_five.upper_bound(8) << std::endl;
+    std::map<int, int, by_residue> seven_copy(by_seven);
+    std::map<int, int, by_residue> seven_assigned;
+    seven_assigned.insert(std::make_pair(999, 0));
+    seven_assigned = by_seven;
+    seven_assigned.insert(std::make_pair(100, -1));
+    seven_copy.insert(std::make_pair(101, -2));
+    print_map(seven_assigned);
+    print_map(seven_copy);
+    std::map<int, int, by_residue> slice(by_residue(7));
+    extract_range(by_seven, 14, 16, slice);
+    print_map(slice);
+    std::cout << "left: " << by_seven.size() << std::endl;
+    std::set<int, by_residue> five_copy(by_five);
+    five_copy.insert(11);
+    print_set(five_copy);
+
+    std::cout << "\n--------END TESTING STATEFUL COMPARATORS--------\n";
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,274 @@
+#ifndef THREAD_CACHE_ALLOCATOR_HPP
+# define THREAD_CACHE_ALLOCATOR_HPP
+
+#include <new>
+#include <vector>
+#include <cstddef>
+#include "concurrency.hpp"
+
+namespace ft
+{
+    struct cache_block
+    {
+        cache_block* next;
+    };
+
+    // Small-object memory behind thread_cache_allocator. Blocks come in size
+    // classes of 16 bytes up to maxBytes; each thread keeps a free list per class
+    // and only talks to the shared pool to move a whole batch of blocks, so a
+    // thread that allocates and frees nodes of its own map takes no lock at all
+    // in the common case. A thread that holds too many free blocks hands a batch
+    // back; a thread that exits hands back everything it holds.
+    // Memory is carved from spans that are never returned to the system: a
+    // freed block can be reused by any thread but never goes back to malloc.
+    class thread_cache_pool
+    {
+        public:
+            static const std::size_t granularity = 16;
+            static const std::size_t classes = 32;
+            static const std::size_t maxBytes = granularity * classes;
+            static const std::size_t batchBlocks = 32;
+            static const std::size_t spanBytes = 1 << 16;
+
+        private:
+            struct batch
+            {
+                cache_block* head;
+                std::size_t count;
+            };
+
+            struct central
+            {
+                ft::mutex lock;
+                std::vector<batch> batches;
+                char pad[FT_CACHE_LINE];
+            };
+
+            struct thread_cache
+            {
+                cache_block* free[classes];
+                std::size_t count[classes];
+            };
+
+            central _central[classes];
+            pthread_key_t _key;
+
+            thread_cache_pool(thread_cache_pool const &);
+            thread_cache_pool& operator=(thread_cache_pool const &);
+
+            thread_cache_pool()
+            {
+                pthread_key_create(&this->_key, threadExit);
+            };
+
+            static thread_cache*& localCache()
+            {
+                static __thread thread_cache* cache = NULL;
+                return cache;
+            };
+
+            //the pthread key destructor: the exiting thread's blocks go back to the pool
+            static void threadExit(void* arg)
+            {
+                thread_cache* cache = static_cast<thread_cache*>(arg);
+                for (std::size_t cls = 0; cls < classes; ++cls)
+                    while (cache->free[cls])
+                        instance().giveBack(cache, cls, batchBlocks);
+                localCache() = NULL;
+                delete cache;
+            };
+
+            thread_cache* cache()
+            {
+                thread_cache* cache = localCache();
+                if (cache)
+                    return cache;
+                cache = new thread_cache;
+                for (std::size_t cls = 0; cls < classes; ++cls)
+                {
+                    cache->free[cls] = NULL;
+                    cache->count[cls] = 0;
+                }
+                localCache() = cache;
+                pthread_setspecific(this->_key, cache);
+                return cache;
+            };
+
+            void pushBatch(std::size_t cls, cache_block* head, std::size_t count)
+            {
+                batch b = { head, count };
+                ft::lock_guard<ft::mutex> guard(this->_central[cls].lock);
+                this->_central[cls].batches.push_back(b);
+            };
+
+            //moves up to count blocks from the front of the thread's list to the pool
+            void giveBack(thread_cache* cache, std::size_t cls, std::size_t count)
+            {
+                cache_block* head = cache->free[cls];
+                cache_block* tail = head;
+                std::size_t n = 1;
+                for (; n < count && tail->next; ++n)
+                    tail = tail->next;
+                cache->free[cls] = tail->next;
+                cache->count[cls] -= n;
+                tail->next = NULL;
+                pushBatch(cls, head, n);
+            };
+
+            //a batch from the pool, or a fresh span cut into batches when it has none
+            void refill(thread_cache* cache, std::size_t cls)
+            {
+                {
+                    ft::lock_guard<ft::mutex> guard(this->_central[cls].lock);
+                    std::vector<batch>& batches = this->_central[cls].batches;
+                    if (!batches.empty())
+                    {
+                        cache->free[cls] = batches.back().head;
+                        cache->count[cls] = batches.back().count;
+                        batches.pop_back();
+                        return ;
+                    }
+                }
+                std::size_t size = (cls + 1) * granularity;
+                std::size_t blocks = spanBytes / size;
+                char* span = static_cast<char*>(::operator new(blocks * size));
+                for (std::size_t first = 0; first < blocks; first += batchBlocks)
+                {
+                    std::size_t last = first + batchBlocks < blocks ? first + batchBlocks : blocks;
+                    for (std::size_t i = first; i < last; ++i)
+                        reinterpret_cast<cache_block*>(span + i * size)->next = i + 1 < last ? reinterpret_cast<cache_block*>(span + (i + 1) * size) : NULL;
+                    if (first)
+                        pushBatch(cls, reinterpret_cast<cache_block*>(span + first * size), last - first);
+                }
+                cache->free[cls] = reinterpret_cast<cache_block*>(span);
+                cache->count[cls] = blocks < batchBlocks ? blocks : batchBlocks;
+            };
+
+        public:
+            //never destroyed, so containers torn down at exit can still free into it
+            static thread_cache_pool& instance()
+            {
+                static thread_cache_pool* pool = new thread_cache_pool;
+                return *pool;
+            };
+
+            static std::size_t classOf(std::size_t bytes)
+            {
+                return bytes ? (bytes - 1) / granularity : 0;
+            };
+
+            //bytes must not exceed maxBytes
+            void* allocate(std::size_t bytes)
+            {
+                thread_cache* cache = this->cache();
+                std::size_t cls = classOf(bytes);
+                if (!cache->free[cls])
+                    refill(cache, cls);
+                cache_block* block = cache->free[cls];
+                cache->free[cls] = block->next;
+                --cache->count[cls];
+                return block;
+            };
+
+            void deallocate(void* p, std::size_t bytes)
+            {
+                thread_cache* cache = this->cache();
+                std::size_t cls = classOf(bytes);
+                cache_block* block = static_cast<cache_block*>(p);
+                block->next = cache->free[cls];
+                cache->free[cls] = block;
+                //keep one batch in hand so alternating allocate/free does not bounce
+                if (++cache->count[cls] > 2 * batchBlocks)
+                    giveBack(cache, cls, batchBlocks);
+            };
+    };
+
+    // Stateless drop-in Alloc for ft::map and ft::set (and anything else) that
+    // serves requests of up to thread_cache_pool::maxBytes from the calling
+    // thread's free lists; bigger ones go to operator new. Memory freed by
+    // another thread than the one that allocated it is fine. Alignment is that
+    // of the 16-byte size classes.
+    template <class T>
+    class thread_cache_allocator
+    {
+        public:
+            typedef T value_type;
+            typedef T* pointer;
+            typedef const T* const_pointer;
+            typedef T& reference;
+            typedef const T& const_reference;
+            typedef std::size_t size_type;
+            typedef std::ptrdiff_t difference_type;
+
+            template <class U>
+            struct rebind
+            {
+                typedef thread_cache_allocator<U> other;
+            };
+
+            thread_cache_allocator() {};
+
+            thread_cache_allocator(const thread_cache_allocator&) {};
+
+            template <class U>
+            thread_cache_allocator(const thread_cache_allocator<U>&) {};
+
+            pointer allocate(size_type n, const void* = 0)
+            {
+                if (n > max_size())
+                    throw std::bad_alloc();
+                if (n * sizeof(T) > thread_cache_pool::maxBytes)
+                    return static_cast<pointer>(::operator new(n * sizeof(T)));
+                return static_cast<pointer>(thread_cache_pool::instance().allocate(n * sizeof(T)));
+            };
+
+            void deallocate(pointer p, size_type n)
+            {
+                if (!p)
+                    return ;
+                if (n * sizeof(T) > thread_cache_pool::maxBytes)
+                    ::operator delete(p);
+                else
+                    thread_cache_pool::instance().deallocate(p, n * sizeof(T));
+            };
+
+            void construct(pointer p, const_reference value)
+            {
+                new (static_cast<void*>(p)) T(value);
+            };
+
+            void destroy(pointer p)
+            {
+                p->~T();
+            };
+
+            pointer address(reference x) const
+            {
+                return &x;
+            };
+
+            const_pointer address(const_reference x) const
+            {
+                return &x;
+            };
+
+            size_type max_size() const
+            {
+                return static_cast<size_type>(-1) / sizeof(T);
+            };
+    };
+
+    template <class T, class U>
+    bool operator==(const thread_cache_allocator<T>&, const thread_cache_allocator<U>&)
+    {
+        return true;
+    };
+
+    template <class T, class U>
+    bool operator!=(const thread_cache_allocator<T>&, const thread_cache_allocator<U>&)
+    {
+        return false;
+    };
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef THREAD_POOL_HPP
+# define THREAD_POOL_HPP
+
+#include <deque>
+#include <unistd.h>
+#include <sched.h>
+#include "concurrency.hpp"
+
+namespace ft
+{
+    class thread_pool;
+
+    //tasks spawned into a group are waited for together
+    struct task_group
+    {
+        std::size_t pending;
+
+        task_group(): pending(0) {};
+    };
+
+    struct pool_task
+    {
+        void (*run)(void*);
+        void* arg;
+        task_group* group;
+    };
+
+    //which pool queue the calling thread owns, if any
+    struct pool_slot
+    {
+        thread_pool* pool;
+        std::size_t index;
+    };
+
+    inline pool_slot& currentSlot()
+    {
+        static __thread pool_slot slot = { NULL, 0 };
+        return slot;
+    };
+
+    // Work-stealing pool. Every worker owns a deque: it pushes and pops its own
+    // tasks at the back, so recently split work stays hot in its cache, and idle
+    // workers steal from the front of the others, where the biggest pieces sit.
+    // Threads outside the pool share one extra deque. A pool of n threads starts
+    // n - 1 workers because the thread that waits on a group runs tasks too,
+    // so thread_pool(1) runs everything on the caller. Workers the system
+    // refuses to start are left out, size() then counts only those running.
+    // Arguments are passed as void*: a task's arguments must outlive it, which
+    // holds when they live in the frame of the function that waits for it.
+    class thread_pool
+    {
+        struct queue
+        {
+            ft::mutex lock;
+            std::deque<pool_task> tasks;
+            char pad[FT_CACHE_LINE];
+        };
+
+        queue* _queues;
+        pthread_t* _workers;
+        std::size_t _threads;
+        std::size_t _started;
+        std::size_t _queued;
+        std::size_t _sleepers;
+        bool _stop;
+        ft::mutex _sleepLock;
+        ft::condition_variable _wake;
+
+        thread_pool(thread_pool const &);
+        thread_pool& operator=(thread_pool const &);
+
+        struct start
+        {
+            thread_pool* pool;
+            std::size_t index;
+        };
+
+        static void* workerMain(void* arg)
+        {
+            start* s = static_cast<start*>(arg);
+            thread_pool* pool = s->pool;
+            std::size_t index = s->index;
+            delete s;
+            currentSlot().pool = pool;
+            currentSlot().index = index;
+            pool->work(index);
+            return NULL;
+        };
+
+        std::size_t ownQueue() const
+        {
+            if (currentSlot().pool == this)
+                return currentSlot().index;
+            return this->_threads - 1;
+        };
+
+        bool popBack(std::size_t index, pool_task& task)
+        {
+            queue& q = this->_queues[index];
+            ft::lock_guard<ft::mutex> guard(q.lock);
+            if (q.tasks.empty())
+                return false;
+            task = q.tasks.back();
+            q.tasks.pop_back();
+            return true;
+        };
+
+        bool popFront(std::size_t index, pool_task& task)
+        {
+            queue& q = this->_queues[index];
+            ft::lock_guard<ft::mutex> guard(q.lock);
+            if (q.tasks.empty())
+                return false;
+            task = q.tasks.front();
+            q.tasks.pop_front();
+            return true;
+        };
+
+        //runs one task from the own queue or a stolen one, false if all queues were empty
+        bool runOne(std::size_t self)
+        {
+            pool_task task;
+            bool found = popBack(self, task);
+            for (std::size_t i = 0, victim = threadRandom(); !found && i < this->_threads; ++i)
+                found = popFront((victim + i) % this->_threads, task);
+            if (!found)
+                return false;
+            __atomic_sub_fetch(&this->_queued, 1, __ATOMIC_SEQ_CST);
+            task.run(task.arg);
+            __atomic_sub_fetch(&task.group->pending, 1, __ATOMIC_RELEASE);
+            return true;
+        };
+
+        void work(std::size_t self)
+        {
+            while (!__atomic_load_n(&this->_stop, __ATOMIC_ACQUIRE))
+            {
+                if (runOne(self))
+                    continue ;
+                ft::lock_guard<ft::mutex> guard(this->_sleepLock);
+                __atomic_add_fetch(&this->_sleepers, 1, __ATOMIC_SEQ_CST);
+                while (!__atomic_load_n(&this->_queued, __ATOMIC_SEQ_CST) && !this->_stop)
+                    this->_wake.wait(this->_sleepLock);
+                __atomic_sub_fetch(&this->_sleepers, 1, __ATOMIC_SEQ_CST);
+            }
+        };
+
+        public:
+            //threads counts the caller; 0 means one per online CPU
+            explicit thread_pool(std::size_t threads = 0): _queues(NULL), _workers(NULL), _threads(threads), _started(0), _queued(0), _sleepers(0), _stop(false)
+            {
+                if (!this->_threads)
+                    this->_threads = hardware_threads();
+                this->_queues = new queue[this->_threads];
+                this->_workers = new pthread_t[this->_threads - 1];
+                for (std::size_t i = 0; i + 1 < this->_threads; ++i)
+                {
+                    start* s = new start;
+                    s->pool = this;
+                    s->index = i;
+                    //a queue without its worker is only ever stolen from
+                    if (pthread_create(&this->_workers[i], NULL, workerMain, s))
+                    {
+                        delete s;
+                        break ;
+                    }
+                    ++this->_started;
+                }
+            };
+
+            ~thread_pool()
+            {
+                {
+                    ft::lock_guard<ft::mutex> guard(this->_sleepLock);
+                    __atomic_store_n(&this->_stop, true, __ATOMIC_RELEASE);
+                    this->_wake.notify_all();
+                }
+                for (std::size_t i = 0; i < this->_started; ++i)
+                    pthread_join(this->_workers[i], NULL);
+                delete[] this->_workers;
+                delete[] this->_queues;
+            };
+
+            static std::size_t hardware_threads()
+            {
+                long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+                return cpus > 0 ? static_cast<std::size_t>(cpus) : 1;
+            };
+
+            std::size_t size() const
+            {
+                return this->_started + 1;
+            };
+
+            void spawn(task_group& group, void (*run)(void*), void* arg)
+            {
+                pool_task task = { run, arg, &group };
+                __atomic_add_fetch(&group.pending, 1, __ATOMIC_RELAXED);
+                //counted before it is queued so the count never drops below zero
+                __atomic_add_fetch(&this->_queued, 1, __ATOMIC_SEQ_CST);
+                {
+                    queue& q = this->_queues[ownQueue()];
+                    ft::lock_guard<ft::mutex> guard(q.lock);
+                    q.tasks.push_back(task);
+                }
+                if (__atomic_load_n(&this->_sleepers, __ATOMIC_SEQ_CST))
+                {
+                    ft::lock_guard<ft::mutex> guard(this->_sleepLock);
+                    this->_wake.notify_one();
+                }
+            };
+
+            //runs queued tasks, this group's or others', until the group is done
+            void wait(task_group& group)
+            {
+                std::size_t self = ownQueue();
+                std::size_t idle = 0;
+                while (__atomic_load_n(&group.pending, __ATOMIC_ACQUIRE))
+                {
+                    if (runOne(self))
+                        idle = 0;
+                    else if (++idle < 64)
+                        cpu_relax();
+                    else
+                        sched_yield();
+                }
+            };
+
+            //a pool with one thread per online CPU, started on first use
+            static thread_pool& shared()
+            {
+                static thread_pool pool;
+                return pool;
+            };
+    };
+}
+
+#endif
@@ -3,6 +3,12 @@
 
 #include <memory>
 
+#if defined(__GNUC__)
+# define FT_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+# define FT_PREFETCH(addr)
+#endif
+
 namespace ft
 {
     template <class T>
@@ -64,7 +70,23 @@ namespace ft
     template<> struct is_integral<int> :                        public ft::integral_constant<bool, true> {};
     template<> struct is_integral<long int> :                   public ft::integral_constant<bool, true> {};
     template<> struct is_integral<long long int> :              public ft::integral_constant<bool, true> {};
+#if __cplusplus >= 201103L
     template<> struct is_integral<char16_t> :                  public ft::integral_constant<bool, true> {};
+#endif
+
+    //__has_trivial_destructor is a GCC/Clang builtin, so this also works in C++98
+    template <class T>
+    struct is_trivially_destructible: public ft::integral_constant<bool, __has_trivial_destructor(T)> {};
+
+    // True if the allocator frees all its memory at once (an arena), so a container
+    // of trivially destructible elements may drop them without freeing them one by
+    // one. memory_resource.hpp overloads it for polymorphic_allocator; call it
+    // unqualified so the overload is found.
+    template <class Alloc>
+    bool releasesInBulk(const Alloc&)
+    {
+        return false;
+    };
 
     template <class InputIterator1, class InputIterator2>
     bool lexicographical_compare (InputIterator1 first1, InputIterator1 last1, InputIterator2 first2, InputIterator2 last2)
@@ -155,6 +177,11 @@ namespace ft
         return ft::pair<T1, T2>(x, y);
     }
 
+    //gives helpers kept out of a container (ft::parallel::build) its internals;
+    //specialised next to each container that befriends it
+    template <class Container>
+    struct container_access;
+
 }
 
 #endif
\ No newline at end of file
@@ -5,14 +5,24 @@
 #include <exception>
 #include <memory>
 #include <cstddef>
+#include <stdint.h>
 #include "ft_iterator.hpp"
 #include "ft_reverse_iterator.hpp"
 #include <iterator>
 
 #include "utils.hpp"
+#include "container_stats.hpp"
 
 namespace ft
 {
+    // With set_incremental_growth(true) a push_back on a full vector only
+    // allocates the bigger buffer; the elements follow a few per push_back.
+    // Whatever needs one contiguous buffer (iterators, data(), reserve, ...)
+    // finishes that move first. The const interface never moves anything:
+    // indexing, front(), back() and the comparisons work at any time, but the
+    // const begin(), end() and data() need the move done, so call settle()
+    // before handing out a const reference to a vector that is still growing.
+    // Without incremental growth nothing changes.
     template <class T, class Alloc = std::allocator<T> >
     class vector
     {
@@ -36,27 +46,119 @@ namespace ft
             size_type _size;
             size_type _capacity;
             allocator_type _allocator;
+            // Incremental growth: while a resize is in progress, elements
+            // [_moved, _oldEnd) still live in _old and everything else is in
+            // _array; each push_back moves growthStep of them across.
+            T* _old;
+            size_type _oldCapacity;
+            size_type _moved;
+            size_type _oldEnd;
+            bool _incremental;
+
+            static const size_type growthStep = 2;
+
+            friend struct container_access<vector>;
+#ifdef FT_CONTAINERS_STATS
+            vector_counters _stats;
+
+            void countReallocation()
+            {
+                ++this->_stats.reallocations;
+                stats_registry::reallocated();
+            };
+
+            void countCopy(size_type elements)
+            {
+                this->_stats.bytes_copied += elements * sizeof(T);
+                stats_registry::copied(elements * sizeof(T));
+            };
+#endif
+
+            //where element pos lives right now; _moved == _oldEnd == 0 unless a growth is pending,
+            //so the unsigned range check is false then, and the buffer is picked by mask, not by a jump
+            T* slot(size_type pos) const
+            {
+                uintptr_t inOld = 0 - static_cast<uintptr_t>(pos - this->_moved < this->_oldEnd - this->_moved);
+                uintptr_t base = (reinterpret_cast<uintptr_t>(this->_old) & inOld) | (reinterpret_cast<uintptr_t>(this->_array) & ~inOld);
+                return reinterpret_cast<T*>(base) + pos;
+            };
+
+            void dropOld()
+            {
+                FT_STATS(stats_registry::vectorBytes(-static_cast<long long>(this->_oldCapacity * sizeof(T))));
+                this->_allocator.deallocate(this->_old, this->_oldCapacity);
+                this->_old = 0;
+                this->_oldCapacity = 0;
+                this->_moved = 0;
+                this->_oldEnd = 0;
+            };
+
+            void migrate(size_type count)
+            {
+                for (; count && this->_moved < this->_oldEnd; --count, ++this->_moved)
+                {
+                    this->_allocator.construct(this->_array + this->_moved, this->_old[this->_moved]);
+                    this->_allocator.destroy(this->_old + this->_moved);
+                    FT_STATS(countCopy(1));
+                }
+                if (this->_moved == this->_oldEnd)
+                    dropOld();
+            };
+
+            //new buffer only; the elements stay where they are and follow on later push_backs
+            void startGrowth()
+            {
+                settle();
+                size_type newCap = 2 * this->_capacity + (this->_capacity == 0);
+                if (newCap > max_size())
+                    newCap = max_size();
+                if (newCap <= this->_size)
+                    throw std::length_error("Vector capacity error!");
+                T* tmp = this->_allocator.allocate(newCap);
+                FT_STATS(stats_registry::vectorBytes(newCap * sizeof(T)));
+                if (this->_size)
+                {
+                    FT_STATS(countReallocation());
+                    this->_old = this->_array;
+                    this->_oldCapacity = this->_capacity;
+                    this->_moved = 0;
+                    this->_oldEnd = this->_size;
+                }
+                else
+                {
+                    FT_STATS(stats_registry::vectorBytes(-static_cast<long long>(this->_capacity * sizeof(T))));
+                    this->_allocator.deallocate(this->_array, this->_capacity);
+                }
+                this->_array = tmp;
+                this->_capacity = newCap;
+            };
 
         public:
             /*constructors*/
-            vector(): _array(0), _size(0), _capacity(0), _allocator(allocator_type()) {};
+            vector(): _array(0), _size(0), _capacity(0), _allocator(allocator_type()),
+            _old(0), _oldCapacity(0), _moved(0), _oldEnd(0), _incremental(false) {};
 
-            explicit vector (const allocator_type& alloc): _array(0), _size(0), _capacity(0), _allocator(alloc) {};
+            explicit vector (const allocator_type& alloc): _array(0), _size(0), _capacity(0), _allocator(alloc),
+            _old(0), _oldCapacity(0), _moved(0), _oldEnd(0), _incremental(false) {};
 
             explicit vector (size_type n, const value_type& val = value_type(), const allocator_type& alloc = allocator_type()):
-            _array(0), _size(0), _capacity(0), _allocator(alloc)
+            _array(0), _size(0), _capacity(0), _allocator(alloc),
+            _old(0), _oldCapacity(0), _moved(0), _oldEnd(0), _incremental(false)
             {
                 insert(end(), n, val);
             };
             
             template<class InputIt>
             vector (InputIt first, InputIt last, const allocator_type& alloc = allocator_type(), typename ft::enable_if<!ft::is_integral<InputIt>::value>::type* = 0):
-            _array(0), _size(0), _capacity(0), _allocator(alloc)
+            _array(0), _size(0), _capacity(0), _allocator(alloc),
+            _old(0), _oldCapacity(0), _moved(0), _oldEnd(0), _incremental(false)
             {
                 insert(end(), first, last);
             };
 
-            vector (vector const & copy)
+            //a copy is contiguous but keeps the growth mode of the source
+            vector (vector const & copy): _array(0), _size(0), _capacity(0), _allocator(copy._allocator),
+            _old(0), _oldCapacity(0), _moved(0), _oldEnd(0), _incremental(copy._incremental)
             {
                 this->_size = copy._size;
                 this->_capacity = copy._capacity;
@@ -64,6 +166,7 @@ namespace ft
                 try
                 {
                     this->_array = this->_allocator.allocate(this->_capacity);
+                    FT_STATS(stats_registry::vectorBytes(this->_capacity * sizeof(T)));
                     for (size_t i = 0; i < this->_size; ++i)
                         this->_allocator.construct(this->_array + i, copy[i]);
                 }
@@ -79,15 +182,15 @@ namespace ft
                 if (this == &source)
                     return *this;
                 clear();
+                FT_STATS(stats_registry::vectorBytes(-static_cast<long long>(this->_capacity * sizeof(T))));
+                this->_allocator.deallocate(this->_array, this->_capacity);
                 this->_size = source._size;
                 this->_allocator = source._allocator;
                 this->_capacity = source._capacity;
-                for (size_t i = 0; i < this->_size; i++)
-                    this->_allocator.destroy(this->_array + i);
-                this->_allocator.deallocate(this->_array, this->_capacity);
                 try
                 {
                     this->_array = this->_allocator.allocate(this->_capacity);
+                    FT_STATS(stats_registry::vectorBytes(this->_capacity * sizeof(T)));
                 }
                 catch(const std::exception& e)
                 {
@@ -100,9 +203,9 @@ namespace ft
 
             ~vector() 
             {
-                for (size_t i = 0; i < this->_size; i++)
-                    this->_allocator.destroy(this->_array + i);
-                this->_allocator.deallocate(this->_array, this->_size);
+                clear();
+                FT_STATS(stats_registry::vectorBytes(-static_cast<long long>(this->_capacity * sizeof(T))));
+                this->_allocator.deallocate(this->_array, this->_capacity);
                 this->_size = 0;
                 this->_capacity = 0;
             };
@@ -130,60 +233,65 @@ namespace ft
             {
                 if (pos > this->_size)
                     throw std::out_of_range("Out of vector range");
-                return (*(this->_array + pos));
+                return (*slot(pos));
             };
 
             const_reference at(size_type pos) const
             {
-                if (pos >= this->_size || pos < 0)
+                if (pos >= this->_size)
                     throw std::out_of_range("Out of range of vector");
-                return (*(this->_array + pos));
+                return (*slot(pos));
             };
 
             reference operator[](size_type pos)
             {
-                return (*(this->_array + pos));
+                return (*slot(pos));
             };
 
             const_reference operator[]( size_type pos ) const
             {
-                return (*(this->_array + pos));
+                return (*slot(pos));
             };
 
             reference front()
             {
-                return (*this->_array);
+                return (*slot(0));
             };
 
             const_reference front() const
             {
-                return (*this->_array);
+                return (*slot(0));
             };
 
             reference back()
             {
-                return (*(this->_array + this->_size - 1));
+                return (*slot(this->_size - 1));
             };
 
             const_reference back() const
             {
-                return (*(this->_array + this->_size - 1));
+                return (*slot(this->_size - 1));
             };
 
             T* data()
             {
+                settle();
                 return this->_array;
             };
 
+            //contiguous only once no incremental growth is pending, see settle()
             const T* data() const
             {
                 return this->_array;
             };
 
             /*iterators*/
+            //iterators need one buffer, so taking one finishes a pending incremental growth;
+            //the const ones do not and expect settle() to have been called
 
             iterator begin()
             {
+                settle();
                 return iterator(this->_array);
             };
 
@@ -194,6 +302,7 @@ namespace ft
             
             iterator end()
             {
+                settle();
                 return iterator(this->_array + this->_size);
             };
 
@@ -241,8 +350,9 @@ namespace ft
 
             void reserve(size_type n)
             {
-                if (n > max_size() || n < 0)
+                if (n > max_size())
                     throw std::length_error("Vector capacity error!");
+                settle();
                 if (n <= this->_capacity)
                     return ;
                 size_type newCap = 2 * this->_capacity + (this->_capacity == 0);
@@ -254,6 +364,9 @@ namespace ft
                     this->_allocator.construct(tmp + i, *(this->_array + i));
                 for (size_t i = 0; i < this->_size; i++)
                     this->_allocator.destroy(this->_array + i);
+                FT_STATS(stats_registry::vectorBytes(static_cast<long long>(n * sizeof(T)) - static_cast<long long>(this->_capacity * sizeof(T))));
+                FT_STATS(if (this->_size) countReallocation());
+                FT_STATS(countCopy(this->_size));
                 this->_allocator.deallocate(this->_array, this->_capacity);
                 this->_array = tmp;
                 this->_capacity = n;
@@ -264,12 +377,54 @@ namespace ft
                 return this->_capacity;
             };
 
+            // Off by default: push_back on a full vector copies everything at
+            // once. On, it only allocates the doubled buffer and moves
+            // growthStep elements per push_back after that, so no single
+            // push_back costs more than O(1) element copies; the move is done
+            // before the new buffer is half full. Both buffers are held until then.
+            void set_incremental_growth(bool on)
+            {
+                if (!on)
+                    settle();
+                this->_incremental = on;
+            };
+
+            bool incremental_growth() const
+            {
+                return this->_incremental;
+            };
+
+            //finishes a pending incremental growth, so the elements are in one buffer
+            //and the const begin(), end() and data() see all of them
+            void settle()
+            {
+                if (this->_old)
+                    migrate(this->_oldEnd);
+            };
+
+            //reallocations and bytes_copied stay 0 unless built with FT_CONTAINERS_STATS
+            vector_stats stats() const
+            {
+                vector_stats res;
+                res.size = this->_size;
+                res.capacity = this->_capacity;
+                res.bytes = (this->_capacity + this->_oldCapacity) * sizeof(T);
+                res.slack_bytes = (this->_capacity - this->_size) * sizeof(T);
+                res.reallocations = 0;
+                res.bytes_copied = 0;
+                FT_STATS(res.reallocations = this->_stats.reallocations);
+                FT_STATS(res.bytes_copied = this->_stats.bytes_copied);
+                return res;
+            };
+
             /*modifiers*/
 
             void clear()
             {
                 for (size_t i = 0; i < this->_size; i++)
-                    this->_allocator.destroy(this->_array + i);
+                    this->_allocator.destroy(slot(i));
+                if (this->_old)
+                    dropOld();
                 this->_size = 0;
             };
 
@@ -279,13 +434,13 @@ namespace ft
                     throw std::out_of_range("Out of vector range\n");
                 size_t dif = pos - begin();
                 reserve(this->_size + 1);
-                this->_size++;
                 for (size_t i = this->_size; i > dif; i--)
                 {
                     this->_allocator.construct(this->_array + i, *(this->_array + i - 1));
                     this->_allocator.destroy(this->_array + i - 1);
                 }
                 this->_allocator.construct(this->_array + dif, value);
+                this->_size++;
                 return iterator(begin() + dif);
             };
 
@@ -293,17 +448,18 @@ namespace ft
             {
                 if (pos < begin() || pos > end())
                     throw std::out_of_range("Out of vector range\n");
+                if (!count)
+                    return ;
                 size_t dif = pos - this->begin();
                 reserve(this->_size + count);
-                this->_size += count;
-                for (size_t i = this->_size; i >= dif + count; i--)
+                for (size_t i = this->_size; i > dif; i--)
                 {
-                    this->_allocator.construct(this->_array + i, *(this->_array + i - count));
-                    this->_allocator.destroy(this->_array + i - count);
+                    this->_allocator.construct(this->_array + i - 1 + count, *(this->_array + i - 1));
+                    this->_allocator.destroy(this->_array + i - 1);
                 }
                 for (size_t i = 0; i < count; ++i)
                     this->_allocator.construct(this->_array + dif + i, value);
-                
+                this->_size += count;
             };
             
             template< class InputIt >
@@ -313,6 +469,8 @@ namespace ft
                     throw std::out_of_range("Out of vector range");
                 size_t dif = pos - begin();
                 size_type n = static_cast<size_type>(std::distance(first, last));
+                if (!n)
+                    return ;
                 pointer tmp = NULL;
                 InputIt it_tmp = first;       
                 try
@@ -355,7 +513,7 @@ namespace ft
                     throw std::out_of_range("out of vector range");
                 size_t dif = pos - begin();
                 this->_allocator.destroy(this->_array + dif);
-                for (size_t i = dif; i < this->_size; ++i)
+                for (size_t i = dif; i + 1 < this->_size; ++i)
                 {                    
                     this->_allocator.construct(this->_array + i, *(this->_array + i + 1));
                     this->_allocator.destroy(this->_array + i + 1);
@@ -383,22 +541,39 @@ namespace ft
 
             void push_back(const T& value)
             {
-                reserve(this->_size + 1);
+                if (!this->_incremental)
+                {
+                    reserve(this->_size + 1);
+                    this->_allocator.construct(this->_array + this->_size, value);
+                    this->_size++;
+                    return ;
+                }
+                //the old buffer is only freed by migrate(), so value may still point into it
+                if (this->_size == this->_capacity)
+                    startGrowth();
                 this->_allocator.construct(this->_array + this->_size, value);
                 this->_size++;
+                if (this->_old)
+                    migrate(growthStep);
             };
 
             void pop_back()
             {
                 if (this->_size)
                 {
-                    this->_allocator.destroy(this->_array + this->_size - 1);
+                    this->_allocator.destroy(slot(this->_size - 1));
                     this->_size--;
+                    if (this->_old && this->_oldEnd > this->_size)
+                    {
+                        this->_oldEnd = this->_size;
+                        migrate(0);
+                    }
                 }
             };
 
             void resize(size_type n, value_type val = value_type())
             {
+                settle();
                 if (n <= this->_size)
                 {
                     for (size_t i = n; i < this->_size; i++)
@@ -411,31 +586,62 @@ namespace ft
 
             void swap(vector& other)
             {
+                settle();
+                other.settle();
                 T* array = this->_array;
                 size_type size = this->_size;
                 size_type capacity = this->_capacity;
                 allocator_type allocator = this->_allocator;
+                bool incremental = this->_incremental;
                 
                 this->_array = other._array;
                 this->_size = other._size;
                 this->_capacity = other._capacity;
                 this->_allocator = other._allocator;
+                this->_incremental = other._incremental;
                 
                 other._array = array;
                 other._size = size;
                 other._capacity = capacity;
                 other._allocator = allocator;
+                other._incremental = incremental;
             };
 
             
     };
 
+    template <class T, class Alloc>
+    struct container_access<vector<T, Alloc> >
+    {
+        typedef vector<T, Alloc> container;
+
+        //hands the storage over, capacity included, and leaves vector empty without touching it
+        static T* detach(container& vector, typename container::size_type& size, typename container::size_type& capacity)
+        {
+            vector.settle();
+            FT_STATS(stats_registry::vectorBytes(-static_cast<long long>(vector._capacity * sizeof(T))));
+            T* array = vector._array;
+            size = vector._size;
+            capacity = vector._capacity;
+            vector._array = 0;
+            vector._size = 0;
+            vector._capacity = 0;
+            return array;
+        };
+    };
+
     /*non member function*/
 
+    //by index, so a vector with a pending incremental growth compares right
     template< class T, class Alloc >
     bool operator==( const vector<T,Alloc>& lhs, const vector<T,Alloc>& rhs )
     {
-        return (!ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end()) && !ft::lexicographical_compare(rhs.begin(), rhs.end(), lhs.begin(), lhs.end()));
+        if (lhs.size() != rhs.size())
+            return false;
+        for (typename vector<T,Alloc>::size_type i = 0; i < lhs.size(); ++i)
+            if (!(lhs[i] == rhs[i]))
+                return false;
+        return true;
     };
 
     template< class T, class Alloc >
@@ -447,7 +653,14 @@ namespace ft
     template< class T, class Alloc >
     bool operator<( const vector<T,Alloc>& lhs, const vector<T,Alloc>& rhs )
     {
-        return ft::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        for (typename vector<T,Alloc>::size_type i = 0; i < lhs.size() && i < rhs.size(); ++i)
+        {
+            if (lhs[i] < rhs[i])
+                return true;
+            if (rhs[i] < lhs[i])
+                return false;
+        }
+        return lhs.size() < rhs.size();
     };
 
     template< class T, class Alloc >
@@ -0,0 +1,174 @@
+#ifndef WORKLOAD_TRACE_HPP
+# define WORKLOAD_TRACE_HPP
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+
+// A workload trace is a text file with one container operation per line:
+//     <type> <op> <key> <size>
+// type is vector, stack, map or set, op one of the names below, key the
+// argument of the operation and size the container's size right after it. The
+// first line is a "# ft-trace 1" header; other lines starting with # are
+// comments. A replay checks its sizes against the recorded ones, so it also
+// tells whether two builds behaved the same.
+
+namespace bench
+{
+    enum trace_type { traceVector, traceStack, traceMap, traceSet, traceTypes };
+    enum trace_op { opPush, opPop, opAt, opInsert, opFind, opErase, opCopy, opClear, traceOps };
+
+    const char* const traceTypeNames[traceTypes] = { "vector", "stack", "map", "set" };
+    const char* const traceOpNames[traceOps] = { "push", "pop", "at", "insert", "find", "erase", "copy", "clear" };
+
+    struct trace_entry
+    {
+        unsigned char type;
+        unsigned char op;
+        int key;
+        size_t size;
+    };
+
+    class trace_writer
+    {
+        std::ostream& _out;
+
+        public:
+            explicit trace_writer(std::ostream& out): _out(out)
+            {
+                this->_out << "# ft-trace 1\n";
+            };
+
+            void record(trace_type type, trace_op op, int key, size_t size)
+            {
+                this->_out << traceTypeNames[type] << ' ' << traceOpNames[op] << ' ' << key << ' ' << size << '\n';
+            };
+    };
+
+    inline int nameIndex(const char* const* names, int count, const std::string& name)
+    {
+        for (int i = 0; i < count; ++i)
+            if (name == names[i])
+                return i;
+        return -1;
+    }
+
+    //false with a message naming the bad line
+    inline bool readTrace(std::istream& in, std::vector<trace_entry>& entries, std::string& error)
+    {
+        std::string line;
+        size_t number = 0;
+        while (std::getline(in, line))
+        {
+            ++number;
+            if (line.empty() || line[0] == '#')
+                continue ;
+            std::istringstream fields(line);
+            std::string type;
+            std::string op;
+            trace_entry entry;
+            fields >> type >> op >> entry.key >> entry.size;
+            int t = nameIndex(traceTypeNames, traceTypes, type);
+            int o = nameIndex(traceOpNames, traceOps, op);
+            if (!fields || t < 0 || o < 0)
+            {
+                std::ostringstream msg;
+                msg << "line " << number << ": cannot parse \"" << line << '"';
+                error = msg.str();
+                return false;
+            }
+            entry.type = static_cast<unsigned char>(t);
+            entry.op = static_cast<unsigned char>(o);
+            entries.push_back(entry);
+        }
+        return true;
+    }
+
+    // One container of each type, driven by trace entries. apply() runs one
+    // operation and returns the size it left behind; operations a type does not
+    // have (a find on a stack) and pops of empty containers are no-ops.
+    template <class Vector, class Stack, class Map, class Set>
+    class trace_replayer
+    {
+        Vector _vector;
+        Stack _stack;
+        Map _map;
+        Set _set;
+        long _sink;
+
+        size_t vectorOp(const trace_entry& e)
+        {
+            switch (e.op)
+            {
+                case opPush: this->_vector.push_back(e.key); break ;
+                case opPop: if (!this->_vector.empty()) this->_vector.pop_back(); break ;
+                case opAt: if (!this->_vector.empty()) this->_sink += this->_vector[static_cast<unsigned>(e.key) % this->_vector.size()]; break ;
+                case opCopy: { Vector copy(this->_vector); this->_sink += copy.size(); break ; }
+                case opClear: this->_vector.clear(); break ;
+            }
+            return this->_vector.size();
+        };
+
+        size_t stackOp(const trace_entry& e)
+        {
+            switch (e.op)
+            {
+                case opPush: this->_stack.push(e.key); break ;
+                case opPop: if (!this->_stack.empty()) { this->_sink += this->_stack.top(); this->_stack.pop(); } break ;
+                case opCopy: { Stack copy(this->_stack); this->_sink += copy.size(); break ; }
+            }
+            return this->_stack.size();
+        };
+
+        size_t mapOp(const trace_entry& e)
+        {
+            switch (e.op)
+            {
+                case opInsert: this->_map.insert(typename Map::value_type(e.key, e.key)); break ;
+                case opAt: this->_sink += this->_map[e.key]; break ;
+                case opFind: this->_sink += this->_map.find(e.key) != this->_map.end(); break ;
+                case opErase: this->_sink += this->_map.erase(e.key); break ;
+                case opCopy: { Map copy(this->_map); this->_sink += copy.size(); break ; }
+                case opClear: this->_map.clear(); break ;
+            }
+            return this->_map.size();
+        };
+
+        size_t setOp(const trace_entry& e)
+        {
+            switch (e.op)
+            {
+                case opInsert: this->_set.insert(e.key); break ;
+                case opFind: this->_sink += this->_set.find(e.key) != this->_set.end(); break ;
+                case opErase: this->_sink += this->_set.erase(e.key); break ;
+                case opCopy: { Set copy(this->_set); this->_sink += copy.size(); break ; }
+                case opClear: this->_set.clear(); break ;
+            }
+            return this->_set.size();
+        };
+
+        public:
+            trace_replayer(): _sink(0) {};
+
+            size_t apply(const trace_entry& e)
+            {
+                switch (e.type)
+                {
+                    case traceVector: return vectorOp(e);
+                    case traceStack: return stackOp(e);
+                    case traceMap: return mapOp(e);
+                    default: return setOp(e);
+                }
+            };
+
+            long sink() const
+            {
+                return this->_sink;
+            };
+    };
+}
+
+#endif